@@ -0,0 +1,63 @@
+#include "pbrlib/genglsl/lib/mx_microfacet_specular.glsl"
+
+// Sample a level of a GGX-prefiltered radiance atlas, whose levels are stacked
+// vertically with each level half the resolution of the previous one.
+vec3 mx_prefilter_atlas_lookup(vec2 uv, int level)
+{
+    ivec2 atlasSize = textureSize($envRadiance, 0);
+    int width = atlasSize.x >> level;
+    int height = max(width / 2, 1);
+    int offset = atlasSize.x - (atlasSize.x >> level);
+
+    // Filter bilinearly, wrapping horizontally and clamping vertically
+    // within the level.
+    vec2 texel = uv * vec2(width, height) - 0.5;
+    vec2 f = fract(texel);
+    ivec2 t0 = ivec2(floor(texel));
+    int x0 = (t0.x + width) % width;
+    int x1 = (x0 + 1) % width;
+    int y0 = clamp(t0.y, 0, height - 1) + offset;
+    int y1 = clamp(t0.y + 1, 0, height - 1) + offset;
+    vec3 c00 = texelFetch($envRadiance, ivec2(x0, y0), 0).rgb;
+    vec3 c10 = texelFetch($envRadiance, ivec2(x1, y0), 0).rgb;
+    vec3 c01 = texelFetch($envRadiance, ivec2(x0, y1), 0).rgb;
+    vec3 c11 = texelFetch($envRadiance, ivec2(x1, y1), 0).rgb;
+    return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+}
+
+vec3 mx_prefilter_environment_lookup(vec3 dir, float roughness)
+{
+    vec3 envDir = normalize(($envMatrix * vec4(dir, 0.0)).xyz);
+    vec2 uv = mx_latlong_projection(envDir);
+
+    // Levels span roughness from zero to one, linearly in its square root,
+    // down to a width of eight texels.
+    int levelCount = max(int(log2(float(textureSize($envRadiance, 0).x)) + 0.5) - 2, 1);
+    float level = sqrt(clamp(roughness, 0.0, 1.0)) * float(levelCount - 1);
+    int level0 = int(level);
+    int level1 = min(level0 + 1, levelCount - 1);
+    return mix(mx_prefilter_atlas_lookup(uv, level0),
+               mx_prefilter_atlas_lookup(uv, level1),
+               level - float(level0));
+}
+
+vec3 mx_environment_radiance(vec3 N, vec3 V, vec3 X, vec2 roughness, int distribution, FresnelData fd)
+{
+    N = mx_forward_facing_normal(N, V);
+    vec3 L = reflect(-V, N);
+
+    float NdotV = clamp(dot(N, V), M_FLOAT_EPS, 1.0);
+
+    float avgRoughness = mx_average_roughness(roughness);
+    vec3 F = mx_compute_fresnel(NdotV, fd);
+    float G = mx_ggx_smith_G(NdotV, NdotV, avgRoughness);
+    vec3 comp = mx_ggx_energy_compensation(NdotV, avgRoughness, F);
+    vec3 Li = mx_prefilter_environment_lookup(L, avgRoughness);
+
+    return Li * F * G * comp;
+}
+
+vec3 mx_environment_irradiance(vec3 N)
+{
+    return mx_latlong_map_lookup(N, $envMatrix, 0.0, $envIrradiance);
+}
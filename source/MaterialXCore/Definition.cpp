@@ -21,17 +21,17 @@ const string NodeDef::CONDITIONAL_NODE_GROUP = "conditional";
 const string NodeDef::ORGANIZATION_NODE_GROUP = "organization";
 const string NodeDef::TRANSLATION_NODE_GROUP = "translation";
 
-const string NodeDef::NODE_ATTRIBUTE = "node";
-const string NodeDef::NODE_GROUP_ATTRIBUTE = "nodegroup";
-const string TypeDef::SEMANTIC_ATTRIBUTE = "semantic";
-const string TypeDef::CONTEXT_ATTRIBUTE = "context";
-const string Implementation::FILE_ATTRIBUTE = "file";
-const string Implementation::FUNCTION_ATTRIBUTE = "function";
-const string UnitDef::UNITTYPE_ATTRIBUTE = "unittype";
-const string AttributeDef::ATTRNAME_ATTRIBUTE = "attrname";
-const string AttributeDef::VALUE_ATTRIBUTE = "value";
-const string AttributeDef::ELEMENTS_ATTRIBUTE = "elements";
-const string AttributeDef::EXPORTABLE_ATTRIBUTE = "exportable";
+const string& NodeDef::NODE_ATTRIBUTE = internString("node");
+const string& NodeDef::NODE_GROUP_ATTRIBUTE = internString("nodegroup");
+const string& TypeDef::SEMANTIC_ATTRIBUTE = internString("semantic");
+const string& TypeDef::CONTEXT_ATTRIBUTE = internString("context");
+const string& Implementation::FILE_ATTRIBUTE = internString("file");
+const string& Implementation::FUNCTION_ATTRIBUTE = internString("function");
+const string& UnitDef::UNITTYPE_ATTRIBUTE = internString("unittype");
+const string& AttributeDef::ATTRNAME_ATTRIBUTE = internString("attrname");
+const string& AttributeDef::VALUE_ATTRIBUTE = internString("value");
+const string& AttributeDef::ELEMENTS_ATTRIBUTE = internString("elements");
+const string& AttributeDef::EXPORTABLE_ATTRIBUTE = internString("exportable");
 
 //
 // NodeDef methods
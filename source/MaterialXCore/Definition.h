@@ -172,8 +172,8 @@ class MX_CORE_API NodeDef : public InterfaceElement
 
   public:
     static const string CATEGORY;
-    static const string NODE_ATTRIBUTE;
-    static const string NODE_GROUP_ATTRIBUTE;
+    static const string& NODE_ATTRIBUTE;
+    static const string& NODE_GROUP_ATTRIBUTE;
 
     static const string TEXTURE_NODE_GROUP;
     static const string PROCEDURAL_NODE_GROUP;
@@ -272,8 +272,8 @@ class MX_CORE_API Implementation : public InterfaceElement
 
   public:
     static const string CATEGORY;
-    static const string FILE_ATTRIBUTE;
-    static const string FUNCTION_ATTRIBUTE;
+    static const string& FILE_ATTRIBUTE;
+    static const string& FUNCTION_ATTRIBUTE;
 };
 
 /// @class TypeDef
@@ -366,8 +366,8 @@ class MX_CORE_API TypeDef : public Element
 
   public:
     static const string CATEGORY;
-    static const string SEMANTIC_ATTRIBUTE;
-    static const string CONTEXT_ATTRIBUTE;
+    static const string& SEMANTIC_ATTRIBUTE;
+    static const string& CONTEXT_ATTRIBUTE;
 };
 
 /// @class TargetDef
@@ -492,7 +492,7 @@ class MX_CORE_API UnitDef : public Element
 
   public:
     static const string CATEGORY;
-    static const string UNITTYPE_ATTRIBUTE;
+    static const string& UNITTYPE_ATTRIBUTE;
 };
 
 /// @class UnitTypeDef
@@ -645,10 +645,10 @@ class MX_CORE_API AttributeDef : public TypedElement
 
   public:
     static const string CATEGORY;
-    static const string ATTRNAME_ATTRIBUTE;
-    static const string VALUE_ATTRIBUTE;
-    static const string ELEMENTS_ATTRIBUTE;
-    static const string EXPORTABLE_ATTRIBUTE;
+    static const string& ATTRNAME_ATTRIBUTE;
+    static const string& VALUE_ATTRIBUTE;
+    static const string& ELEMENTS_ATTRIBUTE;
+    static const string& EXPORTABLE_ATTRIBUTE;
 };
 
 } // namespace MaterialX
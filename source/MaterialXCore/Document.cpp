@@ -7,13 +7,14 @@
 
 #include <MaterialXCore/Util.h>
 
+#include <atomic>
 #include <mutex>
 
 namespace MaterialX
 {
 
-const string Document::CMS_ATTRIBUTE = "cms";
-const string Document::CMS_CONFIG_ATTRIBUTE = "cmsconfig";
+const string& Document::CMS_ATTRIBUTE = internString("cms");
+const string& Document::CMS_CONFIG_ATTRIBUTE = internString("cmsconfig");
 
 namespace {
 
@@ -46,6 +47,13 @@ NodeDefPtr getShaderNodeDef(ElementPtr shaderRef)
     return NodeDefPtr();
 }
 
+bool isCacheKeyAttribute(const string& attrib)
+{
+    return attrib == PortElement::NODE_NAME_ATTRIBUTE ||
+           attrib == NodeDef::NODE_ATTRIBUTE ||
+           attrib == InterfaceElement::NODE_DEF_ATTRIBUTE;
+}
+
 } // anonymous namespace
 
 //
@@ -72,10 +80,16 @@ class Document::Cache
 
     void refresh()
     {
+        // Lock-free fast path for concurrent readers of a valid cache.
+        if (valid.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
         // Thread synchronization for multiple concurrent readers of a single document.
         std::lock_guard<std::mutex> guard(mutex);
 
-        if (!valid)
+        if (!valid.load(std::memory_order_relaxed))
         {
             // Clear the existing cache.
             portElementMap.clear();
@@ -85,44 +99,147 @@ class Document::Cache
             // Traverse the document to build a new cache.
             for (ElementPtr elem : doc.lock()->traverseTree())
             {
-                const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
-                const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
-                const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+                addEntries(elem);
+            }
 
-                if (!nodeName.empty())
-                {
-                    PortElementPtr portElem = elem->asA<PortElement>();
-                    if (portElem)
-                    {
-                        portElementMap.emplace(portElem->getQualifiedName(nodeName), portElem);
-                    }
-                }
-                if (!nodeString.empty())
-                {
-                    NodeDefPtr nodeDef = elem->asA<NodeDef>();
-                    if (nodeDef)
-                    {
-                        nodeDefMap.emplace(nodeDef->getQualifiedName(nodeString), nodeDef);
-                    }
-                }
-                if (!nodeDefString.empty())
-                {
-                    InterfaceElementPtr interface = elem->asA<InterfaceElement>();
-                    if (interface && (interface->isA<Implementation>() || interface->isA<NodeGraph>()))
-                    {
-                        implementationMap.emplace(interface->getQualifiedName(nodeDefString), interface);
-                    }
-                }
+            // Publish the new cache to readers.
+            valid.store(true, std::memory_order_release);
+        }
+    }
+
+    // Add cache entries for the given element, and optionally for all of
+    // its descendants.
+    void addElement(ElementPtr elem, bool recursive)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        if (valid.load(std::memory_order_relaxed) && isInDocument(elem))
+        {
+            if (!recursive)
+            {
+                addEntries(elem);
+                return;
+            }
+            for (ElementPtr descendant : elem->traverseTree())
+            {
+                addEntries(descendant);
+            }
+        }
+    }
+
+    // Remove cache entries for the given element, and optionally for all of
+    // its descendants.
+    void removeElement(ElementPtr elem, bool recursive)
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        if (valid.load(std::memory_order_relaxed) && isInDocument(elem))
+        {
+            if (!recursive)
+            {
+                removeEntries(elem);
+                return;
+            }
+            if (elem == doc.lock())
+            {
+                portElementMap.clear();
+                nodeDefMap.clear();
+                implementationMap.clear();
+                return;
+            }
+            for (ElementPtr descendant : elem->traverseTree())
+            {
+                removeEntries(descendant);
+            }
+        }
+    }
+
+  private:
+    // Return true if the given element is reachable from the document root,
+    // as removed elements retain their root pointer while still referenced.
+    bool isInDocument(ElementPtr elem) const
+    {
+        ElementPtr child = elem;
+        for (ElementPtr parent = elem->getParent(); parent; parent = parent->getParent())
+        {
+            if (parent->getChild(child->getName()) != child)
+            {
+                return false;
+            }
+            child = parent;
+        }
+        return child == doc.lock();
+    }
+
+    void addEntries(ElementPtr elem)
+    {
+        const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
+        const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
+        const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+
+        if (!nodeName.empty())
+        {
+            PortElementPtr portElem = elem->asA<PortElement>();
+            if (portElem)
+            {
+                portElementMap.emplace(portElem->getQualifiedName(nodeName), portElem);
+            }
+        }
+        if (!nodeString.empty())
+        {
+            NodeDefPtr nodeDef = elem->asA<NodeDef>();
+            if (nodeDef)
+            {
+                nodeDefMap.emplace(nodeDef->getQualifiedName(nodeString), nodeDef);
             }
+        }
+        if (!nodeDefString.empty())
+        {
+            InterfaceElementPtr interface = elem->asA<InterfaceElement>();
+            if (interface && (interface->isA<Implementation>() || interface->isA<NodeGraph>()))
+            {
+                implementationMap.emplace(interface->getQualifiedName(nodeDefString), interface);
+            }
+        }
+    }
+
+    void removeEntries(ElementPtr elem)
+    {
+        const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
+        const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
+        const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
 
-            valid = true;
+        if (!nodeName.empty())
+        {
+            eraseEntry(portElementMap, elem->getQualifiedName(nodeName), elem);
+        }
+        if (!nodeString.empty())
+        {
+            eraseEntry(nodeDefMap, elem->getQualifiedName(nodeString), elem);
+        }
+        if (!nodeDefString.empty())
+        {
+            eraseEntry(implementationMap, elem->getQualifiedName(nodeDefString), elem);
+        }
+    }
+
+    template <class T> static void eraseEntry(std::unordered_multimap<string, T>& map, const string& key, ElementPtr elem)
+    {
+        auto keyRange = map.equal_range(key);
+        for (auto it = keyRange.first; it != keyRange.second; ++it)
+        {
+            if (it->second == elem)
+            {
+                map.erase(it);
+                return;
+            }
         }
     }
 
   public:
     weak_ptr<Document> doc;
     std::mutex mutex;
-    bool valid;
+    std::atomic<bool> valid;
     std::unordered_multimap<string, PortElementPtr> portElementMap;
     std::unordered_multimap<string, NodeDefPtr> nodeDefMap;
     std::unordered_multimap<string, InterfaceElementPtr> implementationMap;
@@ -1348,7 +1465,50 @@ void Document::upgradeVersion()
 
 void Document::invalidateCache()
 {
-    _cache->valid = false;
+    _cache->valid.store(false, std::memory_order_release);
+}
+
+void Document::enableElementArena()
+{
+    if (!_arena)
+    {
+        _arena = std::make_shared<ElementArena>();
+    }
+}
+
+void Document::onAddElement(ElementPtr elem)
+{
+    _cache->addElement(elem, true);
+}
+
+void Document::onRemoveElement(ElementPtr elem)
+{
+    _cache->removeElement(elem, true);
+}
+
+void Document::onAttributeChanging(ElementPtr elem, const string& attrib)
+{
+    if (attrib == NAMESPACE_ATTRIBUTE)
+    {
+        // Namespaces qualify the cache keys of all descendants.
+        _cache->removeElement(elem, true);
+    }
+    else if (isCacheKeyAttribute(attrib))
+    {
+        _cache->removeElement(elem, false);
+    }
+}
+
+void Document::onAttributeChanged(ElementPtr elem, const string& attrib)
+{
+    if (attrib == NAMESPACE_ATTRIBUTE)
+    {
+        _cache->addElement(elem, true);
+    }
+    else if (isCacheKeyAttribute(attrib))
+    {
+        _cache->addElement(elem, false);
+    }
 }
 
 } // namespace MaterialX
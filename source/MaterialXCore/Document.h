@@ -50,6 +50,10 @@ class MX_CORE_API Document : public GraphElement
     virtual DocumentPtr copy() const
     {
         DocumentPtr doc = createDocument<Document>();
+        if (hasElementArena())
+        {
+            doc->enableElementArena();
+        }
         doc->copyContentFrom(getSelf());
         return doc;
     }
@@ -659,18 +663,45 @@ class MX_CORE_API Document : public GraphElement
     /// @{
 
     /// Invalidate cached data for optimized lookups within the given document.
+    /// Lookups on a valid cache are lock-free, and may be performed from any
+    /// number of threads while the document is not being edited.
     void invalidateCache();
 
+    /// Enable arena allocation for elements subsequently added to the
+    /// document.  Arena elements are allocated from large shared blocks,
+    /// which are released in bulk once the document and all of its elements
+    /// have been released.  The memory of elements removed from the document
+    /// is not reclaimed until the arena itself is released.
+    void enableElementArena();
+
+    /// Return true if arena allocation is enabled for the document.
+    bool hasElementArena() const
+    {
+        return _arena != nullptr;
+    }
+
     /// @}
 
   public:
     static const string CATEGORY;
-    static const string CMS_ATTRIBUTE;
-    static const string CMS_CONFIG_ATTRIBUTE;
+    static const string& CMS_ATTRIBUTE;
+    static const string& CMS_CONFIG_ATTRIBUTE;
+
+  private:
+    friend class Element;
+
+    // Incrementally update cached data for optimized lookups in response to
+    // edits of the given element.  Removals and attribute changes are
+    // reported before the edit is applied, and additions after it.
+    void onAddElement(ElementPtr elem);
+    void onRemoveElement(ElementPtr elem);
+    void onAttributeChanging(ElementPtr elem, const string& attrib);
+    void onAttributeChanged(ElementPtr elem, const string& attrib);
 
   private:
     class Cache;
     std::unique_ptr<Cache> _cache;
+    ElementArenaPtr _arena;
 };
 
 /// Create a new Document.
@@ -14,34 +14,63 @@
 namespace MaterialX
 {
 
-const string Element::NAME_ATTRIBUTE = "name";
-const string Element::FILE_PREFIX_ATTRIBUTE = "fileprefix";
-const string Element::GEOM_PREFIX_ATTRIBUTE = "geomprefix";
-const string Element::COLOR_SPACE_ATTRIBUTE = "colorspace";
-const string Element::INHERIT_ATTRIBUTE = "inherit";
-const string Element::NAMESPACE_ATTRIBUTE = "namespace";
-const string Element::DOC_ATTRIBUTE = "doc";
-const string TypedElement::TYPE_ATTRIBUTE = "type";
-const string ValueElement::VALUE_ATTRIBUTE = "value";
-const string ValueElement::INTERFACE_NAME_ATTRIBUTE = "interfacename";
-const string ValueElement::ENUM_ATTRIBUTE = "enum";
-const string ValueElement::IMPLEMENTATION_NAME_ATTRIBUTE = "implname";
-const string ValueElement::IMPLEMENTATION_TYPE_ATTRIBUTE = "impltype";
-const string ValueElement::ENUM_VALUES_ATTRIBUTE = "enumvalues";
-const string ValueElement::UI_NAME_ATTRIBUTE = "uiname";
-const string ValueElement::UI_FOLDER_ATTRIBUTE = "uifolder";
-const string ValueElement::UI_MIN_ATTRIBUTE = "uimin";
-const string ValueElement::UI_MAX_ATTRIBUTE = "uimax";
-const string ValueElement::UI_SOFT_MIN_ATTRIBUTE = "uisoftmin";
-const string ValueElement::UI_SOFT_MAX_ATTRIBUTE = "uisoftmax";
-const string ValueElement::UI_STEP_ATTRIBUTE = "uistep";
-const string ValueElement::UI_ADVANCED_ATTRIBUTE = "uiadvanced";
-const string ValueElement::UNIT_ATTRIBUTE = "unit";
-const string ValueElement::UNITTYPE_ATTRIBUTE = "unittype";
-const string ValueElement::UNIFORM_ATTRIBUTE = "uniform";
+const string& Element::NAME_ATTRIBUTE = internString("name");
+const string& Element::FILE_PREFIX_ATTRIBUTE = internString("fileprefix");
+const string& Element::GEOM_PREFIX_ATTRIBUTE = internString("geomprefix");
+const string& Element::COLOR_SPACE_ATTRIBUTE = internString("colorspace");
+const string& Element::INHERIT_ATTRIBUTE = internString("inherit");
+const string& Element::NAMESPACE_ATTRIBUTE = internString("namespace");
+const string& Element::DOC_ATTRIBUTE = internString("doc");
+const string& TypedElement::TYPE_ATTRIBUTE = internString("type");
+const string& ValueElement::VALUE_ATTRIBUTE = internString("value");
+const string& ValueElement::INTERFACE_NAME_ATTRIBUTE = internString("interfacename");
+const string& ValueElement::ENUM_ATTRIBUTE = internString("enum");
+const string& ValueElement::IMPLEMENTATION_NAME_ATTRIBUTE = internString("implname");
+const string& ValueElement::IMPLEMENTATION_TYPE_ATTRIBUTE = internString("impltype");
+const string& ValueElement::ENUM_VALUES_ATTRIBUTE = internString("enumvalues");
+const string& ValueElement::UI_NAME_ATTRIBUTE = internString("uiname");
+const string& ValueElement::UI_FOLDER_ATTRIBUTE = internString("uifolder");
+const string& ValueElement::UI_MIN_ATTRIBUTE = internString("uimin");
+const string& ValueElement::UI_MAX_ATTRIBUTE = internString("uimax");
+const string& ValueElement::UI_SOFT_MIN_ATTRIBUTE = internString("uisoftmin");
+const string& ValueElement::UI_SOFT_MAX_ATTRIBUTE = internString("uisoftmax");
+const string& ValueElement::UI_STEP_ATTRIBUTE = internString("uistep");
+const string& ValueElement::UI_ADVANCED_ATTRIBUTE = internString("uiadvanced");
+const string& ValueElement::UNIT_ATTRIBUTE = internString("unit");
+const string& ValueElement::UNITTYPE_ATTRIBUTE = internString("unittype");
+const string& ValueElement::UNIFORM_ATTRIBUTE = internString("uniform");
+
+const size_t ElementArena::DEFAULT_BLOCK_SIZE = 64 * 1024;
 
 Element::CreatorMap Element::_creatorMap;
 
+//
+// ElementArena methods
+//
+
+void* ElementArena::allocate(size_t size, size_t alignment)
+{
+    // Allocations that would waste much of a block receive their own.
+    if (size > _blockSize / 4)
+    {
+        _blocks.emplace_back(new char[size]);
+        _allocatedBytes += size;
+        return _blocks.back().get();
+    }
+
+    size_t offset = (_blockOffset + alignment - 1) & ~(alignment - 1);
+    if (!_currentBlock || offset + size > _blockSize)
+    {
+        _blocks.emplace_back(new char[_blockSize]);
+        _currentBlock = _blocks.back().get();
+        offset = 0;
+    }
+
+    _blockOffset = offset + size;
+    _allocatedBytes += size;
+    return _currentBlock + offset;
+}
+
 //
 // Element methods
 //
@@ -54,14 +83,9 @@ bool Element::operator==(const Element& rhs) const
         return false;
     }
 
-    // Compare attributes.
-    if (getAttributeNames() != rhs.getAttributeNames())
+    // Compare attributes, whose names are interned.
+    if (_attributes != rhs._attributes)
         return false;
-    for (const string& attr : rhs.getAttributeNames())
-    {
-        if (getAttribute(attr) != rhs.getAttribute(attr))
-            return false;
-    }
 
     // Compare children.
     const vector<ElementPtr>& c1 = getChildren();
@@ -89,8 +113,8 @@ void Element::setName(const string& name)
         throw Exception("Element name is not unique at the given scope: " + name);
     }
 
-    getDocument()->invalidateCache();
-
+    // Cached lookups are keyed by attribute values rather than element
+    // names, so renaming requires no cache update.
     if (parent)
     {
         parent->_childMap.erase(getName());
@@ -133,17 +157,28 @@ ElementPtr Element::getDescendant(const string& namePath) const
     return elem;
 }
 
-void Element::registerChildElement(ElementPtr child)
+StringVec Element::getAttributeNames() const
 {
-    getDocument()->invalidateCache();
+    StringVec names;
+    names.reserve(_attributes.size());
+    for (const auto& attr : _attributes)
+    {
+        names.push_back(*attr.first);
+    }
+    return names;
+}
 
+void Element::registerChildElement(ElementPtr child)
+{
     _childMap[child->getName()] = child;
     _childOrder.push_back(child);
+
+    getDocument()->onAddElement(child);
 }
 
 void Element::unregisterChildElement(ElementPtr child)
 {
-    getDocument()->invalidateCache();
+    getDocument()->onRemoveElement(child);
 
     _childMap.erase(child->getName());
     _childOrder.erase(
@@ -192,25 +227,35 @@ void Element::removeChild(const string& name)
 
 void Element::setAttribute(const string& attrib, const string& value)
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->onAttributeChanging(getSelf(), attrib);
 
-    if (!_attributeMap.count(attrib))
+    AttributeVec::const_iterator it = findAttribute(attrib);
+    if (it != _attributes.end())
+    {
+        _attributes[it - _attributes.begin()].second = value;
+    }
+    else
     {
-        _attributeOrder.push_back(attrib);
+        _attributes.emplace_back(&internString(attrib), value);
     }
-    _attributeMap[attrib] = value;
+    invalidateAttribute(attrib);
+
+    doc->onAttributeChanged(getSelf(), attrib);
 }
 
 void Element::removeAttribute(const string& attrib)
 {
-    StringMap::iterator it = _attributeMap.find(attrib);
-    if (it != _attributeMap.end())
+    AttributeVec::const_iterator it = findAttribute(attrib);
+    if (it != _attributes.end())
     {
-        getDocument()->invalidateCache();
+        DocumentPtr doc = getDocument();
+        doc->onAttributeChanging(getSelf(), attrib);
+
+        _attributes.erase(_attributes.begin() + (it - _attributes.begin()));
+        invalidateAttribute(attrib);
 
-        _attributeMap.erase(it);
-        _attributeOrder.erase(
-            std::find(_attributeOrder.begin(), _attributeOrder.end(), attrib));
+        doc->onAttributeChanged(getSelf(), attrib);
     }
 }
 
@@ -298,6 +343,11 @@ ConstElementPtr Element::getRoot() const
     return root;
 }
 
+ElementArenaPtr Element::getElementArena() const
+{
+    return getDocument()->_arena;
+}
+
 DocumentPtr Element::getDocument()
 {
     return getRoot()->asA<Document>();
@@ -361,11 +411,14 @@ InheritanceIterator Element::traverseInheritance() const
 
 void Element::copyContentFrom(const ConstElementPtr& source)
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->onRemoveElement(getSelf());
 
     _sourceUri = source->_sourceUri;
-    _attributeMap = source->_attributeMap;
-    _attributeOrder = source->_attributeOrder;
+    _attributes = source->_attributes;
+    invalidateAttribute(EMPTY_STRING);
+
+    doc->onAddElement(getSelf());
 
     for (auto child : source->getChildren())
     {
@@ -386,11 +439,11 @@ void Element::copyContentFrom(const ConstElementPtr& source)
 
 void Element::clearContent()
 {
-    getDocument()->invalidateCache();
+    getDocument()->onRemoveElement(getSelf());
 
     _sourceUri.clear();
-    _attributeMap.clear();
-    _attributeOrder.clear();
+    _attributes.clear();
+    invalidateAttribute(EMPTY_STRING);
     _childMap.clear();
     _childOrder.clear();
 }
@@ -446,9 +499,9 @@ string Element::asString() const
     {
         res += " name=\"" + getName() + "\"";
     }
-    for (const string& attrName : getAttributeNames())
+    for (const auto& attr : _attributes)
     {
-        res += " " + attrName + "=\"" + getAttribute(attrName) + "\"";
+        res += " " + *attr.first + "=\"" + attr.second + "\"";
     }
     res += ">";
     return res;
@@ -479,6 +532,41 @@ TypeDefPtr TypedElement::getTypeDef() const
 // ValueElement methods
 //
 
+ValuePtr ValueElement::getValue() const
+{
+    // The cache is accessed atomically, allowing concurrent queries of
+    // elements that are not being modified.
+    ValuePtr value = std::atomic_load(&_cachedValue);
+    if (value || !hasValue())
+    {
+        return value;
+    }
+    value = Value::createValueFromStrings(getValueString(), getType());
+    std::atomic_store(&_cachedValue, value);
+    return value;
+}
+
+ValuePtr ValueElement::getResolvedValue(StringResolverPtr resolver) const
+{
+    if (!hasValue())
+    {
+        return ValuePtr();
+    }
+    if (!StringResolver::isResolvedType(getType()))
+    {
+        return getValue();
+    }
+    return Value::createValueFromStrings(getResolvedValueString(resolver), getType());
+}
+
+void ValueElement::invalidateAttribute(const string& attrib)
+{
+    if (attrib.empty() || attrib == VALUE_ATTRIBUTE || attrib == TYPE_ATTRIBUTE)
+    {
+        std::atomic_store(&_cachedValue, ValuePtr());
+    }
+}
+
 string ValueElement::getResolvedValueString(StringResolverPtr resolver) const
 {
     if (!StringResolver::isResolvedType(getType()))
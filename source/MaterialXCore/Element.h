@@ -26,6 +26,7 @@ class CommentElement;
 class GenericElement;
 class StringResolver;
 class Document;
+class ElementArena;
 
 /// A shared pointer to an Element
 using ElementPtr = shared_ptr<Element>;
@@ -60,12 +61,101 @@ using ConstGenericElementPtr = shared_ptr<const GenericElement>;
 /// A shared pointer to a StringResolver
 using StringResolverPtr = shared_ptr<StringResolver>;
 
+/// A shared pointer to an ElementArena
+using ElementArenaPtr = shared_ptr<ElementArena>;
+
 /// A hash map from strings to elements
 using ElementMap = std::unordered_map<string, ElementPtr>;
 
 /// A standard function taking an ElementPtr and returning a boolean.
 using ElementPredicate = std::function<bool(ConstElementPtr)>;
 
+/// @class ElementArena
+/// A block allocator for the elements of a single document.
+///
+/// Elements allocated from an arena are never freed individually; their
+/// memory is released in bulk when the arena itself is destroyed, which
+/// occurs once its document and all elements allocated from it have been
+/// released.
+class MX_CORE_API ElementArena
+{
+  public:
+    ElementArena(size_t blockSize = DEFAULT_BLOCK_SIZE) :
+        _blockSize(blockSize),
+        _currentBlock(nullptr),
+        _blockOffset(0),
+        _allocatedBytes(0)
+    {
+    }
+    ~ElementArena() { }
+    ElementArena(const ElementArena&) = delete;
+    ElementArena& operator=(const ElementArena&) = delete;
+
+    /// Allocate memory of the given size and alignment from the arena.
+    void* allocate(size_t size, size_t alignment);
+
+    /// Return the total number of bytes allocated from the arena.
+    size_t getAllocatedBytes() const
+    {
+        return _allocatedBytes;
+    }
+
+  public:
+    static const size_t DEFAULT_BLOCK_SIZE;
+
+  private:
+    vector<std::unique_ptr<char[]>> _blocks;
+    size_t _blockSize;
+    char* _currentBlock;
+    size_t _blockOffset;
+    size_t _allocatedBytes;
+};
+
+/// @class ArenaAllocator
+/// A standard allocator that draws memory from an ElementArena, retaining
+/// a reference to the arena for the lifetime of each allocation.
+template <class T> class ArenaAllocator
+{
+  public:
+    using value_type = T;
+
+    ArenaAllocator(ElementArenaPtr arena) :
+        _arena(arena)
+    {
+    }
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& other) :
+        _arena(other.getArena())
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t)
+    {
+        // Memory is released in bulk with the arena.
+    }
+
+    ElementArenaPtr getArena() const
+    {
+        return _arena;
+    }
+
+    template <class U> bool operator==(const ArenaAllocator<U>& rhs) const
+    {
+        return _arena == rhs.getArena();
+    }
+    template <class U> bool operator!=(const ArenaAllocator<U>& rhs) const
+    {
+        return _arena != rhs.getArena();
+    }
+
+  private:
+    ElementArenaPtr _arena;
+};
+
 /// @class Element
 /// The base class for MaterialX elements.
 ///
@@ -75,7 +165,7 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
 {
   protected:
     Element(ElementPtr parent, const string& category, const string& name) :
-        _category(category),
+        _category(&internString(category)),
         _name(name),
         _parent(parent),
         _root(parent ? parent->getRoot() : nullptr)
@@ -107,7 +197,7 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// Set the element's category string.
     void setCategory(const string& category)
     {
-        _category = category;
+        _category = &internString(category);
     }
 
     /// Return the element's category string.  The category of a MaterialX
@@ -115,7 +205,7 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// being "material", "nodegraph", and "image".
     const string& getCategory() const
     {
-        return _category;
+        return *_category;
     }
 
     /// @}
@@ -490,22 +580,19 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// Return true if the given attribute is present.
     bool hasAttribute(const string& attrib) const
     {
-        return _attributeMap.count(attrib) != 0;
+        return findAttribute(attrib) != _attributes.end();
     }
 
     /// Return the value string of the given attribute.  If the given attribute
     /// is not present, then an empty string is returned.
     const string& getAttribute(const string& attrib) const
     {
-        StringMap::const_iterator it = _attributeMap.find(attrib);
-        return (it != _attributeMap.end()) ? it->second : EMPTY_STRING;
+        AttributeVec::const_iterator it = findAttribute(attrib);
+        return (it != _attributes.end()) ? it->second : EMPTY_STRING;
     }
 
     /// Return a vector of stored attribute names, in the order they were set.
-    const StringVec& getAttributeNames() const
-    {
-        return _attributeOrder;
-    }
+    StringVec getAttributeNames() const;
 
     /// Set the value of an implicitly typed attribute.  Since an attribute
     /// stores no explicit type, the same type argument must be used in
@@ -790,18 +877,50 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     void validateRequire(bool expression, bool& res, string* message, string errorDesc) const;
 
   public:
-    static const string NAME_ATTRIBUTE;
-    static const string FILE_PREFIX_ATTRIBUTE;
-    static const string GEOM_PREFIX_ATTRIBUTE;
-    static const string COLOR_SPACE_ATTRIBUTE;
-    static const string INHERIT_ATTRIBUTE;
-    static const string NAMESPACE_ATTRIBUTE;
-    static const string DOC_ATTRIBUTE;
+    // Attribute name constants are interned strings, so that lookups by
+    // constant compare addresses rather than string contents.
+    static const string& NAME_ATTRIBUTE;
+    static const string& FILE_PREFIX_ATTRIBUTE;
+    static const string& GEOM_PREFIX_ATTRIBUTE;
+    static const string& COLOR_SPACE_ATTRIBUTE;
+    static const string& INHERIT_ATTRIBUTE;
+    static const string& NAMESPACE_ATTRIBUTE;
+    static const string& DOC_ATTRIBUTE;
 
   protected:
+    // A flat vector of attributes in the order they were set, with each
+    // attribute name interned across all elements.
+    using AttributeVec = vector<std::pair<const string*, string>>;
+
     virtual void registerChildElement(ElementPtr child);
     virtual void unregisterChildElement(ElementPtr child);
 
+    // Invalidate any data cached from the given attribute, or from all
+    // attributes if the given name is empty.
+    virtual void invalidateAttribute(const string&) { }
+
+    // Return the stored attribute with the given name, if any.  Names are
+    // first compared by address, which matches interned names such as the
+    // attribute name constants, and then by content.
+    AttributeVec::const_iterator findAttribute(const string& attrib) const
+    {
+        for (AttributeVec::const_iterator it = _attributes.begin(); it != _attributes.end(); ++it)
+        {
+            if (it->first == &attrib)
+            {
+                return it;
+            }
+        }
+        for (AttributeVec::const_iterator it = _attributes.begin(); it != _attributes.end(); ++it)
+        {
+            if (*it->first == attrib)
+            {
+                return it;
+            }
+        }
+        return _attributes.end();
+    }
+
     // Return a non-const copy of our self pointer, for use in constructing
     // graph traversal objects that require non-const storage.
     ElementPtr getSelfNonConst() const
@@ -810,25 +929,39 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     }
 
   protected:
-    string _category;
+    const string* _category;
     string _name;
     string _sourceUri;
 
     ElementMap _childMap;
     vector<ElementPtr> _childOrder;
 
-    StringMap _attributeMap;
-    StringVec _attributeOrder;
+    AttributeVec _attributes;
 
     weak_ptr<Element> _parent;
     weak_ptr<Element> _root;
 
   private:
-    template <class T> static ElementPtr createElement(ElementPtr parent, const string& name)
+    // Return the element arena of our document, if any.
+    ElementArenaPtr getElementArena() const;
+
+    // Allocate a new element of the given subclass, drawing from the element
+    // arena of the parent's document if one is present.
+    template <class T> static shared_ptr<T> allocateElement(ElementPtr parent, const string& name)
     {
+        ElementArenaPtr arena = parent->getElementArena();
+        if (arena)
+        {
+            return std::allocate_shared<T>(ArenaAllocator<T>(arena), parent, name);
+        }
         return std::make_shared<T>(parent, name);
     }
 
+    template <class T> static ElementPtr createElement(ElementPtr parent, const string& name)
+    {
+        return allocateElement<T>(parent, name);
+    }
+
   private:
     using CreatorFunction = ElementPtr (*)(ElementPtr, const string&);
     using CreatorMap = std::unordered_map<string, CreatorFunction>;
@@ -890,7 +1023,7 @@ class MX_CORE_API TypedElement : public Element
     /// @}
 
 public:
-    static const string TYPE_ATTRIBUTE;
+    static const string& TYPE_ATTRIBUTE;
 };
 
 /// @class ValueElement
@@ -1003,14 +1136,13 @@ class MX_CORE_API ValueElement : public TypedElement
     /// Return the typed value of an element as a generic value object, which
     /// may be queried to access its data.
     ///
+    /// The parsed value is cached until the value or type of the element
+    /// changes, so the returned object is shared between calls and should
+    /// not be modified.
+    ///
     /// @return A shared pointer to the typed value of this element, or an
     ///    empty shared pointer if no value is present.
-    ValuePtr getValue() const
-    {
-        if (!hasValue())
-            return ValuePtr();
-        return Value::createValueFromStrings(getValueString(), getType());
-    }
+    ValuePtr getValue() const;
 
     /// Return the resolved value of an element as a generic value object, which
     /// may be queried to access its data.
@@ -1020,12 +1152,7 @@ class MX_CORE_API ValueElement : public TypedElement
     ///    will be created at this scope and applied to the return value.
     /// @return A shared pointer to the typed value of this element, or an
     ///    empty shared pointer if no value is present.
-    ValuePtr getResolvedValue(StringResolverPtr resolver = nullptr) const
-    {
-        if (!hasValue())
-            return ValuePtr();
-        return Value::createValueFromStrings(getResolvedValueString(resolver), getType());
-    }
+    ValuePtr getResolvedValue(StringResolverPtr resolver = nullptr) const;
 
     /// Return the default value for this element as a generic value object, which
     /// may be queried to access its data.
@@ -1105,23 +1232,30 @@ class MX_CORE_API ValueElement : public TypedElement
     /// @}
 
   public:
-    static const string VALUE_ATTRIBUTE;
-    static const string INTERFACE_NAME_ATTRIBUTE;
-    static const string IMPLEMENTATION_NAME_ATTRIBUTE;
-    static const string IMPLEMENTATION_TYPE_ATTRIBUTE;
-    static const string ENUM_ATTRIBUTE;
-    static const string ENUM_VALUES_ATTRIBUTE;
-    static const string UI_NAME_ATTRIBUTE;
-    static const string UI_FOLDER_ATTRIBUTE;
-    static const string UI_MIN_ATTRIBUTE;
-    static const string UI_MAX_ATTRIBUTE;
-    static const string UI_SOFT_MIN_ATTRIBUTE;
-    static const string UI_SOFT_MAX_ATTRIBUTE;
-    static const string UI_STEP_ATTRIBUTE;
-    static const string UI_ADVANCED_ATTRIBUTE;
-    static const string UNIT_ATTRIBUTE;
-    static const string UNITTYPE_ATTRIBUTE;
-    static const string UNIFORM_ATTRIBUTE;
+    static const string& VALUE_ATTRIBUTE;
+    static const string& INTERFACE_NAME_ATTRIBUTE;
+    static const string& IMPLEMENTATION_NAME_ATTRIBUTE;
+    static const string& IMPLEMENTATION_TYPE_ATTRIBUTE;
+    static const string& ENUM_ATTRIBUTE;
+    static const string& ENUM_VALUES_ATTRIBUTE;
+    static const string& UI_NAME_ATTRIBUTE;
+    static const string& UI_FOLDER_ATTRIBUTE;
+    static const string& UI_MIN_ATTRIBUTE;
+    static const string& UI_MAX_ATTRIBUTE;
+    static const string& UI_SOFT_MIN_ATTRIBUTE;
+    static const string& UI_SOFT_MAX_ATTRIBUTE;
+    static const string& UI_STEP_ATTRIBUTE;
+    static const string& UI_ADVANCED_ATTRIBUTE;
+    static const string& UNIT_ATTRIBUTE;
+    static const string& UNITTYPE_ATTRIBUTE;
+    static const string& UNIFORM_ATTRIBUTE;
+
+  protected:
+    void invalidateAttribute(const string& attrib) override;
+
+  private:
+    // The parsed value of this element, computed on demand.
+    mutable ValuePtr _cachedValue;
 };
 
 /// @class Token
@@ -1318,7 +1452,7 @@ template<class T> shared_ptr<T> Element::addChild(const string& name)
     if (_childMap.count(childName))
         throw Exception("Child name is not unique: " + childName);
 
-    shared_ptr<T> child = std::make_shared<T>(getSelf(), childName);
+    shared_ptr<T> child = allocateElement<T>(getSelf(), childName);
     registerChildElement(child);
 
     return child;
@@ -16,14 +16,14 @@ const string UDIMSET = "udimset";
 const string UDIM_TOKEN = "<UDIM>";
 const string UV_TILE_TOKEN = "<UVTILE>";
 
-const string GeomElement::GEOM_ATTRIBUTE = "geom";
-const string GeomElement::COLLECTION_ATTRIBUTE = "collection";
-const string GeomPropDef::GEOM_PROP_ATTRIBUTE = "geomprop";
-const string GeomPropDef::SPACE_ATTRIBUTE = "space";
-const string GeomPropDef::INDEX_ATTRIBUTE = "index";
-const string Collection::INCLUDE_GEOM_ATTRIBUTE = "includegeom";
-const string Collection::EXCLUDE_GEOM_ATTRIBUTE = "excludegeom";
-const string Collection::INCLUDE_COLLECTION_ATTRIBUTE = "includecollection";
+const string& GeomElement::GEOM_ATTRIBUTE = internString("geom");
+const string& GeomElement::COLLECTION_ATTRIBUTE = internString("collection");
+const string& GeomPropDef::GEOM_PROP_ATTRIBUTE = internString("geomprop");
+const string& GeomPropDef::SPACE_ATTRIBUTE = internString("space");
+const string& GeomPropDef::INDEX_ATTRIBUTE = internString("index");
+const string& Collection::INCLUDE_GEOM_ATTRIBUTE = internString("includegeom");
+const string& Collection::EXCLUDE_GEOM_ATTRIBUTE = internString("excludegeom");
+const string& Collection::INCLUDE_COLLECTION_ATTRIBUTE = internString("includecollection");
 
 bool geomStringsMatch(const string& geom1, const string& geom2, bool contains)
 {
@@ -229,8 +229,8 @@ class MX_CORE_API GeomElement : public Element
     /// @}
 
   public:
-    static const string GEOM_ATTRIBUTE;
-    static const string COLLECTION_ATTRIBUTE;
+    static const string& GEOM_ATTRIBUTE;
+    static const string& COLLECTION_ATTRIBUTE;
 };
 
 /// @class GeomInfo
@@ -435,9 +435,9 @@ class MX_CORE_API GeomPropDef : public Element
 
   public:
     static const string CATEGORY;
-    static const string GEOM_PROP_ATTRIBUTE;
-    static const string SPACE_ATTRIBUTE;
-    static const string INDEX_ATTRIBUTE;
+    static const string& GEOM_PROP_ATTRIBUTE;
+    static const string& SPACE_ATTRIBUTE;
+    static const string& INDEX_ATTRIBUTE;
 };
 
 /// @class Collection
@@ -569,9 +569,9 @@ class MX_CORE_API Collection : public Element
 
   public:
     static const string CATEGORY;
-    static const string INCLUDE_GEOM_ATTRIBUTE;
-    static const string EXCLUDE_GEOM_ATTRIBUTE;
-    static const string INCLUDE_COLLECTION_ATTRIBUTE;
+    static const string& INCLUDE_GEOM_ATTRIBUTE;
+    static const string& EXCLUDE_GEOM_ATTRIBUTE;
+    static const string& INCLUDE_COLLECTION_ATTRIBUTE;
 };
 
 template<class T> GeomPropPtr GeomInfo::setGeomPropValue(const string& name,
@@ -15,16 +15,16 @@
 namespace MaterialX
 {
 
-const string PortElement::NODE_NAME_ATTRIBUTE = "nodename";
-const string PortElement::NODE_GRAPH_ATTRIBUTE = "nodegraph";
-const string PortElement::OUTPUT_ATTRIBUTE = "output";
-const string PortElement::CHANNELS_ATTRIBUTE = "channels";
-const string InterfaceElement::NODE_DEF_ATTRIBUTE = "nodedef";
-const string InterfaceElement::TARGET_ATTRIBUTE = "target";
-const string InterfaceElement::VERSION_ATTRIBUTE = "version";
-const string InterfaceElement::DEFAULT_VERSION_ATTRIBUTE = "isdefaultversion";
-const string Input::DEFAULT_GEOM_PROP_ATTRIBUTE = "defaultgeomprop";
-const string Output::DEFAULT_INPUT_ATTRIBUTE = "defaultinput";
+const string& PortElement::NODE_NAME_ATTRIBUTE = internString("nodename");
+const string& PortElement::NODE_GRAPH_ATTRIBUTE = internString("nodegraph");
+const string& PortElement::OUTPUT_ATTRIBUTE = internString("output");
+const string& PortElement::CHANNELS_ATTRIBUTE = internString("channels");
+const string& InterfaceElement::NODE_DEF_ATTRIBUTE = internString("nodedef");
+const string& InterfaceElement::TARGET_ATTRIBUTE = internString("target");
+const string& InterfaceElement::VERSION_ATTRIBUTE = internString("version");
+const string& InterfaceElement::DEFAULT_VERSION_ATTRIBUTE = internString("isdefaultversion");
+const string& Input::DEFAULT_GEOM_PROP_ATTRIBUTE = internString("defaultgeomprop");
+const string& Output::DEFAULT_INPUT_ATTRIBUTE = internString("defaultinput");
 
 // Map from type strings to swizzle pattern character sets.
 const std::unordered_map<string, CharSet> PortElement::CHANNELS_CHARACTER_SET =
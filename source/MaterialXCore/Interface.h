@@ -183,10 +183,10 @@ class MX_CORE_API PortElement : public ValueElement
     /// @}
 
   public:
-    static const string NODE_NAME_ATTRIBUTE;
-    static const string NODE_GRAPH_ATTRIBUTE;
-    static const string OUTPUT_ATTRIBUTE;
-    static const string CHANNELS_ATTRIBUTE;
+    static const string& NODE_NAME_ATTRIBUTE;
+    static const string& NODE_GRAPH_ATTRIBUTE;
+    static const string& OUTPUT_ATTRIBUTE;
+    static const string& CHANNELS_ATTRIBUTE;
 
   private:
     static const std::unordered_map<string, CharSet> CHANNELS_CHARACTER_SET;
@@ -262,7 +262,7 @@ class MX_CORE_API Input : public PortElement
 
   public:
     static const string CATEGORY;
-    static const string DEFAULT_GEOM_PROP_ATTRIBUTE;
+    static const string& DEFAULT_GEOM_PROP_ATTRIBUTE;
 };
 
 /// @class Output
@@ -305,7 +305,7 @@ class MX_CORE_API Output : public PortElement
 
   public:
     static const string CATEGORY;
-    static const string DEFAULT_INPUT_ATTRIBUTE;
+    static const string& DEFAULT_INPUT_ATTRIBUTE;
 };
 
 /// @class InterfaceElement
@@ -649,10 +649,10 @@ class MX_CORE_API InterfaceElement : public TypedElement
     /// @}
 
   public:
-    static const string NODE_DEF_ATTRIBUTE;
-    static const string TARGET_ATTRIBUTE;
-    static const string VERSION_ATTRIBUTE;
-    static const string DEFAULT_VERSION_ATTRIBUTE;
+    static const string& NODE_DEF_ATTRIBUTE;
+    static const string& TARGET_ATTRIBUTE;
+    static const string& VERSION_ATTRIBUTE;
+    static const string& DEFAULT_VERSION_ATTRIBUTE;
 
   protected:
     void registerChildElement(ElementPtr child) override;
@@ -10,16 +10,16 @@
 namespace MaterialX
 {
 
-const string MaterialAssign::MATERIAL_ATTRIBUTE = "material";
-const string MaterialAssign::EXCLUSIVE_ATTRIBUTE = "exclusive";
+const string& MaterialAssign::MATERIAL_ATTRIBUTE = internString("material");
+const string& MaterialAssign::EXCLUSIVE_ATTRIBUTE = internString("exclusive");
 
-const string Visibility::VIEWER_GEOM_ATTRIBUTE = "viewergeom";
-const string Visibility::VIEWER_COLLECTION_ATTRIBUTE = "viewercollection";
-const string Visibility::VISIBILITY_TYPE_ATTRIBUTE = "vistype";
-const string Visibility::VISIBLE_ATTRIBUTE = "visible";
+const string& Visibility::VIEWER_GEOM_ATTRIBUTE = internString("viewergeom");
+const string& Visibility::VIEWER_COLLECTION_ATTRIBUTE = internString("viewercollection");
+const string& Visibility::VISIBILITY_TYPE_ATTRIBUTE = internString("vistype");
+const string& Visibility::VISIBLE_ATTRIBUTE = internString("visible");
 
-const string LookGroup::LOOKS_ATTRIBUTE = "looks";
-const string LookGroup::ACTIVE_ATTRIBUTE = "active";
+const string& LookGroup::LOOKS_ATTRIBUTE = internString("looks");
+const string& LookGroup::ACTIVE_ATTRIBUTE = internString("active");
 
 vector<MaterialAssignPtr> getGeometryBindings(const NodePtr& materialNode, const string& geom)
 {
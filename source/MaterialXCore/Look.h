@@ -277,8 +277,8 @@ class MX_CORE_API LookGroup : public Element
 
   public:
     static const string CATEGORY;
-    static const string LOOKS_ATTRIBUTE;
-    static const string ACTIVE_ATTRIBUTE;
+    static const string& LOOKS_ATTRIBUTE;
+    static const string& ACTIVE_ATTRIBUTE;
 };
 
 /// @class MaterialAssign
@@ -373,8 +373,8 @@ class MX_CORE_API MaterialAssign : public GeomElement
     }
   public:
     static const string CATEGORY;
-    static const string MATERIAL_ATTRIBUTE;
-    static const string EXCLUSIVE_ATTRIBUTE;
+    static const string& MATERIAL_ATTRIBUTE;
+    static const string& EXCLUSIVE_ATTRIBUTE;
 };
 
 /// @class Visibility
@@ -479,10 +479,10 @@ class MX_CORE_API Visibility : public GeomElement
 
   public:
     static const string CATEGORY;
-    static const string VIEWER_GEOM_ATTRIBUTE;
-    static const string VIEWER_COLLECTION_ATTRIBUTE;
-    static const string VISIBILITY_TYPE_ATTRIBUTE;
-    static const string VISIBLE_ATTRIBUTE;
+    static const string& VIEWER_GEOM_ATTRIBUTE;
+    static const string& VIEWER_COLLECTION_ATTRIBUTE;
+    static const string& VISIBILITY_TYPE_ATTRIBUTE;
+    static const string& VISIBLE_ATTRIBUTE;
 };
 
 /// Return a vector of all MaterialAssign elements that bind this material node
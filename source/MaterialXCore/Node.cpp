@@ -13,9 +13,9 @@
 namespace MaterialX
 {
 
-const string Backdrop::CONTAINS_ATTRIBUTE = "contains";
-const string Backdrop::WIDTH_ATTRIBUTE = "width";
-const string Backdrop::HEIGHT_ATTRIBUTE = "height";
+const string& Backdrop::CONTAINS_ATTRIBUTE = internString("contains");
+const string& Backdrop::WIDTH_ATTRIBUTE = internString("width");
+const string& Backdrop::HEIGHT_ATTRIBUTE = internString("height");
 
 //
 // Node methods
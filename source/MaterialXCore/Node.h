@@ -469,9 +469,9 @@ class MX_CORE_API Backdrop : public Element
 
   public:
     static const string CATEGORY;
-    static const string CONTAINS_ATTRIBUTE;
-    static const string WIDTH_ATTRIBUTE;
-    static const string HEIGHT_ATTRIBUTE;
+    static const string& CONTAINS_ATTRIBUTE;
+    static const string& WIDTH_ATTRIBUTE;
+    static const string& HEIGHT_ATTRIBUTE;
 };
 
 } // namespace MaterialX
@@ -10,10 +10,10 @@
 namespace MaterialX
 {
 
-const string PropertyAssign::PROPERTY_ATTRIBUTE = "property";
-const string PropertyAssign::GEOM_ATTRIBUTE = "geom";
-const string PropertyAssign::COLLECTION_ATTRIBUTE = "collection";
-const string PropertySetAssign::PROPERTY_SET_ATTRIBUTE = "propertyset";
+const string& PropertyAssign::PROPERTY_ATTRIBUTE = internString("property");
+const string& PropertyAssign::GEOM_ATTRIBUTE = internString("geom");
+const string& PropertyAssign::COLLECTION_ATTRIBUTE = internString("collection");
+const string& PropertySetAssign::PROPERTY_SET_ATTRIBUTE = internString("propertyset");
 
 //
 // PropertyAssign methods
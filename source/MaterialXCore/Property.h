@@ -142,9 +142,9 @@ class MX_CORE_API PropertyAssign : public ValueElement
 
   public:
     static const string CATEGORY;
-    static const string PROPERTY_ATTRIBUTE;
-    static const string GEOM_ATTRIBUTE;
-    static const string COLLECTION_ATTRIBUTE;
+    static const string& PROPERTY_ATTRIBUTE;
+    static const string& GEOM_ATTRIBUTE;
+    static const string& COLLECTION_ATTRIBUTE;
 };
 
 /// @class PropertySet
@@ -264,7 +264,7 @@ class MX_CORE_API PropertySetAssign : public GeomElement
 
   public:
     static const string CATEGORY;
-    static const string PROPERTY_SET_ATTRIBUTE;
+    static const string& PROPERTY_SET_ATTRIBUTE;
 };
 
 } // namespace MaterialX
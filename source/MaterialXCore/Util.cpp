@@ -6,6 +6,8 @@
 #include <MaterialXCore/Types.h>
 
 #include <cctype>
+#include <mutex>
+#include <unordered_set>
 
 namespace MaterialX
 {
@@ -27,6 +29,22 @@ bool invalidNameChar(char c)
      return !isalnum(c) && c != '_' && c != ':';
 }
 
+// Hash and equality of interned strings by content.
+struct InternedStringHash
+{
+    size_t operator()(const string* str) const
+    {
+        return std::hash<string>()(*str);
+    }
+};
+struct InternedStringEqual
+{
+    bool operator()(const string* lhs, const string* rhs) const
+    {
+        return *lhs == *rhs;
+    }
+};
+
 } // anonymous namespace
 
 //
@@ -108,6 +126,30 @@ string replaceSubstrings(string str, const StringMap& stringMap)
     return str;
 }
 
+const string& internString(const string& str)
+{
+    static std::mutex internMutex;
+    static std::unordered_set<string> internSet;
+
+    // Each thread remembers the strings it has interned, so that the shared
+    // table is locked only on the first use of each string by a thread, and
+    // threads parsing documents concurrently rarely contend.
+    thread_local std::unordered_set<const string*, InternedStringHash, InternedStringEqual> threadSet;
+    auto it = threadSet.find(&str);
+    if (it != threadSet.end())
+    {
+        return **it;
+    }
+
+    const string* interned;
+    {
+        std::lock_guard<std::mutex> guard(internMutex);
+        interned = &*internSet.insert(str).first;
+    }
+    threadSet.insert(interned);
+    return *interned;
+}
+
 string stringToLower(string str)
 {
     std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c)
@@ -137,6 +179,23 @@ string trimSpaces(const string& str)
     return result;
 }
 
+uint64_t computeContentHash(const char* data, size_t size, uint64_t seed)
+{
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (uint64_t) (unsigned char) data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t computeContentHash(const string& str, uint64_t seed)
+{
+    return computeContentHash(str.data(), str.size(), seed);
+}
+
 StringVec splitNamePath(const string& namePath)
 {
     StringVec nameVec = splitString(namePath, NAME_PATH_SEPARATOR);
@@ -48,12 +48,27 @@ MX_CORE_API bool stringEndsWith(const string& str, const string& suffix);
 /// Trim leading and trailing spaces from a string.
 MX_CORE_API string trimSpaces(const string& str);
 
+/// Return a process-wide interned copy of the given string.  Equal strings
+/// are interned at a single address, which remains valid for the lifetime
+/// of the process.  This function may be called concurrently, and locks the
+/// shared table only on the first use of each string by a thread.
+MX_CORE_API const string& internString(const string& str);
+
 /// Combine the hash of a value with an existing seed.
 template<typename T> void hashCombine(size_t& seed, const T& value)
 {
     seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 } 
 
+/// Compute a 64-bit FNV-1a hash of the given bytes, continuing from the
+/// given seed.  Unlike std::hash, the result is stable across platforms and
+/// processes, so it may be persisted and compared between runs.
+MX_CORE_API uint64_t computeContentHash(const char* data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+/// Compute a stable 64-bit hash of the given string, continuing from the
+/// given seed.
+MX_CORE_API uint64_t computeContentHash(const string& str, uint64_t seed = 14695981039346656037ULL);
+
 /// Split a name path into string vector
 MX_CORE_API StringVec splitNamePath(const string& namePath);
 
@@ -5,7 +5,10 @@
 
 #include <MaterialXCore/Value.h>
 
-#include <iomanip>
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+#include <limits>
 #include <sstream>
 #include <type_traits>
 
@@ -18,6 +21,16 @@ int Value::_floatPrecision = 6;
 
 namespace {
 
+// The float formatting applied by ScopedFloatFormatting on the current
+// thread, overriding the process-wide formatting while active.
+struct FloatFormatOverride
+{
+    bool active = false;
+    Value::FloatFormat format = Value::FloatFormatDefault;
+    int precision = 6;
+};
+thread_local FloatFormatOverride floatFormatOverride;
+
 template <class T> using enable_if_mx_vector_t =
     typename std::enable_if<std::is_base_of<VectorBase, T>::value, T>::type;
 template <class T> using enable_if_mx_matrix_t =
@@ -28,102 +41,411 @@ template <class T> class is_std_vector< vector<T> > : public std::true_type { };
 template <class T> using enable_if_std_vector_t =
     typename std::enable_if<is_std_vector<T>::value, T>::type;
 
-template <class T> void stringToData(const string& str, T& data)
+const double POWERS_OF_TEN[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Traits for the exact fast path of floating-point parsing, in which both
+// the decimal mantissa and the power of ten are exactly representable.
+template <class T> struct FloatTraits;
+template <> struct FloatTraits<float>
+{
+    static const uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 24;
+    static const int MAX_EXACT_EXPONENT = 10;
+};
+template <> struct FloatTraits<double>
+{
+    static const uint64_t MAX_EXACT_MANTISSA = uint64_t(1) << 53;
+    static const int MAX_EXACT_EXPONENT = 22;
+};
+
+// Parse an integer from the given character range, returning false if the
+// range requires the general stream-based parser.
+template <class T> bool parseIntegerFast(const char* cur, const char* end, T& data)
+{
+    while (cur != end && isSpace(*cur))
+    {
+        cur++;
+    }
+    bool negative = false;
+    if (cur != end && (*cur == '-' || *cur == '+'))
+    {
+        negative = (*cur == '-');
+        cur++;
+    }
+    if (cur == end || !isDigit(*cur))
+    {
+        return false;
+    }
+    uint64_t magnitude = 0;
+    for (int digits = 0; cur != end && isDigit(*cur); cur++, digits++)
+    {
+        if (digits == 18)
+        {
+            return false;
+        }
+        magnitude = magnitude * 10 + (uint64_t) (*cur - '0');
+    }
+    int64_t value = negative ? -(int64_t) magnitude : (int64_t) magnitude;
+    if (value < (int64_t) std::numeric_limits<T>::min() ||
+        value > (int64_t) std::numeric_limits<T>::max())
+    {
+        return false;
+    }
+    data = (T) value;
+    return true;
+}
+
+// Parse a floating-point value from the given character range, returning
+// false if the range requires the general stream-based parser.  Values whose
+// decimal mantissa and exponent are both exactly representable are computed
+// with a single correctly rounded operation.
+template <class T> bool parseFloatFast(const char* cur, const char* end, T& data)
+{
+    while (cur != end && isSpace(*cur))
+    {
+        cur++;
+    }
+    bool negative = false;
+    if (cur != end && (*cur == '-' || *cur == '+'))
+    {
+        negative = (*cur == '-');
+        cur++;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    for (; cur != end && isDigit(*cur); cur++, digits++)
+    {
+        mantissa = mantissa * 10 + (uint64_t) (*cur - '0');
+        if (digits == 18)
+        {
+            return false;
+        }
+    }
+    if (cur != end && *cur == '.')
+    {
+        cur++;
+        for (; cur != end && isDigit(*cur); cur++, digits++)
+        {
+            mantissa = mantissa * 10 + (uint64_t) (*cur - '0');
+            exponent--;
+            if (digits == 18)
+            {
+                return false;
+            }
+        }
+    }
+    if (!digits)
+    {
+        return false;
+    }
+    if (cur != end && (*cur == 'e' || *cur == 'E'))
+    {
+        cur++;
+        bool negativeExponent = false;
+        if (cur != end && (*cur == '-' || *cur == '+'))
+        {
+            negativeExponent = (*cur == '-');
+            cur++;
+        }
+        if (cur == end || !isDigit(*cur))
+        {
+            return false;
+        }
+        int explicitExponent = 0;
+        for (; cur != end && isDigit(*cur); cur++)
+        {
+            explicitExponent = explicitExponent * 10 + (*cur - '0');
+            if (explicitExponent > 1000)
+            {
+                return false;
+            }
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (mantissa > FloatTraits<T>::MAX_EXACT_MANTISSA ||
+        exponent < -FloatTraits<T>::MAX_EXACT_EXPONENT ||
+        exponent > FloatTraits<T>::MAX_EXACT_EXPONENT)
+    {
+        return false;
+    }
+    T value = (T) mantissa;
+    if (exponent < 0)
+    {
+        value /= (T) POWERS_OF_TEN[-exponent];
+    }
+    else if (exponent > 0)
+    {
+        value *= (T) POWERS_OF_TEN[exponent];
+    }
+    data = negative ? -value : value;
+    return true;
+}
+
+template <class T> bool parseFast(const char*, const char*, T&)
+{
+    return false;
+}
+
+template <> bool parseFast(const char* begin, const char* end, int& data)
+{
+    return parseIntegerFast(begin, end, data);
+}
+
+template <> bool parseFast(const char* begin, const char* end, long& data)
+{
+    return parseIntegerFast(begin, end, data);
+}
+
+template <> bool parseFast(const char* begin, const char* end, float& data)
+{
+    return parseFloatFast(begin, end, data);
+}
+
+template <> bool parseFast(const char* begin, const char* end, double& data)
+{
+    return parseFloatFast(begin, end, data);
+}
+
+// Parse a scalar from the given character range, following the conventions
+// of stream extraction.
+template <class T> void parseData(const char* begin, const char* end, T& data)
 {
-    std::stringstream ss(str);
+    if (parseFast(begin, end, data))
+    {
+        return;
+    }
+    std::stringstream ss(string(begin, end));
     if (!(ss >> data))
     {
-        throw ExceptionTypeError("Type mismatch in generic stringToData: " + str);
+        throw ExceptionTypeError("Type mismatch in generic stringToData: " + string(begin, end));
     }
 }
 
-template <> void stringToData(const string& str, bool& data)
+template <> void parseData(const char* begin, const char* end, bool& data)
 {
-    if (str == VALUE_STRING_TRUE)
+    size_t length = (size_t) (end - begin);
+    if (!VALUE_STRING_TRUE.compare(0, string::npos, begin, length))
         data = true;
-    else if (str == VALUE_STRING_FALSE)
+    else if (!VALUE_STRING_FALSE.compare(0, string::npos, begin, length))
         data = false;
     else
-        throw ExceptionTypeError("Type mismatch in boolean stringToData: " + str);
+        throw ExceptionTypeError("Type mismatch in boolean stringToData: " + string(begin, end));
 }
 
-template <> void stringToData(const string& str, string& data)
+template <> void parseData(const char* begin, const char* end, string& data)
 {
-    data = str;
+    data.assign(begin, end);
 }
 
-template <class T> void stringToData(const string& str, enable_if_mx_vector_t<T>& data)
+// Iterate over the tokens of an array value string in place, splitting on
+// the valid array separators.
+class ValueTokenizer
 {
-    StringVec tokens = splitString(str, ARRAY_VALID_SEPARATORS);
-    if (tokens.size() != data.numElements())
+  public:
+    explicit ValueTokenizer(const string& str) :
+        _cur(str.data()),
+        _end(str.data() + str.size())
     {
-        throw ExceptionTypeError("Type mismatch in vector stringToData: " + str);
     }
-    for (size_t i = 0; i < data.numElements(); i++)
+
+    bool next(const char*& begin, const char*& end)
+    {
+        while (_cur != _end && isSeparator(*_cur))
+        {
+            _cur++;
+        }
+        if (_cur == _end)
+        {
+            return false;
+        }
+        begin = _cur;
+        while (_cur != _end && !isSeparator(*_cur))
+        {
+            _cur++;
+        }
+        end = _cur;
+        return true;
+    }
+
+  private:
+    static bool isSeparator(char c)
     {
-        stringToData(tokens[i], data[i]);
+        return ARRAY_VALID_SEPARATORS.find(c) != string::npos;
     }
+
+  private:
+    const char* _cur;
+    const char* _end;
+};
+
+template <class T> void stringToData(const string& str, T& data)
+{
+    parseData(str.data(), str.data() + str.size(), data);
 }
 
-template <class T> void stringToData(const string& str, enable_if_mx_matrix_t<T>& data)
+template <class T> void stringToData(const string& str, enable_if_mx_vector_t<T>& data)
 {
-    StringVec tokens = splitString(str, ARRAY_VALID_SEPARATORS);
-    if (tokens.size() != data.numRows() * data.numColumns())
+    ValueTokenizer tokenizer(str);
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    size_t count = 0;
+    while (tokenizer.next(begin, end))
     {
-        throw ExceptionTypeError("Type mismatch in matrix stringToData: " + str);
+        if (count == data.numElements())
+        {
+            throw ExceptionTypeError("Type mismatch in vector stringToData: " + str);
+        }
+        parseData(begin, end, data[count++]);
     }
-    for (size_t i = 0; i < data.numRows(); i++)
+    if (count != data.numElements())
     {
-        for (size_t j = 0; j < data.numColumns(); j++)
+        throw ExceptionTypeError("Type mismatch in vector stringToData: " + str);
+    }
+}
+
+template <class T> void stringToData(const string& str, enable_if_mx_matrix_t<T>& data)
+{
+    ValueTokenizer tokenizer(str);
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    size_t count = 0;
+    size_t numColumns = data.numColumns();
+    while (tokenizer.next(begin, end))
+    {
+        if (count == data.numRows() * numColumns)
         {
-            stringToData(tokens[i * data.numRows() + j], data[i][j]);
+            throw ExceptionTypeError("Type mismatch in matrix stringToData: " + str);
         }
+        parseData(begin, end, data[count / numColumns][count % numColumns]);
+        count++;
+    }
+    if (count != data.numRows() * numColumns)
+    {
+        throw ExceptionTypeError("Type mismatch in matrix stringToData: " + str);
     }
 }
 
 template <class T> void stringToData(const string& str, enable_if_std_vector_t<T>& data)
 {
-    for (const string& token : splitString(str, ARRAY_VALID_SEPARATORS))
+    ValueTokenizer tokenizer(str);
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    while (tokenizer.next(begin, end))
     {
         typename T::value_type val;
-        stringToData(token, val);
+        parseData(begin, end, val);
         data.push_back(val);
     }
 }
 
-template <class T> void dataToString(const T& data, string& str)
+// Append the formatted output of snprintf to the given string.
+template <class T> void appendFormatted(string& str, const char* format, int precision, T data)
 {
-    std::stringstream ss;
+    char buffer[64];
+    int length = precision < 0 ?
+        std::snprintf(buffer, sizeof(buffer), format, data) :
+        std::snprintf(buffer, sizeof(buffer), format, precision, data);
+    if (length < 0)
+    {
+        return;
+    }
+    if ((size_t) length < sizeof(buffer))
+    {
+        str.append(buffer, (size_t) length);
+        return;
+    }
+
+    // Fall back to a heap buffer for long outputs, such as large values
+    // in fixed notation.
+    vector<char> large((size_t) length + 1);
+    if (precision < 0)
+        std::snprintf(large.data(), large.size(), format, data);
+    else
+        std::snprintf(large.data(), large.size(), format, precision, data);
+    str.append(large.data(), (size_t) length);
+}
 
-    // Set float format and precision for the stream
+void formatFloat(double data, string& str)
+{
     const Value::FloatFormat fmt = Value::getFloatFormat();
-    ss.setf(std::ios_base::fmtflags(
-            (fmt == Value::FloatFormatFixed ? std::ios_base::fixed :
-            (fmt == Value::FloatFormatScientific ? std::ios_base::scientific : 0))),
-        std::ios_base::floatfield);
-    ss.precision(Value::getFloatPrecision());
+    const char* format = (fmt == Value::FloatFormatFixed) ? "%.*f" :
+                         (fmt == Value::FloatFormatScientific) ? "%.*e" : "%.*g";
+    size_t start = str.size();
+    appendFormatted(str, format, std::max(Value::getFloatPrecision(), 0), data);
+
+    // Value strings always use a period as the decimal separator,
+    // independent of the current C locale.
+    char decimalPoint = *std::localeconv()->decimal_point;
+    if (decimalPoint != '.')
+    {
+        std::replace(str.begin() + (std::ptrdiff_t) start, str.end(), decimalPoint, '.');
+    }
+}
 
+// Append the value string for the given scalar to the given string.
+template <class T> void formatData(const T& data, string& str)
+{
+    std::stringstream ss;
     ss << data;
-    str = ss.str();
+    str += ss.str();
+}
+
+template <> void formatData(const int& data, string& str)
+{
+    appendFormatted(str, "%d", -1, data);
+}
+
+template <> void formatData(const long& data, string& str)
+{
+    appendFormatted(str, "%ld", -1, data);
+}
+
+template <> void formatData(const float& data, string& str)
+{
+    formatFloat(data, str);
+}
+
+template <> void formatData(const double& data, string& str)
+{
+    formatFloat(data, str);
 }
 
-template <> void dataToString(const bool& data, string& str)
+template <> void formatData(const bool& data, string& str)
 {
-    str = data ? VALUE_STRING_TRUE : VALUE_STRING_FALSE;
+    str += data ? VALUE_STRING_TRUE : VALUE_STRING_FALSE;
 }
 
-template <> void dataToString(const string& data, string& str)
+template <> void formatData(const string& data, string& str)
 {
-    str = data;
+    str += data;
+}
+
+template <class T> void dataToString(const T& data, string& str)
+{
+    formatData(data, str);
 }
 
 template <class T> void dataToString(const enable_if_mx_vector_t<T>& data, string& str)
 {
     for (size_t i = 0; i < data.numElements(); i++)
     {
-        string token;
-        dataToString(data[i], token);
-        str += token;
+        formatData(data[i], str);
         if (i + 1 < data.numElements())
         {
             str += ARRAY_PREFERRED_SEPARATOR;
@@ -137,9 +459,7 @@ template <class T> void dataToString(const enable_if_mx_matrix_t<T>& data, strin
     {
         for (size_t j = 0; j < data.numColumns(); j++)
         {
-            string token;
-            dataToString(data[i][j], token);
-            str += token;
+            formatData(data[i][j], str);
             if (i + 1 < data.numRows() ||
                 j + 1 < data.numColumns())
             {
@@ -153,9 +473,7 @@ template <class T> void dataToString(const enable_if_std_vector_t<T>& data, stri
 {
     for (size_t i = 0; i < data.size(); i++)
     {
-        string token;
-        dataToString<typename T::value_type>(data[i], token);
-        str += token;
+        formatData<typename T::value_type>(data[i], str);
         if (i + 1 < data.size())
         {
             str += ARRAY_PREFERRED_SEPARATOR;
@@ -217,6 +535,16 @@ ValuePtr Value::createValueFromStrings(const string& value, const string& type)
     return TypedValue<string>::createFromString(value);
 }
 
+Value::FloatFormat Value::getFloatFormat()
+{
+    return floatFormatOverride.active ? floatFormatOverride.format : _floatFormat;
+}
+
+int Value::getFloatPrecision()
+{
+    return floatFormatOverride.active ? floatFormatOverride.precision : _floatPrecision;
+}
+
 template<class T> bool Value::isA() const
 {
     return dynamic_cast<const TypedValue<T>*>(this) != nullptr;
@@ -233,17 +561,20 @@ template<class T> const T& Value::asA() const
 }
 
 ScopedFloatFormatting::ScopedFloatFormatting(Value::FloatFormat format, int precision) :
-    _format(Value::getFloatFormat()),
-    _precision(Value::getFloatPrecision())
+    _active(floatFormatOverride.active),
+    _format(floatFormatOverride.format),
+    _precision(floatFormatOverride.precision)
 {
-    Value::setFloatFormat(format);
-    Value::setFloatPrecision(precision);
+    floatFormatOverride.active = true;
+    floatFormatOverride.format = format;
+    floatFormatOverride.precision = precision;
 }
 
 ScopedFloatFormatting::~ScopedFloatFormatting()
 {
-    Value::setFloatFormat(_format);
-    Value::setFloatPrecision(_precision);
+    floatFormatOverride.active = _active;
+    floatFormatOverride.format = _format;
+    floatFormatOverride.precision = _precision;
 }
 
 //
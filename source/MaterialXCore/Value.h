@@ -99,28 +99,26 @@ class MX_CORE_API Value
     /// Set float formatting for converting values to strings.
     /// Formats to use are FloatFormatFixed, FloatFormatScientific 
     /// or FloatFormatDefault to set default format.
+    /// The format applies to all threads, except for threads on which a
+    /// ScopedFloatFormatting is active.
     static void setFloatFormat(FloatFormat format)
     {
         _floatFormat = format;
     }
 
     /// Set float precision for converting values to strings.
+    /// The precision applies to all threads, except for threads on which a
+    /// ScopedFloatFormatting is active.
     static void setFloatPrecision(int precision)
     {
         _floatPrecision = precision;
     }
 
-    /// Return the current float format.
-    static FloatFormat getFloatFormat()
-    {
-        return _floatFormat;
-    }
+    /// Return the current float format for the calling thread.
+    static FloatFormat getFloatFormat();
 
-    /// Return the current float precision.
-    static int getFloatPrecision()
-    {
-        return _floatPrecision;
-    }
+    /// Return the current float precision for the calling thread.
+    static int getFloatPrecision();
 
   protected:
     template <class T> friend class ValueRegistry;
@@ -196,6 +194,10 @@ template <class T> class MX_CORE_API TypedValue : public Value
 
 /// @class ScopedFloatFormatting
 /// An RAII class for controlling the float formatting of values.
+///
+/// The formatting applies only to the thread that creates the object, and
+/// overrides the process-wide formatting set through Value::setFloatFormat
+/// and Value::setFloatPrecision until the object is destroyed.
 class MX_CORE_API ScopedFloatFormatting
 {
   public:
@@ -203,6 +205,7 @@ class MX_CORE_API ScopedFloatFormatting
     ~ScopedFloatFormatting();
 
   private:
+    bool _active;
     Value::FloatFormat _format;
     int _precision;
 };
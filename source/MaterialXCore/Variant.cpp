@@ -8,7 +8,7 @@
 namespace MaterialX
 {
 
-const string VariantAssign::VARIANT_SET_ATTRIBUTE = "variantset";
-const string VariantAssign::VARIANT_ATTRIBUTE = "variant";
+const string& VariantAssign::VARIANT_SET_ATTRIBUTE = internString("variantset");
+const string& VariantAssign::VARIANT_ATTRIBUTE = internString("variant");
 
 } // namespace MaterialX
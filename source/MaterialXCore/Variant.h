@@ -158,8 +158,8 @@ class MX_CORE_API VariantAssign : public Element
 
 public:
     static const string CATEGORY;
-    static const string VARIANT_SET_ATTRIBUTE;
-    static const string VARIANT_ATTRIBUTE;
+    static const string& VARIANT_SET_ATTRIBUTE;
+    static const string& VARIANT_ATTRIBUTE;
 };
 
 } // namespace MaterialX
@@ -0,0 +1,389 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXFormat/BinaryIo.h>
+
+#include <MaterialXFormat/Util.h>
+
+#include <MaterialXCore/Util.h>
+
+#include <cstring>
+
+namespace MaterialX
+{
+
+const string MTLX_BINARY_EXTENSION = "mtlxbin";
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = { 'M', 'T', 'L', 'X', 'B', 'I', 'N', '\0' };
+const uint32_t SNAPSHOT_FORMAT_VERSION = 1;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const uint32_t NO_PARENT_INDEX = 0xFFFFFFFF;
+
+// Append binary data to a snapshot buffer.
+class SnapshotWriter
+{
+  public:
+    void writeUInt32(uint32_t value)
+    {
+        _buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeUInt64(uint64_t value)
+    {
+        _buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(const string& str)
+    {
+        writeUInt32((uint32_t) str.size());
+        _buffer.append(str);
+    }
+
+    void writeBytes(const char* data, size_t size)
+    {
+        _buffer.append(data, size);
+    }
+
+    const string& getBuffer() const
+    {
+        return _buffer;
+    }
+
+  private:
+    string _buffer;
+};
+
+// Read binary data from a snapshot buffer, with bounds checking.
+class SnapshotReader
+{
+  public:
+    SnapshotReader(const char* data, size_t size) :
+        _data(data),
+        _size(size),
+        _offset(0)
+    {
+    }
+
+    uint32_t readUInt32()
+    {
+        uint32_t value;
+        std::memcpy(&value, advance(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    uint64_t readUInt64()
+    {
+        uint64_t value;
+        std::memcpy(&value, advance(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    string readString()
+    {
+        uint32_t length = readUInt32();
+        return string(advance(length), length);
+    }
+
+    const char* advance(size_t size)
+    {
+        if (size > _size - _offset)
+        {
+            throw ExceptionParseError("Unexpected end of binary snapshot");
+        }
+        const char* ptr = _data + _offset;
+        _offset += size;
+        return ptr;
+    }
+
+  private:
+    const char* _data;
+    size_t _size;
+    size_t _offset;
+};
+
+// Compute the size and content hash of the given file, returning false if
+// the file cannot be found.
+bool getFileSignature(const FilePath& filePath, uint64_t& size, uint64_t& hash)
+{
+    MappedFile mappedFile;
+    if (mappedFile.open(filePath))
+    {
+        size = mappedFile.getSize();
+        hash = computeContentHash(mappedFile.getData(), mappedFile.getSize());
+        return true;
+    }
+    if (filePath.exists() && !filePath.isDirectory())
+    {
+        // Empty files cannot be mapped.
+        size = 0;
+        hash = computeContentHash(EMPTY_STRING);
+        return true;
+    }
+    return false;
+}
+
+// Read and validate the snapshot header, returning false if the snapshot
+// was written by an incompatible version of the library.
+bool readHeader(SnapshotReader& reader)
+{
+    if (std::memcmp(reader.advance(sizeof(SNAPSHOT_MAGIC)), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+    {
+        return false;
+    }
+    uint32_t formatVersion = reader.readUInt32();
+    uint32_t byteOrder = reader.readUInt32();
+    uint32_t majorVersion = reader.readUInt32();
+    uint32_t minorVersion = reader.readUInt32();
+    uint32_t buildVersion = reader.readUInt32();
+    return formatVersion == SNAPSHOT_FORMAT_VERSION &&
+           byteOrder == SNAPSHOT_BYTE_ORDER &&
+           majorVersion == (uint32_t) std::get<0>(getVersionIntegers()) &&
+           minorVersion == (uint32_t) std::get<1>(getVersionIntegers()) &&
+           buildVersion == (uint32_t) std::get<2>(getVersionIntegers());
+}
+
+} // anonymous namespace
+
+//
+// Writing
+//
+
+void writeToBinaryFile(DocumentPtr doc, const FilePath& filename, const StringSet& sourceFiles)
+{
+    SnapshotWriter writer;
+
+    // Write the header.
+    writer.writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writer.writeUInt32(SNAPSHOT_FORMAT_VERSION);
+    writer.writeUInt32(SNAPSHOT_BYTE_ORDER);
+    writer.writeUInt32((uint32_t) std::get<0>(getVersionIntegers()));
+    writer.writeUInt32((uint32_t) std::get<1>(getVersionIntegers()));
+    writer.writeUInt32((uint32_t) std::get<2>(getVersionIntegers()));
+
+    // Write the source file signatures.
+    writer.writeUInt32((uint32_t) sourceFiles.size());
+    for (const string& sourceFile : sourceFiles)
+    {
+        uint64_t size = 0;
+        uint64_t hash = 0;
+        if (!getFileSignature(sourceFile, size, hash))
+        {
+            throw ExceptionFileMissing("Failed to open snapshot source file: " + sourceFile);
+        }
+        writer.writeString(sourceFile);
+        writer.writeUInt64(size);
+        writer.writeUInt64(hash);
+    }
+
+    // Flatten the element tree in document order, interning its strings.
+    std::unordered_map<string, uint32_t> stringIndices;
+    StringVec strings;
+    auto getStringIndex = [&stringIndices, &strings](const string& str)
+    {
+        auto it = stringIndices.find(str);
+        if (it != stringIndices.end())
+        {
+            return it->second;
+        }
+        uint32_t index = (uint32_t) strings.size();
+        stringIndices[str] = index;
+        strings.push_back(str);
+        return index;
+    };
+
+    std::unordered_map<const Element*, uint32_t> elementIndices;
+    vector<uint32_t> elementTable;
+    uint32_t elementCount = 0;
+    for (ElementPtr elem : doc->traverseTree())
+    {
+        ElementPtr parent = elem->getParent();
+        elementIndices[elem.get()] = elementCount++;
+        elementTable.push_back(parent ? elementIndices[parent.get()] : NO_PARENT_INDEX);
+        elementTable.push_back(getStringIndex(elem->getCategory()));
+        elementTable.push_back(getStringIndex(elem->getName()));
+        elementTable.push_back(getStringIndex(elem->getSourceUri()));
+        StringVec attrNames = elem->getAttributeNames();
+        elementTable.push_back((uint32_t) attrNames.size());
+        for (const string& attrName : attrNames)
+        {
+            elementTable.push_back(getStringIndex(attrName));
+            elementTable.push_back(getStringIndex(elem->getAttribute(attrName)));
+        }
+    }
+
+    // Write the string table.
+    writer.writeUInt32((uint32_t) strings.size());
+    for (const string& str : strings)
+    {
+        writer.writeString(str);
+    }
+
+    // Write the element table.
+    writer.writeUInt32(elementCount);
+    writer.writeUInt32((uint32_t) elementTable.size());
+    writer.writeBytes(reinterpret_cast<const char*>(elementTable.data()), elementTable.size() * sizeof(uint32_t));
+
+    // Replace any existing snapshot in a single step, so that a failed or
+    // concurrent write never leaves a truncated snapshot behind.
+    if (!writeFile(filename, writer.getBuffer()))
+    {
+        throw ExceptionFileMissing("Failed to write file: " + filename.asString());
+    }
+}
+
+//
+// Reading
+//
+
+void readFromBinaryFile(DocumentPtr doc, const FilePath& filename)
+{
+    MappedFile mappedFile;
+    if (!mappedFile.open(filename))
+    {
+        throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+    }
+    SnapshotReader reader(mappedFile.getData(), mappedFile.getSize());
+
+    if (!readHeader(reader))
+    {
+        throw ExceptionParseError("Incompatible binary snapshot: " + filename.asString());
+    }
+
+    // Skip the source file signatures.
+    uint32_t sourceCount = reader.readUInt32();
+    for (uint32_t i = 0; i < sourceCount; i++)
+    {
+        reader.readString();
+        reader.readUInt64();
+        reader.readUInt64();
+    }
+
+    // Read the string table.
+    uint32_t stringCount = reader.readUInt32();
+    StringVec strings;
+    strings.reserve(stringCount);
+    for (uint32_t i = 0; i < stringCount; i++)
+    {
+        strings.push_back(reader.readString());
+    }
+
+    // Read the element table.
+    uint32_t elementCount = reader.readUInt32();
+    uint32_t tableSize = reader.readUInt32();
+    const char* tableData = reader.advance((size_t) tableSize * sizeof(uint32_t));
+    vector<uint32_t> table(tableSize);
+    std::memcpy(table.data(), tableData, (size_t) tableSize * sizeof(uint32_t));
+
+    auto getString = [&strings](uint32_t index) -> const string&
+    {
+        if (index >= strings.size())
+        {
+            throw ExceptionParseError("Invalid string index in binary snapshot");
+        }
+        return strings[index];
+    };
+
+    // Reconstruct the element tree, skipping elements that already exist
+    // in the document along with their descendants.
+    vector<ElementPtr> elements(elementCount);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < elementCount; i++)
+    {
+        if (offset + 5 > table.size())
+        {
+            throw ExceptionParseError("Unexpected end of binary snapshot");
+        }
+        uint32_t parentIndex = table[offset++];
+        const string& category = getString(table[offset++]);
+        const string& name = getString(table[offset++]);
+        const string& sourceUri = getString(table[offset++]);
+        uint32_t attrCount = table[offset++];
+        if (offset + 2 * (size_t) attrCount > table.size())
+        {
+            throw ExceptionParseError("Unexpected end of binary snapshot");
+        }
+
+        ElementPtr elem;
+        if (i == 0)
+        {
+            if (parentIndex != NO_PARENT_INDEX)
+            {
+                throw ExceptionParseError("Invalid root element in binary snapshot");
+            }
+            elem = doc;
+        }
+        else
+        {
+            if (parentIndex >= i)
+            {
+                throw ExceptionParseError("Invalid parent index in binary snapshot");
+            }
+            ElementPtr parent = elements[parentIndex];
+            if (parent && !parent->getChild(name))
+            {
+                elem = parent->addChildOfCategory(category, name);
+            }
+        }
+
+        if (elem)
+        {
+            for (uint32_t j = 0; j < attrCount; j++)
+            {
+                elem->setAttribute(getString(table[offset + 2 * j]), getString(table[offset + 2 * j + 1]));
+            }
+            if (!sourceUri.empty())
+            {
+                elem->setSourceUri(sourceUri);
+            }
+            elements[i] = elem;
+        }
+        offset += 2 * (size_t) attrCount;
+    }
+}
+
+bool isBinarySnapshotCurrent(const FilePath& filename)
+{
+    MappedFile mappedFile;
+    if (!mappedFile.open(filename))
+    {
+        return false;
+    }
+    SnapshotReader reader(mappedFile.getData(), mappedFile.getSize());
+
+    try
+    {
+        if (!readHeader(reader))
+        {
+            return false;
+        }
+
+        uint32_t sourceCount = reader.readUInt32();
+        for (uint32_t i = 0; i < sourceCount; i++)
+        {
+            FilePath sourceFile = reader.readString();
+            uint64_t recordedSize = reader.readUInt64();
+            uint64_t recordedHash = reader.readUInt64();
+
+            uint64_t size = 0;
+            uint64_t hash = 0;
+            if (!getFileSignature(sourceFile, size, hash) ||
+                size != recordedSize ||
+                hash != recordedHash)
+            {
+                return false;
+            }
+        }
+    }
+    catch (ExceptionParseError&)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace MaterialX
@@ -0,0 +1,63 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_BINARYIO_H
+#define MATERIALX_BINARYIO_H
+
+/// @file
+/// Support for binary document snapshots
+
+#include <MaterialXCore/Library.h>
+
+#include <MaterialXCore/Document.h>
+
+#include <MaterialXFormat/Export.h>
+#include <MaterialXFormat/File.h>
+#include <MaterialXFormat/XmlIo.h>
+
+namespace MaterialX
+{
+
+extern MX_FORMAT_API const string MTLX_BINARY_EXTENSION;
+
+/// @name Binary Snapshot Functions
+/// A binary snapshot stores a flattened element table and a table of unique
+/// strings, allowing a previously loaded document, such as the standard data
+/// libraries, to be restored without parsing XML.  A snapshot may record the
+/// source files from which its document was loaded, allowing callers to
+/// detect when it has become stale.
+/// @{
+
+/// Write a Document as a binary snapshot to the given filename.
+/// @param doc The Document to be written.
+/// @param filename The filename to which data is written.
+/// @param sourceFiles An optional set of source files from which the document
+///    was loaded.  The size and content hash of each file are recorded, and
+///    later compared by isBinarySnapshotCurrent.
+/// @throws ExceptionFileMissing if the file cannot be written.
+MX_FORMAT_API void writeToBinaryFile(DocumentPtr doc,
+                                     const FilePath& filename,
+                                     const StringSet& sourceFiles = StringSet());
+
+/// Read a Document from the binary snapshot with the given filename.
+/// As with readFromXmlFile, elements that already exist in the document
+/// at the same scope are not replaced.
+/// @param doc The Document into which data is read.
+/// @param filename The filename from which data is read.
+/// @throws ExceptionParseError if the snapshot is invalid or was written by
+///    an incompatible version of the library.
+/// @throws ExceptionFileMissing if the file cannot be opened.
+MX_FORMAT_API void readFromBinaryFile(DocumentPtr doc, const FilePath& filename);
+
+/// Return true if the given binary snapshot exists, was written by a
+/// compatible version of the library, and all of its recorded source files
+/// are unchanged on the file system.
+MX_FORMAT_API bool isBinarySnapshotCurrent(const FilePath& filename);
+
+/// @}
+
+} // namespace MaterialX
+
+#endif
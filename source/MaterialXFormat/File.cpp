@@ -15,6 +15,8 @@
 #include <direct.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <dirent.h>
 #endif
@@ -153,6 +155,26 @@ bool FilePath::isDirectory() const
 #endif
 }
 
+uint64_t FilePath::getModificationTime() const
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesEx(asString().c_str(), GetFileExInfoStandard, &data))
+        return 0;
+    return ((uint64_t) data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat sb;
+    if (stat(asString().c_str(), &sb))
+        return 0;
+#if defined(__APPLE__)
+    const struct timespec& mtime = sb.st_mtimespec;
+#else
+    const struct timespec& mtime = sb.st_mtim;
+#endif
+    return (uint64_t) mtime.tv_sec * 1000000000ULL + (uint64_t) mtime.tv_nsec;
+#endif
+}
+
 FilePathVec FilePath::getFilesInDirectory(const string& extension) const
 {
     FilePathVec files;
@@ -337,6 +359,86 @@ FilePath FilePath::getModulePath()
 #endif
 }
 
+//
+// MappedFile methods
+//
+
+bool MappedFile::open(const FilePath& filePath)
+{
+    close();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFile(filePath.asString().c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    _data = static_cast<char*>(data);
+    _size = (size_t) fileSize.QuadPart;
+    _handle = mapping;
+#else
+    int file = ::open(filePath.asString().c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+    struct stat sb;
+    if (fstat(file, &sb) != 0 || !S_ISREG(sb.st_mode) || sb.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+    void* data = mmap(nullptr, (size_t) sb.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    _data = static_cast<char*>(data);
+    _size = (size_t) sb.st_size;
+#endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!_data)
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(_data);
+    CloseHandle(_handle);
+#else
+    munmap(_data, _size);
+#endif
+
+    _data = nullptr;
+    _size = 0;
+    _handle = nullptr;
+}
+
 FileSearchPath getEnvironmentPath(const string& sep)
 {
     string searchPathEnv = getEnviron(MATERIALX_SEARCH_PATH_ENV_VAR);
@@ -184,6 +184,11 @@ class MX_FORMAT_API FilePath
     /// Return true if the given path is a directory on the file system.
     bool isDirectory() const;
 
+    /// Return the last modification time of the given path on the file
+    /// system, as an opaque value that changes whenever the file is written,
+    /// or zero if the path does not exist.
+    uint64_t getModificationTime() const;
+
     /// Return a vector of all files in the given directory with the given extension.
     FilePathVec getFilesInDirectory(const string& extension) const;
 
@@ -342,6 +347,56 @@ class MX_FORMAT_API FileSearchPath
     FilePathVec _paths;
 };
 
+/// @class MappedFile
+/// A view of the contents of a file, memory-mapped where supported by the
+/// platform.  Pages are mapped copy-on-write, so the view may be modified
+/// in place, e.g. by an in-situ parser, without affecting the file itself.
+class MX_FORMAT_API MappedFile
+{
+  public:
+    MappedFile() :
+        _data(nullptr),
+        _size(0),
+        _handle(nullptr)
+    {
+    }
+    ~MappedFile()
+    {
+        close();
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Map the contents of the given file, returning true on success.
+    bool open(const FilePath& filePath);
+
+    /// Release the current mapping, if any.
+    void close();
+
+    /// Return true if a file is currently mapped.
+    bool isOpen() const
+    {
+        return _data != nullptr;
+    }
+
+    /// Return a pointer to the mapped contents.
+    char* getData() const
+    {
+        return _data;
+    }
+
+    /// Return the size of the mapped contents in bytes.
+    size_t getSize() const
+    {
+        return _size;
+    }
+
+  private:
+    char* _data;
+    size_t _size;
+    void* _handle;
+};
+
 /// Return a FileSearchPath object from search path environment variable.
 MX_FORMAT_API FileSearchPath getEnvironmentPath(const string& sep = PATH_LIST_SEPARATOR);
 
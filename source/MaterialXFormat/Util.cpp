@@ -5,15 +5,89 @@
 
 #include <MaterialXFormat/Util.h>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <random>
 #include <sstream>
+#include <thread>
 
 namespace MaterialX
 {
 
+namespace {
+
+// Return a suffix for temporary files that is unique across threads and
+// processes writing to the same directory.
+string getUniqueTempSuffix()
+{
+#if defined(_WIN32)
+    unsigned long processId = GetCurrentProcessId();
+#else
+    long processId = (long) getpid();
+#endif
+    static std::random_device device;
+    static std::mutex deviceMutex;
+    uint64_t random;
+    {
+        std::lock_guard<std::mutex> lock(deviceMutex);
+        random = ((uint64_t) device() << 32) ^ (uint64_t) device();
+    }
+
+    std::ostringstream suffix;
+    suffix << "." << processId << "." << std::this_thread::get_id() << "." << std::hex << random << ".tmp";
+    return suffix.str();
+}
+
+// Move a file over the given destination, replacing any existing file in a
+// single step, so that the destination never appears to be missing.
+bool replaceFile(const string& source, const string& destination)
+{
+#if defined(_WIN32)
+    return MoveFileExA(source.c_str(), destination.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(source.c_str(), destination.c_str()) == 0;
+#endif
+}
+
+} // anonymous namespace
+
 string readFile(const FilePath& filePath)
 {
+    // Copy directly from a mapped view of the file where possible.
+    MappedFile mappedFile;
+    if (mappedFile.open(filePath))
+    {
+        string contents(mappedFile.getData(), mappedFile.getSize());
+#if defined(_WIN32)
+        // Match the newline translation of text-mode streams, which converts
+        // each "\r\n" pair to "\n" and leaves isolated carriage returns intact.
+        size_t write = 0;
+        for (size_t read = 0; read < contents.size(); read++)
+        {
+            if (contents[read] == '\r' && read + 1 < contents.size() && contents[read + 1] == '\n')
+            {
+                continue;
+            }
+            contents[write++] = contents[read];
+        }
+        contents.resize(write);
+#endif
+        return contents;
+    }
+
     std::ifstream file(filePath.asString(), std::ios::in);
     if (file)
     {
@@ -28,6 +102,31 @@ string readFile(const FilePath& filePath)
     return EMPTY_STRING;
 }
 
+bool writeFile(const FilePath& filePath, const string& contents)
+{
+    const string tempPath = filePath.asString() + getUniqueTempSuffix();
+    {
+        std::ofstream stream(tempPath, std::ios::out | std::ios::binary);
+        if (!stream)
+        {
+            return false;
+        }
+        stream.write(contents.data(), (std::streamsize) contents.size());
+        stream.close();
+        if (!stream)
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (!replaceFile(tempPath, filePath.asString()))
+    {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
 void getSubdirectories(const FilePathVec& rootDirectories, const FileSearchPath& searchPath, FilePathVec& subDirectories)
 {
     for (const FilePath& root : rootDirectories)
@@ -77,6 +176,10 @@ void loadDocuments(const FilePath& rootPath, const FileSearchPath& searchPath, c
 void loadLibrary(const FilePath& file, DocumentPtr doc, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
 {
     DocumentPtr libDoc = createDocument();
+    if (doc->hasElementArena())
+    {
+        libDoc->enableElementArena();
+    }
     readFromXmlFile(libDoc, file, searchPath, readOptions);
     doc->importLibrary(libDoc);
 }
@@ -85,58 +188,140 @@ StringSet loadLibraries(const FilePathVec& libraryFolders,
                         const FileSearchPath& searchPath,
                         DocumentPtr doc,
                         const StringSet& excludeFiles,
-                        const XmlReadOptions* readOptions)
+                        const XmlReadOptions* readOptions,
+                        unsigned int threadCount,
+                        LibraryFileTimingVec* timings)
 {
     // Append environment path to the specified search path.
     FileSearchPath librarySearchPath = searchPath;
     librarySearchPath.append(getEnvironmentPath());
 
-    StringSet loadedLibraries;
+    FilePathVec libraryPaths;
     if (libraryFolders.empty())
     {
         // No libraries specified so scan in all search paths
         for (const FilePath& libraryPath : librarySearchPath)
         {
-            for (const FilePath& path : libraryPath.getSubDirectories())
+            FilePathVec subDirectories = libraryPath.getSubDirectories();
+            libraryPaths.insert(libraryPaths.end(), subDirectories.begin(), subDirectories.end());
+        }
+    }
+    else
+    {
+        // Look for specific library folders in the search paths
+        for (const FilePath& libraryName : libraryFolders)
+        {
+            FilePathVec subDirectories = librarySearchPath.find(libraryName).getSubDirectories();
+            libraryPaths.insert(libraryPaths.end(), subDirectories.begin(), subDirectories.end());
+        }
+    }
+
+    // Gather library files in the order in which they are merged.
+    StringSet loadedLibraries;
+    FilePathVec files;
+    for (const FilePath& path : libraryPaths)
+    {
+        for (const FilePath& filename : path.getFilesInDirectory(MTLX_EXTENSION))
+        {
+            if (!excludeFiles.count(filename))
             {
-                for (const FilePath& filename : path.getFilesInDirectory(MTLX_EXTENSION))
+                const FilePath& file = path / filename;
+                if (loadedLibraries.count(file) == 0)
                 {
-                    if (!excludeFiles.count(filename))
-                    {
-                        const FilePath& file = path / filename;
-                        if (loadedLibraries.count(file) == 0)
-                        {
-                            loadLibrary(file, doc, searchPath, readOptions);
-                            loadedLibraries.insert(file.asString());
-                        }
-                    }
+                    files.push_back(file);
+                    loadedLibraries.insert(file.asString());
                 }
             }
         }
     }
+
+    vector<DocumentPtr> libDocs(files.size());
+    vector<std::exception_ptr> errors(files.size());
+    LibraryFileTimingVec fileTimings(files.size());
+
+    // Parse a single library file into its own document.
+    auto parseFile = [&](size_t index)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        try
+        {
+            DocumentPtr libDoc = createDocument();
+            if (doc->hasElementArena())
+            {
+                libDoc->enableElementArena();
+            }
+            readFromXmlFile(libDoc, files[index], searchPath, readOptions);
+            libDocs[index] = libDoc;
+        }
+        catch (...)
+        {
+            errors[index] = std::current_exception();
+        }
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+        fileTimings[index].file = files[index];
+        fileTimings[index].parseTime = duration.count();
+    };
+
+    // Merge a parsed library document into the destination document.
+    auto mergeFile = [&](size_t index)
+    {
+        if (errors[index])
+        {
+            std::rethrow_exception(errors[index]);
+        }
+        auto startTime = std::chrono::steady_clock::now();
+        doc->importLibrary(libDocs[index]);
+        libDocs[index] = nullptr;
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+        fileTimings[index].mergeTime = duration.count();
+        if (timings)
+        {
+            timings->push_back(fileTimings[index]);
+        }
+    };
+
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadCount = (unsigned int) std::min((size_t) threadCount, files.size());
+
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            parseFile(i);
+            mergeFile(i);
+        }
+    }
     else
     {
-        // Look for specific library folders in the search paths
-        for (const FilePath& libraryName : libraryFolders)
+        // Parse files concurrently, with each worker claiming the next
+        // unparsed file in order.
+        std::atomic<size_t> nextIndex(0);
+        vector<std::thread> workers;
+        for (unsigned int t = 0; t < threadCount; t++)
         {
-            FilePath libraryPath = librarySearchPath.find(libraryName);
-            for (const FilePath& path : libraryPath.getSubDirectories())
+            workers.emplace_back([&]()
             {
-                for (const FilePath& filename : path.getFilesInDirectory(MTLX_EXTENSION))
+                for (size_t i = nextIndex++; i < files.size(); i = nextIndex++)
                 {
-                    if (!excludeFiles.count(filename))
-                    {
-                        const FilePath& file = path / filename;
-                        if (loadedLibraries.count(file) == 0)
-                        {
-                            loadLibrary(file, doc, searchPath, readOptions);
-                            loadedLibraries.insert(file.asString());
-                        }
-                    }
+                    parseFile(i);
                 }
-            }
+            });
+        }
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        // Merge documents in file order, matching the serial result.
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            mergeFile(i);
         }
     }
+
     return loadedLibraries;
 }
 
@@ -20,10 +20,45 @@
 namespace MaterialX
 {
 
+class LibraryFileTiming;
+
+/// A vector of library file timings
+using LibraryFileTimingVec = vector<LibraryFileTiming>;
+
+/// @class LibraryFileTiming
+/// Timing statistics for a single file read by loadLibraries.
+class MX_FORMAT_API LibraryFileTiming
+{
+  public:
+    LibraryFileTiming() :
+        parseTime(0.0),
+        mergeTime(0.0)
+    {
+    }
+    ~LibraryFileTiming() { }
+
+    /// The library file that was read.
+    FilePath file;
+
+    /// The time in seconds spent parsing the file into its own document.
+    double parseTime;
+
+    /// The time in seconds spent merging the parsed document into the
+    /// destination document.
+    double mergeTime;
+};
+
 /// Read the given file and return a string containing its contents; if the read is not
 /// successful, then the empty string is returned.
 MX_FORMAT_API string readFile(const FilePath& file);
 
+/// Write the given contents to a file, replacing any existing file in a single
+/// step.  The contents are written to a uniquely named temporary file, which is
+/// then moved over the destination, so that concurrent readers observe either
+/// the previous or the new file, and never a partially written one.
+/// @return True if the file was written successfully.
+MX_FORMAT_API bool writeFile(const FilePath& file, const string& contents);
+
 /// Get all subdirectories for a given set of directories and search paths
 MX_FORMAT_API void getSubdirectories(const FilePathVec& rootDirectories, const FileSearchPath& searchPath, FilePathVec& subDirectories);
 
@@ -45,11 +80,27 @@ MX_FORMAT_API void loadLibrary(const FilePath& file,
 
 /// Load all MaterialX files within the given library folders into a document,
 /// using the given search path to locate the folders on the file system.
+/// @param libraryFolders The library folders to load, or an empty vector to
+///    load all folders within the search path.
+/// @param searchPath The search path used to locate the library folders.
+/// @param doc The document into which libraries are merged.
+/// @param excludeFiles An optional set of filenames to be skipped.
+/// @param readOptions An optional pointer to an XmlReadOptions object.
+/// @param threadCount The number of threads used to parse library files.
+///    Files are parsed concurrently into independent documents, and then
+///    merged in the same order as a serial load, so the resulting document
+///    does not depend on the thread count.  A value of zero selects the
+///    hardware concurrency of the system.  Defaults to one.
+/// @param timings An optional vector, to which the parse and merge times
+///    of each library file are appended in merge order.
+/// @return The set of library files that were loaded.
 MX_FORMAT_API StringSet loadLibraries(const FilePathVec& libraryFolders,
                         const FileSearchPath& searchPath,
                         DocumentPtr doc,
                         const StringSet& excludeFiles = StringSet(),
-                        const XmlReadOptions* readOptions = nullptr);
+                        const XmlReadOptions* readOptions = nullptr,
+                        unsigned int threadCount = 1,
+                        LibraryFileTimingVec* timings = nullptr);
 
 /// Flatten all filenames in the given document, applying string resolvers at the
 /// scope of each element and removing all fileprefix attributes.
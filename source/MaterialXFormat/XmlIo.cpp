@@ -9,6 +9,8 @@
 
 #include <MaterialXCore/Types.h>
 
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <sstream>
@@ -137,63 +139,72 @@ void elementToXml(ConstElementPtr elem, xml_node& xmlNode, const XmlWriteOptions
     }
 }
 
+void readXInclude(DocumentPtr doc,
+                  const string& filename,
+                  const FileSearchPath& searchPath,
+                  FileSearchPath& includeSearchPath,
+                  const XmlReadOptions* readOptions)
+{
+    XmlReadFunction readXIncludeFunction = readOptions ? readOptions->readXIncludeFunction : readFromXmlFile;
+    if (!readXIncludeFunction)
+    {
+        return;
+    }
+
+    // Check for XInclude cycles.
+    if (readOptions)
+    {
+        const StringVec& parents = readOptions->parentXIncludes;
+        if (std::find(parents.begin(), parents.end(), filename) != parents.end())
+        {
+            throw ExceptionParseError("XInclude cycle detected.");
+        }
+    }
+
+    // Read the included file into a library document.
+    DocumentPtr library = createDocument();
+    XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
+    xiReadOptions.parentXIncludes.push_back(filename);
+
+    // Prepend the directory of the parent to accommodate
+    // includes relative to the parent file location.
+    if (includeSearchPath.isEmpty())
+    {
+        string parentUri = doc->getSourceUri();
+        if (!parentUri.empty())
+        {
+            FilePath filePath = searchPath.find(parentUri);
+            if (!filePath.isEmpty())
+            {
+                // Remove the file name from the path as we want the path to the containing folder.
+                includeSearchPath = searchPath;
+                includeSearchPath.prepend(filePath.getParentPath());
+            }
+        }
+        // Set default search path if no parent path found
+        if (includeSearchPath.isEmpty())
+        {
+            includeSearchPath = searchPath;
+        }
+    }
+    readXIncludeFunction(library, filename, includeSearchPath, &xiReadOptions);
+
+    // Import the library document.
+    doc->importLibrary(library);
+}
+
 void processXIncludes(DocumentPtr doc, xml_node& xmlNode, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
 {
     // Search path for includes. Set empty and then evaluated once in the iteration through xml includes.
     FileSearchPath includeSearchPath;
 
-    XmlReadFunction readXIncludeFunction = readOptions ? readOptions->readXIncludeFunction : readFromXmlFile;
     xml_node xmlChild = xmlNode.first_child();
     while (xmlChild)
     {
         if (xmlChild.name() == XINCLUDE_TAG)
         {
             // Read XInclude references if requested.
-            if (readXIncludeFunction)
-            {
-                string filename = xmlChild.attribute("href").value();
-
-                // Check for XInclude cycles.
-                if (readOptions)
-                {
-                    const StringVec& parents = readOptions->parentXIncludes;
-                    if (std::find(parents.begin(), parents.end(), filename) != parents.end())
-                    {
-                        throw ExceptionParseError("XInclude cycle detected.");
-                    }
-                }
-
-                // Read the included file into a library document.
-                DocumentPtr library = createDocument();
-                XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
-                xiReadOptions.parentXIncludes.push_back(filename);
-
-                // Prepend the directory of the parent to accommodate
-                // includes relative to the parent file location.
-                if (includeSearchPath.isEmpty())
-                {
-                    string parentUri = doc->getSourceUri();
-                    if (!parentUri.empty())
-                    {
-                        FilePath filePath = searchPath.find(parentUri);
-                        if (!filePath.isEmpty())
-                        {
-                            // Remove the file name from the path as we want the path to the containing folder.
-                            includeSearchPath = searchPath;
-                            includeSearchPath.prepend(filePath.getParentPath());
-                        }
-                    }
-                    // Set default search path if no parent path found
-                    if (includeSearchPath.isEmpty())
-                    {
-                        includeSearchPath = searchPath;
-                    }
-                }
-                readXIncludeFunction(library, filename, includeSearchPath, &xiReadOptions);
-
-                // Import the library document.
-                doc->importLibrary(library);
-            }
+            readXInclude(doc, xmlChild.attribute("href").value(), searchPath, includeSearchPath, readOptions);
 
             // Remove include directive.
             xml_node includeNode = xmlChild;
@@ -248,6 +259,513 @@ void validateParseResult(xml_parse_result& result, const FilePath& filename = Fi
     throw ExceptionParseError(message);
 }
 
+// A streaming XML reader, which builds elements directly from a character
+// source without constructing an intermediate DOM.  Top-level elements
+// rejected by the element filter are scanned but never allocated, so memory
+// use is bounded by the depth of the document rather than its size.
+class XmlStreamReader
+{
+  public:
+    XmlStreamReader(std::istream& stream, const FilePath& filename = FilePath()) :
+        _stream(&stream),
+        _chunk(CHUNK_SIZE),
+        _cur(nullptr),
+        _end(nullptr),
+        _offset(0),
+        _filename(filename)
+    {
+    }
+
+    XmlStreamReader(const char* buffer) :
+        _stream(nullptr),
+        _cur(buffer),
+        _end(buffer + std::strlen(buffer)),
+        _offset(0)
+    {
+    }
+
+    void read(DocumentPtr doc, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
+    {
+        XmlElementFilter elementFilter = readOptions ? readOptions->elementFilter : nullptr;
+        bool readComments = readOptions && readOptions->readComments;
+        FileSearchPath includeSearchPath;
+
+        // The categories of open tags, and their corresponding elements,
+        // which are null within skipped subtrees.
+        StringVec tagStack;
+        vector<ElementPtr> elementStack;
+        bool rootFound = false;
+
+        string tag;
+        vector<std::pair<string, string>> attrs;
+        while (skipText())
+        {
+            get();
+            int c = peek();
+            if (c == '?')
+            {
+                skipPast("?>");
+            }
+            else if (c == '!')
+            {
+                get();
+                if (match("--"))
+                {
+                    string comment = readComment();
+                    ElementPtr parent = elementStack.empty() ? nullptr : elementStack.back();
+                    if (readComments && parent &&
+                        (parent != doc || !elementFilter || elementFilter(CommentElement::CATEGORY, EMPTY_STRING)))
+                    {
+                        ElementPtr child = parent->addChildOfCategory(CommentElement::CATEGORY, parent->createValidChildName("1"));
+                        child->setDocString(comment);
+                    }
+                }
+                else if (match("[CDATA["))
+                {
+                    skipPast("]]>");
+                }
+                else
+                {
+                    skipDeclaration();
+                }
+            }
+            else if (c == '/')
+            {
+                get();
+                readName(tag);
+                skipWhitespace();
+                if (get() != '>' || tagStack.empty() || tagStack.back() != tag)
+                {
+                    error("Start-end tags mismatch");
+                }
+                tagStack.pop_back();
+                elementStack.pop_back();
+            }
+            else
+            {
+                bool selfClosing = readStartTag(tag, attrs);
+                ElementPtr elem;
+                if (tagStack.empty())
+                {
+                    // Only the first MaterialX root is read.
+                    if (!rootFound && tag == Document::CATEGORY)
+                    {
+                        elem = doc;
+                        setAttributes(elem, attrs);
+                    }
+                    rootFound = true;
+                }
+                else if (elementStack.back())
+                {
+                    ElementPtr parent = elementStack.back();
+                    if (parent == doc && tag == XINCLUDE_TAG)
+                    {
+                        readXInclude(doc, getAttribute(attrs, "href"), searchPath, includeSearchPath, readOptions);
+                    }
+                    else
+                    {
+                        const string& name = getAttribute(attrs, Element::NAME_ATTRIBUTE);
+                        bool accepted = parent != doc || !elementFilter || elementFilter(tag, name);
+                        if (accepted && !parent->getChild(name))
+                        {
+                            elem = parent->addChildOfCategory(tag, name);
+                            setAttributes(elem, attrs);
+                        }
+                    }
+                }
+                if (!selfClosing)
+                {
+                    tagStack.push_back(tag);
+                    elementStack.push_back(elem);
+                }
+            }
+        }
+
+        if (!tagStack.empty())
+        {
+            error("Start-end tags mismatch");
+        }
+        if (!rootFound)
+        {
+            error("No document element found");
+        }
+    }
+
+  private:
+    int peek()
+    {
+        if (_cur == _end && !fill())
+        {
+            return EOF;
+        }
+        return (unsigned char) *_cur;
+    }
+
+    int get()
+    {
+        int c = peek();
+        if (c != EOF)
+        {
+            _cur++;
+            _offset++;
+        }
+        return c;
+    }
+
+    bool fill()
+    {
+        if (!_stream)
+        {
+            return false;
+        }
+        _stream->read(_chunk.data(), (std::streamsize) _chunk.size());
+        size_t count = (size_t) _stream->gcount();
+        if (!count)
+        {
+            return false;
+        }
+        _cur = _chunk.data();
+        _end = _cur + count;
+        return true;
+    }
+
+    static bool isWhitespace(int c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    void skipWhitespace()
+    {
+        while (isWhitespace(peek()))
+        {
+            get();
+        }
+    }
+
+    // Skip character data up to the next tag, returning false at the end
+    // of the input.
+    bool skipText()
+    {
+        int c = peek();
+        while (c != EOF && c != '<')
+        {
+            get();
+            c = peek();
+        }
+        return c != EOF;
+    }
+
+    // Consume the given literal if it is next in the input.  Since only
+    // one character of lookahead is available, a partial match is an error.
+    bool match(const char* literal)
+    {
+        if (peek() != (unsigned char) literal[0])
+        {
+            return false;
+        }
+        for (const char* ch = literal; *ch; ch++)
+        {
+            if (get() != (unsigned char) *ch)
+            {
+                error("Unrecognized tag");
+            }
+        }
+        return true;
+    }
+
+    void skipPast(const char* terminator)
+    {
+        size_t length = std::strlen(terminator);
+        size_t matched = 0;
+        while (matched < length)
+        {
+            int c = get();
+            if (c == EOF)
+            {
+                error("Unexpected end of data");
+            }
+            if (c == (unsigned char) terminator[matched])
+            {
+                matched++;
+            }
+            else
+            {
+                matched = (c == (unsigned char) terminator[0]) ? 1 : 0;
+            }
+        }
+    }
+
+    // Skip a document type declaration, including any internal subset.
+    void skipDeclaration()
+    {
+        int depth = 0;
+        while (true)
+        {
+            int c = get();
+            if (c == EOF)
+            {
+                error("Unexpected end of data");
+            }
+            else if (c == '[')
+            {
+                depth++;
+            }
+            else if (c == ']')
+            {
+                depth--;
+            }
+            else if (c == '>' && depth <= 0)
+            {
+                return;
+            }
+        }
+    }
+
+    string readComment()
+    {
+        string comment;
+        while (true)
+        {
+            int c = get();
+            if (c == EOF)
+            {
+                error("Unexpected end of data");
+            }
+            if (c == '\r')
+            {
+                // Normalize line endings.
+                if (peek() == '\n')
+                {
+                    get();
+                }
+                c = '\n';
+            }
+            comment.push_back((char) c);
+            size_t size = comment.size();
+            if (size >= 3 && comment.compare(size - 3, 3, "-->") == 0)
+            {
+                comment.resize(size - 3);
+                return comment;
+            }
+        }
+    }
+
+    void readName(string& name)
+    {
+        name.clear();
+        int c = peek();
+        while (c != EOF && !isWhitespace(c) && c != '/' && c != '>' && c != '=')
+        {
+            name.push_back((char) get());
+            c = peek();
+        }
+        if (name.empty())
+        {
+            error("Error parsing start element tag");
+        }
+    }
+
+    // Read the name and attributes of a start tag, returning true if the
+    // tag is self-closing.
+    bool readStartTag(string& tag, vector<std::pair<string, string>>& attrs)
+    {
+        readName(tag);
+        attrs.clear();
+        while (true)
+        {
+            skipWhitespace();
+            int c = peek();
+            if (c == '>')
+            {
+                get();
+                return false;
+            }
+            if (c == '/')
+            {
+                get();
+                if (get() != '>')
+                {
+                    error("Error parsing start element tag");
+                }
+                return true;
+            }
+            if (c == EOF)
+            {
+                error("Unexpected end of data");
+            }
+
+            attrs.emplace_back();
+            readName(attrs.back().first);
+            skipWhitespace();
+            if (get() != '=')
+            {
+                error("Error parsing attribute");
+            }
+            skipWhitespace();
+            readAttributeValue(attrs.back().second);
+        }
+    }
+
+    void readAttributeValue(string& value)
+    {
+        int quote = get();
+        if (quote != '"' && quote != '\'')
+        {
+            error("Error parsing attribute");
+        }
+        value.clear();
+        while (true)
+        {
+            int c = get();
+            if (c == EOF)
+            {
+                error("Unexpected end of data");
+            }
+            if (c == quote)
+            {
+                return;
+            }
+            if (c == '&')
+            {
+                readEntity(value);
+            }
+            else if (isWhitespace(c))
+            {
+                // Normalize attribute whitespace, treating CRLF as a single character.
+                if (c == '\r' && peek() == '\n')
+                {
+                    get();
+                }
+                value.push_back(' ');
+            }
+            else
+            {
+                value.push_back((char) c);
+            }
+        }
+    }
+
+    // Decode a character or entity reference, leaving unrecognized
+    // references unchanged.
+    void readEntity(string& value)
+    {
+        string entity;
+        int c = peek();
+        while (c != EOF && c != ';' && !isWhitespace(c) && c != '"' && c != '\'' && c != '&' && entity.size() < 16)
+        {
+            entity.push_back((char) get());
+            c = peek();
+        }
+        if (c != ';')
+        {
+            value += "&" + entity;
+            return;
+        }
+        get();
+
+        if (entity == "lt")
+        {
+            value.push_back('<');
+        }
+        else if (entity == "gt")
+        {
+            value.push_back('>');
+        }
+        else if (entity == "amp")
+        {
+            value.push_back('&');
+        }
+        else if (entity == "quot")
+        {
+            value.push_back('"');
+        }
+        else if (entity == "apos")
+        {
+            value.push_back('\'');
+        }
+        else if (entity.size() > 1 && entity[0] == '#')
+        {
+            bool hex = entity[1] == 'x';
+            unsigned long code = std::strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10);
+            appendUtf8(value, code);
+        }
+        else
+        {
+            value += "&" + entity + ";";
+        }
+    }
+
+    static void appendUtf8(string& value, unsigned long code)
+    {
+        if (code < 0x80)
+        {
+            value.push_back((char) code);
+        }
+        else if (code < 0x800)
+        {
+            value.push_back((char) (0xC0 | (code >> 6)));
+            value.push_back((char) (0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            value.push_back((char) (0xE0 | (code >> 12)));
+            value.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+            value.push_back((char) (0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            value.push_back((char) (0xF0 | (code >> 18)));
+            value.push_back((char) (0x80 | ((code >> 12) & 0x3F)));
+            value.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+            value.push_back((char) (0x80 | (code & 0x3F)));
+        }
+    }
+
+    static const string& getAttribute(const vector<std::pair<string, string>>& attrs, const string& name)
+    {
+        for (const auto& attr : attrs)
+        {
+            if (attr.first == name)
+            {
+                return attr.second;
+            }
+        }
+        return EMPTY_STRING;
+    }
+
+    static void setAttributes(ElementPtr elem, const vector<std::pair<string, string>>& attrs)
+    {
+        for (const auto& attr : attrs)
+        {
+            if (attr.first != Element::NAME_ATTRIBUTE)
+            {
+                elem->setAttribute(attr.first, attr.second);
+            }
+        }
+    }
+
+    [[noreturn]] void error(const string& desc)
+    {
+        string message = "XML parse error";
+        if (!_filename.isEmpty())
+        {
+            message += " in " + _filename.asString();
+        }
+        message += " (" + desc + " at character " + std::to_string(_offset) + ")";
+        throw ExceptionParseError(message);
+    }
+
+  private:
+    static const size_t CHUNK_SIZE = 65536;
+
+    std::istream* _stream;
+    vector<char> _chunk;
+    const char* _cur;
+    const char* _end;
+    size_t _offset;
+    FilePath _filename;
+};
+
 unsigned int getParseOptions(const XmlReadOptions* readOptions)
 {
     unsigned int parseOptions = parse_default;
@@ -285,6 +803,14 @@ XmlWriteOptions::XmlWriteOptions() :
 
 void readFromXmlBuffer(DocumentPtr doc, const char* buffer, const XmlReadOptions* readOptions)
 {
+    if (readOptions && readOptions->elementFilter)
+    {
+        XmlStreamReader reader(buffer);
+        reader.read(doc, EMPTY_STRING, readOptions);
+        doc->upgradeVersion();
+        return;
+    }
+
     xml_document xmlDoc;
     xml_parse_result result = xmlDoc.load_string(buffer, getParseOptions(readOptions));
     validateParseResult(result);
@@ -294,6 +820,14 @@ void readFromXmlBuffer(DocumentPtr doc, const char* buffer, const XmlReadOptions
 
 void readFromXmlStream(DocumentPtr doc, std::istream& stream, const XmlReadOptions* readOptions)
 {
+    if (readOptions && readOptions->elementFilter)
+    {
+        XmlStreamReader reader(stream);
+        reader.read(doc, EMPTY_STRING, readOptions);
+        doc->upgradeVersion();
+        return;
+    }
+
     xml_document xmlDoc;
     xml_parse_result result = xmlDoc.load(stream, getParseOptions(readOptions));
     validateParseResult(result);
@@ -303,24 +837,55 @@ void readFromXmlStream(DocumentPtr doc, std::istream& stream, const XmlReadOptio
 
 void readFromXmlFile(DocumentPtr doc, FilePath filename, FileSearchPath searchPath, const XmlReadOptions* readOptions)
 {
-    xml_document xmlDoc;
-
     searchPath.append(getEnvironmentPath());
     filename = searchPath.find(filename);
 
-    xml_parse_result result = xmlDoc.load_file(filename.asString().c_str(), getParseOptions(readOptions));
-    validateParseResult(result, filename);
-
     // This must be done before parsing the XML as the source URI
     // is used for searching for include files.
-    if (readOptions && !readOptions->parentXIncludes.empty())
+    auto setSourceUri = [&doc, &filename, readOptions]()
+    {
+        if (readOptions && !readOptions->parentXIncludes.empty())
+        {
+            doc->setSourceUri(readOptions->parentXIncludes[0]);
+        }
+        else
+        {
+            doc->setSourceUri(filename);
+        }
+    };
+
+    // Stream filtered reads from the file in fixed-size chunks.
+    if (readOptions && readOptions->elementFilter)
     {
-        doc->setSourceUri(readOptions->parentXIncludes[0]);
+        std::ifstream stream(filename.asString(), std::ios::in | std::ios::binary);
+        if (!stream)
+        {
+            throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        }
+        setSourceUri();
+        XmlStreamReader reader(stream, filename);
+        reader.read(doc, searchPath, readOptions);
+        doc->upgradeVersion();
+        return;
+    }
+
+    // Parse in place from a mapped view of the file where possible, falling
+    // back to a buffered read otherwise.  The mapping must outlive the XML
+    // document, whose strings point into it.
+    MappedFile mappedFile;
+    xml_document xmlDoc;
+    xml_parse_result result;
+    if (mappedFile.open(filename))
+    {
+        result = xmlDoc.load_buffer_inplace(mappedFile.getData(), mappedFile.getSize(), getParseOptions(readOptions));
     }
     else
     {
-        doc->setSourceUri(filename);
+        result = xmlDoc.load_file(filename.asString().c_str(), getParseOptions(readOptions));
     }
+    validateParseResult(result, filename);
+
+    setSourceUri();
     documentFromXml(doc, xmlDoc, searchPath, readOptions);
 }
 
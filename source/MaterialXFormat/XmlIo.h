@@ -27,6 +27,10 @@ extern MX_FORMAT_API const string MTLX_EXTENSION;
 /// optional search path and read options.
 using XmlReadFunction = std::function<void(DocumentPtr, const FilePath&, const FileSearchPath&, const XmlReadOptions*)>;
 
+/// A function that determines whether a top-level element with the given
+/// category and name should be read into a Document.
+using XmlElementFilter = std::function<bool(const string& category, const string& name)>;
+
 /// @class XmlReadOptions
 /// A set of options for controlling the behavior of XML read functions.
 class MX_FORMAT_API XmlReadOptions
@@ -46,6 +50,14 @@ class MX_FORMAT_API XmlReadOptions
     /// The vector of parent XIncludes at the scope of the current document.
     /// Defaults to an empty vector.
     StringVec parentXIncludes;
+
+    /// If provided, documents will be read with a streaming parser, and this
+    /// function will be used to exclude top-level elements (those returning
+    /// false) from the read operation.  Excluded subtrees are scanned but never
+    /// allocated, so memory use is bounded by the depth of the document rather
+    /// than its size.  The filter also applies to the contents of XIncludes,
+    /// which are read at their position in the document.  Defaults to nullptr.
+    XmlElementFilter elementFilter;
 };
 
 /// @class XmlWriteOptions
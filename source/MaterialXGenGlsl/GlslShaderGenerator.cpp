@@ -45,6 +45,15 @@ namespace MaterialX
 const string GlslShaderGenerator::TARGET = "genglsl";
 const string GlslShaderGenerator::VERSION = "400";
 
+namespace
+{
+
+const string PHASE_GENERATE = "GlslShaderGenerator::generate";
+const string PHASE_EMIT_VERTEX_STAGE = "GlslShaderGenerator::emitVertexStage";
+const string PHASE_EMIT_PIXEL_STAGE = "GlslShaderGenerator::emitPixelStage";
+
+} // anonymous namespace
+
 //
 // GlslShaderGenerator methods
 //
@@ -267,6 +276,9 @@ GlslShaderGenerator::GlslShaderGenerator() :
 
 ShaderPtr GlslShaderGenerator::generate(const string& name, ElementPtr element, GenContext& context) const
 {
+    GenProfiler* profiler = context.getProfiler().get();
+    ScopedGenTimer timer(profiler, PHASE_GENERATE);
+
     ShaderPtr shader = createShader(name, element, context);
 
     // Turn on fixed float formatting to make sure float values are
@@ -291,11 +303,19 @@ ShaderPtr GlslShaderGenerator::generate(const string& name, ElementPtr element,
     emitPixelStage(shader->getGraph(), context, ps);
     replaceTokens(_tokenSubstitutions, ps);
 
+    if (profiler)
+    {
+        profiler->addStage(vs);
+        profiler->addStage(ps);
+    }
+
     return shader;
 }
 
 void GlslShaderGenerator::emitVertexStage(const ShaderGraph& graph, GenContext& context, ShaderStage& stage) const
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_EMIT_VERTEX_STAGE);
+
     HwResourceBindingContextPtr resourceBindingCtx = context.getUserData<HwResourceBindingContext>(HW::USER_DATA_BINDING_CONTEXT);
 
     // Add directives
@@ -379,6 +399,10 @@ void GlslShaderGenerator::emitSpecularEnvironment(GenContext& context, ShaderSta
     {
         emitInclude("pbrlib/" + GlslShaderGenerator::TARGET + "/lib/mx_environment_prefilter.glsl", context, stage);
     }
+    else if (specularMethod == SPECULAR_ENVIRONMENT_PREFILTER_GGX)
+    {
+        emitInclude("pbrlib/" + GlslShaderGenerator::TARGET + "/lib/mx_environment_prefilter_ggx.glsl", context, stage);
+    }
     else if (specularMethod == SPECULAR_ENVIRONMENT_NONE)
     {
         emitInclude("pbrlib/" + GlslShaderGenerator::TARGET + "/lib/mx_environment_none.glsl", context, stage);
@@ -403,6 +427,8 @@ bool GlslShaderGenerator::requiresLighting(const ShaderGraph& graph) const
 
 void GlslShaderGenerator::emitPixelStage(const ShaderGraph& graph, GenContext& context, ShaderStage& stage) const
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_EMIT_PIXEL_STAGE);
+
     HwResourceBindingContextPtr resourceBindingCtx = context.getUserData<HwResourceBindingContext>(HW::USER_DATA_BINDING_CONTEXT);
 
     // Add directives
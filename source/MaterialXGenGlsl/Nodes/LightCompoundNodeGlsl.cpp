@@ -50,11 +50,12 @@ void LightCompoundNodeGlsl::createVariables(const ShaderNode&, GenContext& conte
     ShaderStage& ps = shader.getStage(Stage::PIXEL);
     VariableBlock& lightData = ps.getUniformBlock(HW::LIGHT_DATA);
 
-    // Create all light uniforms
-    for (size_t i = 0; i<_lightUniforms.size(); ++i)
+    // Create all light uniforms, as copies of the uniforms owned by this
+    // implementation, which may be shared between shaders.
+    for (size_t i = 0; i < _lightUniforms.size(); ++i)
     {
-        ShaderPort* u = const_cast<ShaderPort*>(_lightUniforms[i]);
-        lightData.add(u->getSelf());
+        const ShaderPort* u = _lightUniforms[i];
+        lightData.add(u->getType(), u->getName());
     }
 
     const GlslShaderGenerator& shadergen = static_cast<const GlslShaderGenerator&>(context.getShaderGenerator());
@@ -15,7 +15,7 @@ namespace
 
 LightSamplerNodeGlsl::LightSamplerNodeGlsl()
 {
-    _hash = std::hash<string>{}(SAMPLE_LIGHTS_FUNC_SIGNATURE);
+    _hash = computeContentHash(SAMPLE_LIGHTS_FUNC_SIGNATURE);
 }
 
 ShaderNodeImplPtr LightSamplerNodeGlsl::create()
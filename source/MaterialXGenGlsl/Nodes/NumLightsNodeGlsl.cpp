@@ -17,7 +17,7 @@ namespace
 
 NumLightsNodeGlsl::NumLightsNodeGlsl()
 {
-    _hash = std::hash<string>{}(NUM_LIGHTS_FUNC_SIGNATURE);
+    _hash = computeContentHash(NUM_LIGHTS_FUNC_SIGNATURE);
 }
 
 ShaderNodeImplPtr NumLightsNodeGlsl::create()
@@ -28,6 +28,9 @@ namespace MaterialX
 
 namespace
 {
+    const string PHASE_GENERATE = "MdlShaderGenerator::generate";
+    const string PHASE_EMIT_STAGE = "MdlShaderGenerator::emitStage";
+
     std::unordered_map<string, string> GEOMPROP_DEFINITIONS =
     {
         {"Pobject", "base::transform_point(base::coordinate_internal, base::coordinate_object, state::position())"},
@@ -175,12 +178,17 @@ MdlShaderGenerator::MdlShaderGenerator() :
 
 ShaderPtr MdlShaderGenerator::generate(const string& name, ElementPtr element, GenContext& context) const
 {
+    GenProfiler* profiler = context.getProfiler().get();
+    ScopedGenTimer timer(profiler, PHASE_GENERATE);
+
     // For MDL we cannot cache node implementations between generation calls,
     // because this generator needs to do edits to subgraphs implementations
-    // depending on the context in which a node is used.
+    // depending on the context in which a node is used. For the same reason
+    // implementations are not shared with other contexts.
     context.clearNodeImplementations();
 
     ShaderPtr shader = createShader(name, element, context);
+    ScopedGenTimer emitTimer(profiler, PHASE_EMIT_STAGE);
 
     ShaderGraph& graph = shader->getGraph();
     ShaderStage& stage = shader->getStage(Stage::PIXEL);
@@ -280,6 +288,11 @@ ShaderPtr MdlShaderGenerator::generate(const string& name, ElementPtr element, G
     // Perform token substitution
     replaceTokens(_tokenSubstitutions, stage);
 
+    if (profiler)
+    {
+        profiler->addStage(stage);
+    }
+
     return shader;
 }
 
@@ -35,6 +35,10 @@ class MX_GENMDL_API MdlShaderGenerator : public ShaderGenerator
     /// the element and all dependencies upstream into shader code.
     ShaderPtr generate(const string& name, ElementPtr element, GenContext& context) const override;
 
+    /// MDL node implementations are edited for each shader, so they are never
+    /// shared through the implementation cache of a context.
+    bool sharesNodeImplementations() const override { return false; }
+
     /// Return the result of an upstream connection or value for an input.
     string getUpstreamResult(const ShaderInput* input, GenContext& context) const override;
 
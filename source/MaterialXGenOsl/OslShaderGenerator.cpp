@@ -26,6 +26,14 @@ namespace MaterialX
 
 const string OslShaderGenerator::TARGET = "genosl";
 
+namespace
+{
+
+const string PHASE_GENERATE = "OslShaderGenerator::generate";
+const string PHASE_EMIT_STAGE = "OslShaderGenerator::emitStage";
+
+} // anonymous namespace
+
 //
 // OslShaderGenerator methods
 //
@@ -180,7 +188,11 @@ OslShaderGenerator::OslShaderGenerator() :
 
 ShaderPtr OslShaderGenerator::generate(const string& name, ElementPtr element, GenContext& context) const
 {
+    GenProfiler* profiler = context.getProfiler().get();
+    ScopedGenTimer timer(profiler, PHASE_GENERATE);
+
     ShaderPtr shader = createShader(name, element, context);
+    ScopedGenTimer emitTimer(profiler, PHASE_EMIT_STAGE);
 
     ShaderGraph& graph = shader->getGraph();
     ShaderStage& stage = shader->getStage(Stage::PIXEL);
@@ -296,6 +308,11 @@ ShaderPtr OslShaderGenerator::generate(const string& name, ElementPtr element, G
     // Perform token substitution
     replaceTokens(_tokenSubstitutions, stage);
 
+    if (profiler)
+    {
+        profiler->addStage(stage);
+    }
+
     return shader;
 }
 
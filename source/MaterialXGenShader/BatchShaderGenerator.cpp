@@ -0,0 +1,120 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/BatchShaderGenerator.h>
+
+#include <MaterialXGenShader/ShaderGenerator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace MaterialX
+{
+
+BatchShaderGenerator::BatchShaderGenerator(GeneratorFactory generatorFactory) :
+    _generatorFactory(generatorFactory),
+    _threadCount(0),
+    _nodeImplCache(ShaderNodeImplCache::create())
+{
+    if (!_generatorFactory)
+    {
+        throw ExceptionShaderGenError("BatchShaderGenerator must have a valid shader generator factory");
+    }
+}
+
+BatchShaderResultVec BatchShaderGenerator::generate(DocumentPtr doc,
+                                                    const vector<TypedElementPtr>& elements,
+                                                    const StringVec& names)
+{
+    if (!names.empty() && names.size() != elements.size())
+    {
+        throw ExceptionShaderGenError("Mismatched shader name and element counts in batch");
+    }
+
+    BatchShaderResultVec results(elements.size());
+    _implementationNames.clear();
+    if (elements.empty())
+    {
+        return results;
+    }
+
+    size_t threadCount = _threadCount ? _threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::min(threadCount, elements.size());
+
+    // Create and seed the worker contexts on the calling thread.
+    vector<std::unique_ptr<GenContext>> contexts;
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        ShaderGeneratorPtr generator = _generatorFactory();
+        if (!generator)
+        {
+            throw ExceptionShaderGenError("Shader generator factory returned an invalid generator");
+        }
+        std::unique_ptr<GenContext> context(new GenContext(generator));
+        context->getOptions() = _options;
+        context->registerSourceCodeSearchPath(_sourceCodeSearchPath);
+        context->setShaderNodeImplCache(_nodeImplCache);
+        if (doc)
+        {
+            generator->registerShaderMetadata(doc, *context);
+        }
+        if (_contextSetup)
+        {
+            _contextSetup(*context);
+        }
+        contexts.push_back(std::move(context));
+    }
+
+    // Each worker claims the next unprocessed element until none remain,
+    // balancing elements of uneven cost across threads.
+    // Implementation names are recorded after each element, since some
+    // generators clear the implementations of their context per shader.
+    std::atomic<size_t> nextIndex(0);
+    vector<StringSet> implementationNames(threadCount);
+    auto worker = [&elements, &names, &results, &nextIndex](GenContext* context, StringSet* usedNames)
+    {
+        for (size_t i = nextIndex++; i < elements.size(); i = nextIndex++)
+        {
+            TypedElementPtr element = elements[i];
+            BatchShaderResult& result = results[i];
+            try
+            {
+                const string& name = names.empty() ? element->getName() : names[i];
+                result.shader = context->getShaderGenerator().generate(name, element, *context);
+                if (!result.shader)
+                {
+                    result.error = "Failed to generate shader for element: " + element->getNamePath();
+                }
+            }
+            catch (std::exception& e)
+            {
+                result.shader = nullptr;
+                result.error = e.what();
+            }
+            context->getNodeImplementationNames(*usedNames);
+        }
+    };
+
+    vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker, contexts[i].get(), &implementationNames[i]);
+    }
+    worker(contexts[0].get(), &implementationNames[0]);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const StringSet& usedNames : implementationNames)
+    {
+        _implementationNames.insert(usedNames.begin(), usedNames.end());
+    }
+
+    return results;
+}
+
+} // namespace MaterialX
@@ -0,0 +1,159 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_BATCHSHADERGENERATOR_H
+#define MATERIALX_BATCHSHADERGENERATOR_H
+
+/// @file
+/// Parallel shader generation for batches of elements
+
+#include <MaterialXGenShader/Export.h>
+
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
+
+#include <functional>
+
+namespace MaterialX
+{
+
+/// A shared pointer to a BatchShaderGenerator
+using BatchShaderGeneratorPtr = shared_ptr<class BatchShaderGenerator>;
+
+/// @struct BatchShaderResult
+/// The result of generating a shader for a single element of a batch.
+struct MX_GENSHADER_API BatchShaderResult
+{
+    /// The generated shader, or nullptr if generation failed.
+    ShaderPtr shader;
+
+    /// The error reported if generation failed.
+    string error;
+};
+
+/// A vector of batch shader results
+using BatchShaderResultVec = vector<BatchShaderResult>;
+
+/// @class BatchShaderGenerator
+/// A class for generating shaders for batches of elements in parallel.
+///
+/// Shader generators and generation contexts may not be shared between
+/// threads, so each worker thread generates with its own generator, created
+/// by a factory function, and its own context, seeded from the options, source
+/// code search path and setup function of the batch generator.  All worker
+/// contexts share a single ShaderNodeImplCache, so each library implementation
+/// is initialized once rather than once per thread.
+class MX_GENSHADER_API BatchShaderGenerator
+{
+  public:
+    /// A function returning a new shader generator for a worker thread.
+    using GeneratorFactory = std::function<ShaderGeneratorPtr()>;
+
+    /// A function applying additional setup to a worker context, such as
+    /// adding user data or binding light shaders.
+    using ContextSetup = std::function<void(GenContext&)>;
+
+  public:
+    /// Constructor, taking a factory function for shader generators.
+    BatchShaderGenerator(GeneratorFactory generatorFactory);
+
+    /// Create a new batch shader generator.
+    static BatchShaderGeneratorPtr create(GeneratorFactory generatorFactory)
+    {
+        return std::make_shared<BatchShaderGenerator>(generatorFactory);
+    }
+
+    /// Set the number of worker threads used for generation.  A value of
+    /// zero, the default, uses the number of hardware threads.
+    void setThreadCount(unsigned int threadCount)
+    {
+        _threadCount = threadCount;
+    }
+
+    /// Return the number of worker threads used for generation.
+    unsigned int getThreadCount() const
+    {
+        return _threadCount;
+    }
+
+    /// Return the generation options applied to each worker context.
+    GenOptions& getOptions()
+    {
+        return _options;
+    }
+
+    /// Return the generation options applied to each worker context.
+    const GenOptions& getOptions() const
+    {
+        return _options;
+    }
+
+    /// Add to the search path used by each worker context for finding source code.
+    void registerSourceCodeSearchPath(const FilePath& path)
+    {
+        _sourceCodeSearchPath.append(path);
+    }
+
+    /// Add to the search path used by each worker context for finding source code.
+    void registerSourceCodeSearchPath(const FileSearchPath& path)
+    {
+        _sourceCodeSearchPath.append(path);
+    }
+
+    /// Set a function applying additional setup to each worker context.
+    /// The function is called on the calling thread, after the options and
+    /// search path have been applied, before generation begins.
+    void setContextSetup(ContextSetup setup)
+    {
+        _contextSetup = setup;
+    }
+
+    /// Return the implementation cache shared by all worker contexts.
+    ShaderNodeImplCachePtr getShaderNodeImplCache() const
+    {
+        return _nodeImplCache;
+    }
+
+    /// Clear all implementations from the cache shared by worker contexts.
+    /// Implementations persist across batches, so the cache should be cleared
+    /// when generating for a document whose implementations may share names
+    /// with those of previous documents.
+    void clearNodeImplementations()
+    {
+        _nodeImplCache->clear();
+    }
+
+    /// Generate shaders for the given elements of a document, distributing
+    /// elements dynamically among the worker threads.
+    /// @param doc The document containing the elements, from which shader
+    ///    metadata is registered in each worker context.
+    /// @param elements The elements for which shaders are generated.
+    /// @param names An optional vector of shader names, one for each element.
+    ///    If empty, the name of each element is used.
+    /// @return A vector of results in the order of the input elements.
+    ///    Failures are reported per element rather than thrown.
+    BatchShaderResultVec generate(DocumentPtr doc,
+                                  const vector<TypedElementPtr>& elements,
+                                  const StringVec& names = StringVec());
+
+    /// Get the names of all node implementations used by the most recent batch.
+    void getNodeImplementationNames(StringSet& names) const
+    {
+        names.insert(_implementationNames.begin(), _implementationNames.end());
+    }
+
+  protected:
+    GeneratorFactory _generatorFactory;
+    unsigned int _threadCount;
+    GenOptions _options;
+    FileSearchPath _sourceCodeSearchPath;
+    ContextSetup _contextSetup;
+    ShaderNodeImplCachePtr _nodeImplCache;
+    StringSet _implementationNames;
+};
+
+} // namespace MaterialX
+
+#endif
@@ -9,6 +9,80 @@
 namespace MaterialX
 {
 
+//
+// ShaderNodeImplCache methods
+//
+
+ShaderNodeImplPtr ShaderNodeImplCache::findOrCreate(const string& key, const std::function<ShaderNodeImplPtr()>& creator)
+{
+    EntryPtr entry;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        EntryPtr& slot = _entries[key];
+        if (!slot)
+        {
+            slot = std::make_shared<Entry>();
+        }
+        entry = slot;
+    }
+
+    // Hold the entry lock while creating, so that concurrent requests
+    // for the same implementation wait rather than duplicating work.
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (!entry->impl)
+    {
+        entry->impl = creator();
+    }
+    return entry->impl;
+}
+
+ShaderNodeImplPtr ShaderNodeImplCache::find(const string& key) const
+{
+    EntryPtr entry;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it == _entries.end())
+        {
+            return nullptr;
+        }
+        entry = it->second;
+    }
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    return entry->impl;
+}
+
+size_t ShaderNodeImplCache::size() const
+{
+    // Entries are inspected outside of the cache lock, since an entry
+    // may be held by a creator that is adding dependent implementations.
+    vector<EntryPtr> entries;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        entries.reserve(_entries.size());
+        for (const auto& it : _entries)
+        {
+            entries.push_back(it.second);
+        }
+    }
+    size_t count = 0;
+    for (const EntryPtr& entry : entries)
+    {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        if (entry->impl)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+void ShaderNodeImplCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+}
+
 //
 // GenContext methods
 //
@@ -12,14 +12,69 @@
 #include <MaterialXGenShader/Export.h>
 
 #include <MaterialXGenShader/GenOptions.h>
+#include <MaterialXGenShader/GenProfiler.h>
 #include <MaterialXGenShader/GenUserData.h>
 #include <MaterialXGenShader/ShaderNode.h>
 
 #include <MaterialXFormat/File.h>
 
+#include <mutex>
+
 namespace MaterialX
 {
 
+/// A shared pointer to a ShaderNodeImplCache
+using ShaderNodeImplCachePtr = shared_ptr<class ShaderNodeImplCache>;
+
+/// @class ShaderNodeImplCache
+/// A thread-safe cache of shader node implementations, which may be shared
+/// by any number of generation contexts, including contexts used concurrently
+/// on different threads.
+///
+/// Implementations are stored under keys that combine the implementation name
+/// and a hash of its content with the generator and options used to initialize
+/// them, and are treated as immutable once initialized.  Each implementation is created and initialized
+/// exactly once, with concurrent requests for the same key waiting on the first.
+class MX_GENSHADER_API ShaderNodeImplCache
+{
+  public:
+    ShaderNodeImplCache() { }
+    ~ShaderNodeImplCache() { }
+
+    /// Create a new implementation cache.
+    static ShaderNodeImplCachePtr create()
+    {
+        return std::make_shared<ShaderNodeImplCache>();
+    }
+
+    /// Return the implementation stored under the given key, calling the
+    /// given creator function to create and store it if none exists.  If the
+    /// creator function throws an exception, nothing is stored and the
+    /// exception is propagated to the caller.
+    ShaderNodeImplPtr findOrCreate(const string& key, const std::function<ShaderNodeImplPtr()>& creator);
+
+    /// Return the implementation stored under the given key, or nullptr
+    /// if no implementation is found.
+    ShaderNodeImplPtr find(const string& key) const;
+
+    /// Return the number of implementations in the cache.
+    size_t size() const;
+
+    /// Clear all implementations from the cache.
+    void clear();
+
+  protected:
+    struct Entry
+    {
+        std::mutex mutex;
+        ShaderNodeImplPtr impl;
+    };
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    std::unordered_map<string, EntryPtr> _entries;
+    mutable std::mutex _mutex;
+};
+
 /// @class GenContext 
 /// A context class for shader generation.
 /// Used for thread local storage of data needed during shader generation.
@@ -59,6 +114,12 @@ class MX_GENSHADER_API GenContext
         _sourceCodeSearchPath.append(path);
     }
 
+    /// Return the search path used for finding source code.
+    const FileSearchPath& getSourceCodeSearchPath() const
+    {
+        return _sourceCodeSearchPath;
+    }
+
     /// Resolve a file using the registered search paths.
     FilePath resolveSourceFile(const FilePath& filename) const
     {
@@ -92,6 +153,37 @@ class MX_GENSHADER_API GenContext
     /// Clear all cached shader node implementation.
     void clearNodeImplementations();
 
+    /// Set a shared implementation cache for this context.  Implementations
+    /// not found among those cached in this context are taken from, or created
+    /// in, the shared cache, so contexts sharing a cache initialize each
+    /// implementation only once.  Implementations added to this context with
+    /// addNodeImplementation take precedence over shared implementations.
+    /// Contexts sharing a cache are expected to use the same reserved words.
+    void setShaderNodeImplCache(ShaderNodeImplCachePtr cache)
+    {
+        _nodeImplCache = cache;
+    }
+
+    /// Return the shared implementation cache for this context, if any.
+    ShaderNodeImplCachePtr getShaderNodeImplCache() const
+    {
+        return _nodeImplCache;
+    }
+
+    /// Set a profiler for this context, recording timings and counters
+    /// for shader generation.  Profilers may be shared between contexts.
+    /// Set to nullptr to disable profiling, which is the default.
+    void setProfiler(GenProfilerPtr profiler)
+    {
+        _profiler = profiler;
+    }
+
+    /// Return the profiler for this context, if any.
+    const GenProfilerPtr& getProfiler() const
+    {
+        return _profiler;
+    }
+
     /// Add user data to the context to make it
     /// available during shader generator.
     void pushUserData(const string& name, GenUserDataPtr data)
@@ -175,6 +267,12 @@ class MX_GENSHADER_API GenContext
     // Cached shader node implementations.
     std::unordered_map<string, ShaderNodeImplPtr> _nodeImpls;
 
+    // Shared shader node implementations.
+    ShaderNodeImplCachePtr _nodeImplCache;
+
+    // Profiler for timings and counters.
+    GenProfilerPtr _profiler;
+
     // User data
     std::unordered_map<string, vector<GenUserDataPtr>> _userData;
 
@@ -31,6 +31,22 @@ enum ShaderInterfaceType
     SHADER_INTERFACE_REDUCED
 };
 
+/// Level of optimization applied to the shader graph
+enum ShaderOptimizationLevel
+{
+    /// Remove constant nodes and conditionals with constant
+    /// selectors, along with any nodes left unused.
+    /// This is the default optimization level.
+    SHADER_OPTIMIZATION_BASIC,
+
+    /// In addition to the basic optimizations, evaluate math
+    /// nodes with constant inputs at generation time, and merge
+    /// identical nodes with identical inputs.  Inputs of folded
+    /// and merged nodes are no longer published as uniforms, so
+    /// this level is best combined with a reduced interface.
+    SHADER_OPTIMIZATION_FULL
+};
+
 /// Method to use for specular environment lighting
 enum HwSpecularEnvironmentMethod
 {
@@ -43,7 +59,13 @@ enum HwSpecularEnvironmentMethod
 
     /// Use pre-filtered environment maps for
     /// specular environment/indirect lighting.
-    SPECULAR_ENVIRONMENT_PREFILTER
+    SPECULAR_ENVIRONMENT_PREFILTER,
+
+    /// Use environment maps pre-filtered by the GGX distribution, with
+    /// levels indexed by roughness, for specular environment/indirect
+    /// lighting.  The radiance map is expected in the format of
+    /// createPrefilterAtlas in MaterialXRender.
+    SPECULAR_ENVIRONMENT_PREFILTER_GGX
 };
 
 /// Method to use for directional albedo evaluation
@@ -66,6 +88,7 @@ class MX_GENSHADER_API GenOptions
   public:
     GenOptions() :
         shaderInterfaceType(SHADER_INTERFACE_COMPLETE),
+        optimizationLevel(SHADER_OPTIMIZATION_BASIC),
         fileTextureVerticalFlip(false),
         addUpstreamDependencies(true),
         hwTransparency(false),
@@ -83,12 +106,14 @@ class MX_GENSHADER_API GenOptions
     virtual ~GenOptions() { }
 
     // TODO: Add options for:
-    //  - shader gen optimization level
     //  - graph flattening or not
 
     /// Sets the type of shader interface to be generated
     int shaderInterfaceType;
 
+    /// Sets the level of optimization applied to the shader graph.
+    int optimizationLevel;
+
     /// If true the y-component of texture coordinates used for sampling
     /// file textures will be flipped before sampling. This can be used if
     /// file textures need to be flipped vertically to match the target's
@@ -0,0 +1,336 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/GenProfiler.h>
+
+#include <MaterialXGenShader/ShaderStage.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace MaterialX
+{
+
+const string GenProfiler::NODES_BEFORE_OPTIMIZATION = "nodesBeforeOptimization";
+const string GenProfiler::NODES_AFTER_OPTIMIZATION = "nodesAfterOptimization";
+const string GenProfiler::INCLUDE_READS = "includeReads";
+const string GenProfiler::INCLUDE_BYTES = "includeBytes";
+const string GenProfiler::STAGE_BYTES_PREFIX = "stageBytes:";
+
+namespace {
+
+const string TIMING_TYPE_NAMES[] = { "phase", "implementation" };
+
+void writeJsonString(std::ostream& stream, const string& str)
+{
+    stream << '"';
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"': stream << "\\\""; break;
+            case '\\': stream << "\\\\"; break;
+            case '\n': stream << "\\n"; break;
+            case '\t': stream << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+                }
+                else
+                {
+                    stream << c;
+                }
+        }
+    }
+    stream << '"';
+}
+
+void writeTimings(std::ostream& stream, const GenTimingMap& timings)
+{
+    stream << "{";
+    string delim;
+    for (const auto& pair : timings)
+    {
+        stream << delim;
+        writeJsonString(stream, pair.first);
+        stream << ": { \"count\": " << pair.second.count << ", \"seconds\": " << pair.second.seconds << " }";
+        delim = ", ";
+    }
+    stream << "}";
+}
+
+// Return a small identifier for the current thread.
+size_t getThreadIndex()
+{
+    static std::mutex mutex;
+    static std::map<std::thread::id, size_t> indices;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = indices.find(std::this_thread::get_id());
+    if (it == indices.end())
+    {
+        it = indices.emplace(std::this_thread::get_id(), indices.size()).first;
+    }
+    return it->second;
+}
+
+// Return a unique identifier for a new profiler.
+size_t getNextProfilerId()
+{
+    static std::atomic<size_t> nextId(0);
+    return nextId++;
+}
+
+} // anonymous namespace
+
+// Timings are keyed by the address of their name, so that recording a
+// scope does not hash or compare strings.  Names with equal content but
+// different addresses are combined when merging into the profiler.
+struct GenProfiler::ThreadTimings
+{
+    size_t profilerId;
+    size_t thread;
+    size_t depth;
+    std::unordered_map<const string*, GenTiming> phaseTimings;
+    std::unordered_map<const string*, GenTiming> implementationTimings;
+    GenCounterMap counters;
+    vector<TraceEvent> traceEvents;
+};
+
+//
+// GenProfiler methods
+//
+
+GenProfiler::GenProfiler() :
+    _id(getNextProfilerId()),
+    _startTime(std::chrono::steady_clock::now()),
+    _traceEnabled(false)
+{
+}
+
+void GenProfiler::setTraceEnabled(bool enabled)
+{
+    _traceEnabled = enabled;
+}
+
+bool GenProfiler::getTraceEnabled() const
+{
+    return _traceEnabled;
+}
+
+void GenProfiler::addTiming(TimingType type, const string& name, double start, double duration)
+{
+    ThreadTimings* timings = findThreadTimings();
+    if (timings)
+    {
+        addThreadTiming(*timings, type, name, start, duration);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    GenTiming& timing = (type == PHASE) ? _phaseTimings[name] : _implementationTimings[name];
+    timing.count++;
+    timing.seconds += duration;
+    if (_traceEnabled)
+    {
+        _traceEvents.push_back({ type, name, start, duration, getThreadIndex() });
+    }
+}
+
+void GenProfiler::addCounter(const string& name, uint64_t value)
+{
+    ThreadTimings* timings = findThreadTimings();
+    if (timings)
+    {
+        timings->counters[name] += value;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _counters[name] += value;
+}
+
+void GenProfiler::addStage(const ShaderStage& stage)
+{
+    addCounter(STAGE_BYTES_PREFIX + stage.getName(), stage.getSourceCode().size());
+}
+
+GenTimingMap GenProfiler::getPhaseTimings() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _phaseTimings;
+}
+
+GenTimingMap GenProfiler::getImplementationTimings() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _implementationTimings;
+}
+
+uint64_t GenProfiler::getCounter(const string& name) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _counters.find(name);
+    return it != _counters.end() ? it->second : 0;
+}
+
+GenCounterMap GenProfiler::getCounters() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _counters;
+}
+
+string GenProfiler::toJson() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ostringstream stream;
+    stream << "{\n  \"phases\": ";
+    writeTimings(stream, _phaseTimings);
+    stream << ",\n  \"implementations\": ";
+    writeTimings(stream, _implementationTimings);
+    stream << ",\n  \"counters\": {";
+    string delim;
+    for (const auto& pair : _counters)
+    {
+        stream << delim;
+        writeJsonString(stream, pair.first);
+        stream << ": " << pair.second;
+        delim = ", ";
+    }
+    stream << "}\n}\n";
+    return stream.str();
+}
+
+string GenProfiler::toChromeTrace() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"traceEvents\": [\n";
+    string delim;
+    double end = 0.0;
+    for (const TraceEvent& event : _traceEvents)
+    {
+        stream << delim << "{\"name\": ";
+        writeJsonString(stream, event.name);
+        stream << ", \"cat\": \"" << TIMING_TYPE_NAMES[event.type] << "\", \"ph\": \"X\"" <<
+                  ", \"ts\": " << event.start * 1.0e6 << ", \"dur\": " << event.duration * 1.0e6 <<
+                  ", \"pid\": 0, \"tid\": " << event.thread << "}";
+        delim = ",\n";
+        end = std::max(end, event.start + event.duration);
+    }
+
+    // Counters are reported with their final values.
+    for (const auto& pair : _counters)
+    {
+        stream << delim << "{\"name\": ";
+        writeJsonString(stream, pair.first);
+        stream << ", \"ph\": \"C\", \"ts\": " << end * 1.0e6 << ", \"pid\": 0, \"args\": {\"value\": " << pair.second << "}}";
+        delim = ",\n";
+    }
+    stream << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    return stream.str();
+}
+
+GenProfiler::ThreadTimings* GenProfiler::beginScope()
+{
+    ThreadTimings* timings = findThreadTimings();
+    if (!timings)
+    {
+        vector<std::unique_ptr<ThreadTimings>>& timingsList = getThreadTimingsList();
+        timingsList.emplace_back(new ThreadTimings());
+        timings = timingsList.back().get();
+        timings->profilerId = _id;
+        timings->thread = getThreadIndex();
+        timings->depth = 0;
+    }
+    timings->depth++;
+    return timings;
+}
+
+void GenProfiler::endScope(ThreadTimings* timings, TimingType type, const string& name, double start, double duration)
+{
+    addThreadTiming(*timings, type, name, start, duration);
+    if (--timings->depth > 0)
+    {
+        return;
+    }
+
+    mergeThreadTimings(*timings);
+    vector<std::unique_ptr<ThreadTimings>>& timingsList = getThreadTimingsList();
+    for (auto it = timingsList.begin(); it != timingsList.end(); ++it)
+    {
+        if (it->get() == timings)
+        {
+            timingsList.erase(it);
+            break;
+        }
+    }
+}
+
+void GenProfiler::addThreadTiming(ThreadTimings& timings, TimingType type, const string& name, double start, double duration)
+{
+    GenTiming& timing = (type == PHASE) ? timings.phaseTimings[&name] : timings.implementationTimings[&name];
+    timing.count++;
+    timing.seconds += duration;
+    if (_traceEnabled)
+    {
+        timings.traceEvents.push_back({ type, name, start, duration, timings.thread });
+    }
+}
+
+GenProfiler::ThreadTimings* GenProfiler::findThreadTimings()
+{
+    for (const std::unique_ptr<ThreadTimings>& timings : getThreadTimingsList())
+    {
+        if (timings->profilerId == _id)
+        {
+            return timings.get();
+        }
+    }
+    return nullptr;
+}
+
+vector<std::unique_ptr<GenProfiler::ThreadTimings>>& GenProfiler::getThreadTimingsList()
+{
+    thread_local vector<std::unique_ptr<ThreadTimings>> timingsList;
+    return timingsList;
+}
+
+void GenProfiler::mergeThreadTimings(const ThreadTimings& timings)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& pair : timings.phaseTimings)
+    {
+        GenTiming& timing = _phaseTimings[*pair.first];
+        timing.count += pair.second.count;
+        timing.seconds += pair.second.seconds;
+    }
+    for (const auto& pair : timings.implementationTimings)
+    {
+        GenTiming& timing = _implementationTimings[*pair.first];
+        timing.count += pair.second.count;
+        timing.seconds += pair.second.seconds;
+    }
+    for (const auto& pair : timings.counters)
+    {
+        _counters[pair.first] += pair.second;
+    }
+    _traceEvents.insert(_traceEvents.end(), timings.traceEvents.begin(), timings.traceEvents.end());
+}
+
+void GenProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _phaseTimings.clear();
+    _implementationTimings.clear();
+    _counters.clear();
+    _traceEvents.clear();
+}
+
+} // namespace MaterialX
@@ -0,0 +1,229 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_GENPROFILER_H
+#define MATERIALX_GENPROFILER_H
+
+/// @file
+/// Timings and counters for shader generation
+
+#include <MaterialXGenShader/Export.h>
+
+#include <MaterialXCore/Library.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace MaterialX
+{
+
+class ShaderStage;
+
+/// A shared pointer to a GenProfiler
+using GenProfilerPtr = shared_ptr<class GenProfiler>;
+
+/// @struct GenTiming
+/// The accumulated time spent in a phase or implementation.
+struct MX_GENSHADER_API GenTiming
+{
+    /// The number of times the phase or implementation was entered.
+    size_t count = 0;
+
+    /// The total time in seconds, including time spent in nested scopes.
+    double seconds = 0.0;
+};
+
+/// A map from phase or implementation names to timings
+using GenTimingMap = std::map<string, GenTiming>;
+
+/// A map from counter names to values
+using GenCounterMap = std::map<string, uint64_t>;
+
+/// @class GenProfiler
+/// A thread-safe collection of timings and counters for shader generation,
+/// which may be set on any number of generation contexts.
+///
+/// Generation records the time spent in phases such as graph creation,
+/// optimization and stage emission, the time spent emitting code for each
+/// node implementation, and counters for graph nodes, include files and
+/// bytes emitted per stage.  Timings are accumulated per name, so the cost
+/// of profiling does not grow with the number of shaders generated.  If
+/// tracing is enabled, each timed scope is also recorded as an event, for
+/// export in the Chrome trace event format.
+///
+/// Timings and counters recorded within a timed scope are accumulated by
+/// the calling thread, without locking, and are merged into the profiler
+/// when the outermost timed scope on that thread ends, which is normally
+/// the end of a call to ShaderGenerator::generate.
+///
+/// Generation contexts without a profiler skip all timing.
+class MX_GENSHADER_API GenProfiler
+{
+  public:
+    /// The kind of a timed scope.
+    enum TimingType
+    {
+        PHASE,
+        IMPLEMENTATION
+    };
+
+  public:
+    GenProfiler();
+    ~GenProfiler() { }
+
+    /// Create a new profiler.
+    static GenProfilerPtr create()
+    {
+        return std::make_shared<GenProfiler>();
+    }
+
+    /// Enable or disable the recording of trace events.  Defaults to false.
+    void setTraceEnabled(bool enabled);
+
+    /// Return true if trace events are recorded.
+    bool getTraceEnabled() const;
+
+    /// Add a timed scope with the given start time and duration in seconds,
+    /// where start times are relative to the creation of the profiler.  The
+    /// name must remain valid until the outermost timed scope on the calling
+    /// thread ends.
+    void addTiming(TimingType type, const string& name, double start, double duration);
+
+    /// Add the given value to a counter.
+    void addCounter(const string& name, uint64_t value = 1);
+
+    /// Add the size of the source code of a stage to the counters.
+    void addStage(const ShaderStage& stage);
+
+    /// Return the time in seconds since the creation of the profiler.
+    double getTime() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count();
+    }
+
+    /// Return the timings of generation phases.
+    GenTimingMap getPhaseTimings() const;
+
+    /// Return the timings of node implementations, covering the emission
+    /// of their function definitions and calls.
+    GenTimingMap getImplementationTimings() const;
+
+    /// Return the value of a counter, or zero if it has not been set.
+    uint64_t getCounter(const string& name) const;
+
+    /// Return all counters.
+    GenCounterMap getCounters() const;
+
+    /// Return the timings and counters as a JSON string.
+    string toJson() const;
+
+    /// Return the recorded trace events and final counter values as a JSON
+    /// string in the Chrome trace event format.
+    string toChromeTrace() const;
+
+    /// Clear all timings, counters and trace events.
+    void clear();
+
+  public:
+    /// Counter for the number of nodes in graphs before optimization.
+    static const string NODES_BEFORE_OPTIMIZATION;
+
+    /// Counter for the number of nodes in graphs after optimization.
+    static const string NODES_AFTER_OPTIMIZATION;
+
+    /// Counter for the number of include files read into stages.
+    static const string INCLUDE_READS;
+
+    /// Counter for the number of bytes read from include files.
+    static const string INCLUDE_BYTES;
+
+    /// Prefix of the counters for the number of bytes emitted per stage.
+    static const string STAGE_BYTES_PREFIX;
+
+  protected:
+    friend class ScopedGenTimer;
+
+    struct TraceEvent
+    {
+        TimingType type;
+        string name;
+        double start;
+        double duration;
+        size_t thread;
+    };
+
+    // Timings and counters accumulated by one thread within timed scopes.
+    struct ThreadTimings;
+
+    // Enter a timed scope on the calling thread, returning its timings.
+    ThreadTimings* beginScope();
+
+    // Leave a timed scope on the calling thread, merging its timings into
+    // the profiler if it is the outermost scope.
+    void endScope(ThreadTimings* timings, TimingType type, const string& name, double start, double duration);
+
+    // Add a timed scope to the given thread timings.
+    void addThreadTiming(ThreadTimings& timings, TimingType type, const string& name, double start, double duration);
+
+    // Return the timings of the calling thread for this profiler, or null
+    // if the thread is not within a timed scope.
+    ThreadTimings* findThreadTimings();
+
+    // Return the timings of all profilers with open scopes on the calling
+    // thread.
+    static vector<std::unique_ptr<ThreadTimings>>& getThreadTimingsList();
+
+    // Merge the given thread timings into the profiler.
+    void mergeThreadTimings(const ThreadTimings& timings);
+
+    const size_t _id;
+    std::chrono::steady_clock::time_point _startTime;
+    std::atomic<bool> _traceEnabled;
+    GenTimingMap _phaseTimings;
+    GenTimingMap _implementationTimings;
+    GenCounterMap _counters;
+    vector<TraceEvent> _traceEvents;
+    mutable std::mutex _mutex;
+};
+
+/// @class ScopedGenTimer
+/// A timer adding the duration of its scope to a profiler.  If the profiler
+/// is null, the timer does nothing.
+class MX_GENSHADER_API ScopedGenTimer
+{
+  public:
+    /// Start timing a scope with the given name, which must remain valid
+    /// until the outermost timed scope on the calling thread ends.
+    ScopedGenTimer(GenProfiler* profiler, const string& name,
+                   GenProfiler::TimingType type = GenProfiler::PHASE) :
+        _profiler(profiler),
+        _name(name),
+        _type(type),
+        _timings(profiler ? profiler->beginScope() : nullptr),
+        _start(profiler ? profiler->getTime() : 0.0)
+    {
+    }
+
+    ~ScopedGenTimer()
+    {
+        if (_profiler)
+        {
+            _profiler->endScope(_timings, _type, _name, _start, _profiler->getTime() - _start);
+        }
+    }
+
+  private:
+    GenProfiler* _profiler;
+    const string& _name;
+    GenProfiler::TimingType _type;
+    GenProfiler::ThreadTimings* _timings;
+    double _start;
+};
+
+} // namespace MaterialX
+
+#endif
@@ -473,7 +473,9 @@ void HwShaderGenerator::emitFunctionCall(const ShaderNode& node, GenContext& con
     {
         // A match between closure context and node classification was found.
         // So emit the function call in this context.
-        node.getImplementation().emitFunctionCall(node, context, stage);
+        const ShaderNodeImpl& impl = node.getImplementation();
+        ScopedGenTimer timer(context.getProfiler().get(), impl.getName(), GenProfiler::IMPLEMENTATION);
+        impl.emitFunctionCall(node, context, stage);
     }
     else
     {
@@ -15,6 +15,33 @@
 namespace MaterialX
 {
 
+namespace
+{
+
+void addHashString(string& data, const string& str)
+{
+    data += std::to_string(str.size()) + ":" + str;
+}
+
+void addHashInput(string& data, const ShaderInput* input)
+{
+    addHashString(data, input->getType()->getName());
+    addHashString(data, input->getVariable());
+    addHashString(data, input->getChannels());
+    const ShaderOutput* connection = input->getConnection();
+    if (connection)
+    {
+        addHashString(data, connection->getNode()->getName());
+        addHashString(data, connection->getVariable());
+    }
+    else
+    {
+        addHashString(data, input->getValue() ? input->getValue()->getValueString() : EMPTY_STRING);
+    }
+}
+
+} // anonymous namespace
+
 ShaderNodeImplPtr CompoundNode::create()
 {
     return std::make_shared<CompoundNode>();
@@ -41,9 +68,42 @@ void CompoundNode::initialize(const InterfaceElement& element, GenContext& conte
     _rootGraph = ShaderGraph::create(nullptr, graph, context);
     context.getOptions().shaderInterfaceType = oldShaderInterfaceType;
 
-    // Set hash using the function name.
-    // TODO: Could be improved to include the full function signature.
-    _hash = std::hash<string>{}(_functionName);
+    _hash = computeGraphHash();
+}
+
+uint64_t CompoundNode::computeGraphHash() const
+{
+    // Describe the function signature.
+    string data;
+    addHashString(data, _functionName);
+    for (ShaderGraphInputSocket* inputSocket : _rootGraph->getInputSockets())
+    {
+        addHashString(data, inputSocket->getType()->getName());
+        addHashString(data, inputSocket->getVariable());
+    }
+    for (ShaderGraphOutputSocket* outputSocket : _rootGraph->getOutputSockets())
+    {
+        addHashInput(data, outputSocket);
+    }
+
+    // Describe the function body, including the hashes of the
+    // implementations called from it.
+    for (const ShaderNode* node : _rootGraph->getNodes())
+    {
+        addHashString(data, node->getName());
+        data += std::to_string(node->getImplementation().getHash()) + ";";
+        for (const ShaderInput* input : node->getInputs())
+        {
+            addHashInput(data, input);
+        }
+        for (const ShaderOutput* output : node->getOutputs())
+        {
+            addHashString(data, output->getType()->getName());
+            addHashString(data, output->getVariable());
+        }
+    }
+
+    return computeContentHash(data);
 }
 
 void CompoundNode::createVariables(const ShaderNode&, GenContext& context, Shader& shader) const
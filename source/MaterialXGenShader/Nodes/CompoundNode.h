@@ -29,6 +29,11 @@ class MX_GENSHADER_API CompoundNode : public ShaderNodeImpl
 
     ShaderGraph* getGraph() const override { return _rootGraph.get(); }
 
+  protected:
+    /// Return a content hash of the function emitted for the graph,
+    /// covering its signature and the structure of its body.
+    uint64_t computeGraphHash() const;
+
   protected:
     ShaderGraphPtr _rootGraph;
     string _functionName;
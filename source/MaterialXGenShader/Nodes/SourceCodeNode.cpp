@@ -8,6 +8,7 @@
 #include <MaterialXGenShader/ShaderNode.h>
 #include <MaterialXGenShader/ShaderStage.h>
 #include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/SourceFileCache.h>
 #include <MaterialXFormat/Util.h>
 
 namespace MaterialX
@@ -35,12 +36,14 @@ void SourceCodeNode::initialize(const InterfaceElement& element, GenContext& con
     {
         FilePath file(impl.getAttribute("file"));
         file = context.resolveSourceFile(file);
-        _functionSource = readFile(file);
-        if (_functionSource.empty())
+        SourceFilePtr sourceFile = SourceFileCache::get().getFile(file);
+        if (!sourceFile)
         {
             throw ExceptionShaderGenError("Failed to get source code from file '" + file.asString() +
                 "' used by implementation '" + impl.getName() + "'");
         }
+        _functionSource = sourceFile->getContent();
+        _functionSourceFile = sourceFile;
     }
 
     // Find the function name to use
@@ -63,9 +66,9 @@ void SourceCodeNode::initialize(const InterfaceElement& element, GenContext& con
         _functionSource = replaceSubstrings(_functionSource, { { "\n", "" } });
     }
 
-    // Set hash using the function name.
-    // TODO: Could be improved to include the full function signature.
-    _hash = std::hash<string>{}(_functionName);
+    // Set hash using the function name and the source code, so that identical
+    // functions are emitted once, even when used by different nodedefs.
+    _hash = computeContentHash(_functionSource, computeContentHash(_functionName));
 }
 
 void SourceCodeNode::emitFunctionDefinition(const ShaderNode&, GenContext& context, ShaderStage& stage) const
@@ -75,7 +78,14 @@ void SourceCodeNode::emitFunctionDefinition(const ShaderNode&, GenContext& conte
         if (!_inlined && !_functionSource.empty())
         {
             const ShaderGenerator& shadergen = context.getShaderGenerator();
-            shadergen.emitBlock(_functionSource, context, stage);
+            if (_functionSourceFile)
+            {
+                shadergen.emitSourceFile(_functionSourceFile, context, stage);
+            }
+            else
+            {
+                shadergen.emitBlock(_functionSource, context, stage);
+            }
             shadergen.emitLineBreak(stage);
         }
     END_SHADER_STAGE(stage, Stage::PIXEL)
@@ -7,6 +7,7 @@
 #define MATERIALX_SOURCECODENODE_H
 
 #include <MaterialXGenShader/ShaderNodeImpl.h>
+#include <MaterialXGenShader/SourceFileCache.h>
 
 namespace MaterialX
 {
@@ -27,6 +28,7 @@ protected:
     bool _inlined;
     string _functionName;
     string _functionSource;
+    SourceFilePtr _functionSourceFile;
 };
 
 } // namespace MaterialX
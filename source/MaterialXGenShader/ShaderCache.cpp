@@ -0,0 +1,662 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/ShaderCache.h>
+
+#include <MaterialXGenShader/HwShaderGenerator.h>
+#include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/SourceFileCache.h>
+#include <MaterialXGenShader/Util.h>
+
+#include <MaterialXFormat/Util.h>
+
+#include <MaterialXCore/Util.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <typeinfo>
+
+namespace MaterialX
+{
+
+namespace {
+
+const string SHADER_CACHE_EXTENSION = "mtlxshader";
+const string SHADER_CACHE_MAGIC = "MTLXSHADER";
+const uint32_t SHADER_CACHE_FORMAT_VERSION = 1;
+
+// The precision with which float values are stored, allowing them to be
+// restored exactly.
+const int SHADER_CACHE_FLOAT_PRECISION = 9;
+
+string toHexString(uint64_t value)
+{
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << value;
+    return stream.str();
+}
+
+// Accumulate the content that determines a generated shader, and reduce it
+// to a 128-bit key.
+class KeyBuilder
+{
+  public:
+    void addString(const string& str)
+    {
+        addUInt((uint64_t) str.size());
+        _data += str;
+    }
+
+    void addUInt(uint64_t value)
+    {
+        _data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void addElement(ConstElementPtr elem)
+    {
+        addString(elem->getCategory());
+        addString(elem->getName());
+        StringVec attrNames = elem->getAttributeNames();
+        addUInt(attrNames.size());
+        for (const string& attrName : attrNames)
+        {
+            addString(attrName);
+            addString(elem->getAttribute(attrName));
+        }
+        const vector<ElementPtr>& children = elem->getChildren();
+        addUInt(children.size());
+        for (ElementPtr child : children)
+        {
+            addElement(child);
+        }
+    }
+
+    string getKey() const
+    {
+        return toHexString(computeContentHash(_data)) +
+               toHexString(computeContentHash(_data.data(), _data.size(), 0x9E3779B97F4A7C15ULL));
+    }
+
+  private:
+    string _data;
+};
+
+// Write cached shader data to a buffer.
+class CacheWriter
+{
+  public:
+    void writeUInt32(uint32_t value)
+    {
+        _buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(const string& str)
+    {
+        writeUInt32((uint32_t) str.size());
+        _buffer += str;
+    }
+
+    void writeValue(ValuePtr value)
+    {
+        writeString(value ? value->getTypeString() : EMPTY_STRING);
+        writeString(value ? value->getValueString() : EMPTY_STRING);
+    }
+
+    void writeMetadata(const ShaderMetadataVecPtr& metadata)
+    {
+        writeUInt32(metadata ? (uint32_t) metadata->size() : 0);
+        if (metadata)
+        {
+            for (const ShaderMetadata& data : *metadata)
+            {
+                writeString(data.name);
+                writeString(data.type->getName());
+                writeValue(data.value);
+            }
+        }
+    }
+
+    void writeBlock(const VariableBlock& block)
+    {
+        writeString(block.getName());
+        writeString(block.getInstance());
+        writeUInt32((uint32_t) block.size());
+        for (const ShaderPort* port : block.getVariableOrder())
+        {
+            writeString(port->getType()->getName());
+            writeString(port->getName());
+            writeString(port->getVariable());
+            writeString(port->getSemantic());
+            writeValue(port->getValue());
+            writeString(port->getUnit());
+            writeString(port->getGeomProp());
+            writeString(port->getPath());
+            writeUInt32(port->getFlags());
+            writeMetadata(port->getMetadata());
+        }
+    }
+
+    void writeBlocks(const VariableBlockMap& blocks)
+    {
+        // Write blocks in a stable order.
+        std::map<string, VariableBlockPtr> sortedBlocks(blocks.begin(), blocks.end());
+        writeUInt32((uint32_t) sortedBlocks.size());
+        for (const auto& pair : sortedBlocks)
+        {
+            writeBlock(*pair.second);
+        }
+    }
+
+    const string& getBuffer() const
+    {
+        return _buffer;
+    }
+
+  private:
+    string _buffer;
+};
+
+// Read cached shader data from a buffer, with bounds checking.
+class CacheReader
+{
+  public:
+    CacheReader(const string& buffer) :
+        _buffer(buffer),
+        _offset(0)
+    {
+    }
+
+    uint32_t readUInt32()
+    {
+        uint32_t value;
+        std::memcpy(&value, advance(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+    string readString()
+    {
+        uint32_t length = readUInt32();
+        return string(advance(length), length);
+    }
+
+    ValuePtr readValue()
+    {
+        string type = readString();
+        string value = readString();
+        return type.empty() ? nullptr : Value::createValueFromStrings(value, type);
+    }
+
+    const TypeDesc* readType()
+    {
+        const TypeDesc* type = TypeDesc::get(readString());
+        if (!type)
+        {
+            throw ExceptionShaderGenError("Unknown type in cached shader");
+        }
+        return type;
+    }
+
+    ShaderMetadataVecPtr readMetadata()
+    {
+        uint32_t count = readUInt32();
+        if (!count)
+        {
+            return nullptr;
+        }
+        ShaderMetadataVecPtr metadata = std::make_shared<ShaderMetadataVec>();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            string name = readString();
+            const TypeDesc* type = readType();
+            ValuePtr value = readValue();
+            metadata->emplace_back(name, type, value);
+        }
+        return metadata;
+    }
+
+    void readBlock(VariableBlock& block)
+    {
+        block.setName(readString());
+        block.setInstance(readString());
+        uint32_t count = readUInt32();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const TypeDesc* type = readType();
+            string name = readString();
+            ShaderPort* port = block.add(type, name);
+            port->setVariable(readString());
+            port->setSemantic(readString());
+            port->setValue(readValue());
+            port->setUnit(readString());
+            port->setGeomProp(readString());
+            port->setPath(readString());
+            port->setFlags(readUInt32());
+            port->setMetadata(readMetadata());
+        }
+    }
+
+    bool atEnd() const
+    {
+        return _offset == _buffer.size();
+    }
+
+  private:
+    const char* advance(size_t size)
+    {
+        if (size > _buffer.size() - _offset)
+        {
+            throw ExceptionShaderGenError("Unexpected end of cached shader");
+        }
+        const char* ptr = _buffer.data() + _offset;
+        _offset += size;
+        return ptr;
+    }
+
+  private:
+    const string& _buffer;
+    size_t _offset;
+};
+
+} // anonymous namespace
+
+//
+// ShaderCache methods
+//
+
+ShaderCache::ShaderCache(const FilePath& directory) :
+    _directory(directory),
+    _hitCount(0),
+    _missCount(0)
+{
+    if (!_directory.exists())
+    {
+        _directory.createDirectory();
+    }
+}
+
+ShaderPtr ShaderCache::generate(const string& name, ElementPtr element, GenContext& context)
+{
+    const string key = computeKey(name, element, context);
+    ShaderPtr shader = load(key, element, context);
+    if (shader)
+    {
+        _hitCount++;
+        return shader;
+    }
+
+    _missCount++;
+    shader = context.getShaderGenerator().generate(name, element, context);
+    if (shader)
+    {
+        save(key, *shader);
+    }
+    return shader;
+}
+
+string ShaderCache::computeContextKey(GenContext& context)
+{
+    ShaderGenerator& generator = context.getShaderGenerator();
+    KeyBuilder key;
+
+    // Add the library version and shader generator.
+    key.addString(getVersionString());
+    key.addString(typeid(generator).name());
+    key.addString(generator.getTarget());
+    key.addString(generator.getColorManagementSystem() ? generator.getColorManagementSystem()->getName() : EMPTY_STRING);
+    key.addString(generator.getUnitSystem() ? generator.getUnitSystem()->getName() : EMPTY_STRING);
+
+    // Add generation options.
+    const GenOptions& options = context.getOptions();
+    key.addUInt((uint64_t) options.shaderInterfaceType);
+    key.addUInt((uint64_t) options.optimizationLevel);
+    key.addUInt(options.fileTextureVerticalFlip);
+    key.addString(options.targetColorSpaceOverride);
+    key.addString(options.targetDistanceUnit);
+    key.addUInt(options.addUpstreamDependencies);
+    key.addUInt(options.hwTransparency);
+    key.addUInt((uint64_t) options.hwSpecularEnvironmentMethod);
+    key.addUInt((uint64_t) options.hwDirectionalAlbedoMethod);
+    key.addUInt(options.hwWriteDepthMoments);
+    key.addUInt(options.hwShadowMap);
+    key.addUInt(options.hwAmbientOcclusion);
+    key.addUInt(options.hwMaxActiveLightSources);
+    key.addUInt(options.hwNormalizeUdimTexCoords);
+    key.addUInt(options.hwWriteAlbedoTable);
+    key.addUInt(options.hwMaxRadianceSamples);
+
+    // Add context state that affects code emission.
+    const StringSet& reservedWords = context.getReservedWords();
+    key.addUInt(reservedWords.size());
+    for (const string& word : reservedWords)
+    {
+        key.addString(word);
+    }
+    HwLightShadersPtr lightShaders = context.getUserData<HwLightShaders>(HW::USER_DATA_LIGHT_SHADERS);
+    if (lightShaders)
+    {
+        std::map<unsigned int, ShaderNodePtr> sortedShaders(lightShaders->get().begin(), lightShaders->get().end());
+        key.addUInt(sortedShaders.size());
+        for (const auto& pair : sortedShaders)
+        {
+            key.addUInt(pair.first);
+            key.addString(pair.second->getName());
+            key.addString(pair.second->getImplementation().getName());
+            key.addUInt(pair.second->getImplementation().getHash());
+        }
+    }
+    ShaderMetadataRegistryPtr metadataRegistry = context.getUserData<ShaderMetadataRegistry>(ShaderMetadataRegistry::USER_DATA_NAME);
+    if (metadataRegistry)
+    {
+        key.addUInt(metadataRegistry->getAllMetadata().size());
+        for (const ShaderMetadata& data : metadataRegistry->getAllMetadata())
+        {
+            key.addString(data.name);
+            key.addString(data.type->getName());
+            key.addString(data.value ? data.value->getValueString() : EMPTY_STRING);
+        }
+    }
+    HwResourceBindingContextPtr bindingContext = context.getUserData<HwResourceBindingContext>(HW::USER_DATA_BINDING_CONTEXT);
+    key.addString(bindingContext ? typeid(*bindingContext).name() : EMPTY_STRING);
+
+    return key.getKey();
+}
+
+string ShaderCache::computeKey(const string& name, ElementPtr element, GenContext& context)
+{
+    ShaderGenerator& generator = context.getShaderGenerator();
+    const string& target = generator.getTarget();
+    KeyBuilder key;
+
+    // Add the cache format, shader name and generation context.
+    key.addUInt(SHADER_CACHE_FORMAT_VERSION);
+    key.addString(name);
+    key.addString(computeContextKey(context));
+
+    // Add document-level state and definitions that are referenced by name.
+    ConstDocumentPtr doc = element->getDocument();
+    StringVec docAttrNames = doc->getAttributeNames();
+    for (const string& attrName : docAttrNames)
+    {
+        key.addString(attrName);
+        key.addString(doc->getAttribute(attrName));
+    }
+    for (ElementPtr child : doc->getChildren())
+    {
+        if (child->isA<TypeDef>() || child->isA<GeomPropDef>() ||
+            child->isA<UnitDef>() || child->isA<UnitTypeDef>())
+        {
+            key.addElement(child);
+        }
+    }
+
+    // Add the upstream subgraph of the element, along with the nodedefs and
+    // implementations to which it resolves, in a stable traversal order.
+    std::set<ConstElementPtr> visited;
+    StringSet visitedFiles;
+    vector<ConstElementPtr> stack = { element };
+    auto pushElement = [&stack, &visited](ConstElementPtr elem)
+    {
+        if (elem && !visited.count(elem))
+        {
+            stack.push_back(elem);
+        }
+    };
+    std::function<void(const FilePath&)> addSourceFile = [&](const FilePath& filename)
+    {
+        if (filename.isEmpty() || visitedFiles.count(filename.asString()))
+        {
+            return;
+        }
+        visitedFiles.insert(filename.asString());
+        SourceFileEntryPtr sourceFile = getSourceFile(filename, generator.getSyntax());
+        key.addString(filename.asString());
+        key.addString(sourceFile->hash);
+        for (const string& include : sourceFile->includes)
+        {
+            // Tokenized includes are substituted by the generator during code
+            // emission, based on options that are already part of the key.
+            if (include.find('$') != string::npos)
+            {
+                key.addString(include);
+                continue;
+            }
+            addSourceFile(context.resolveSourceFile(include));
+        }
+    };
+    while (!stack.empty())
+    {
+        ConstElementPtr elem = stack.back();
+        stack.pop_back();
+        if (visited.count(elem))
+        {
+            continue;
+        }
+        visited.insert(elem);
+        key.addElement(elem);
+
+        // Elements within a graph depend on its interface.
+        ConstElementPtr parent = elem->getParent();
+        if (parent && parent->isA<NodeGraph>())
+        {
+            pushElement(parent);
+        }
+
+        if (elem->isA<Node>())
+        {
+            ConstNodePtr node = elem->asA<Node>();
+            NodeDefPtr nodeDef = node->getNodeDef(target);
+            pushElement(nodeDef);
+            for (InputPtr input : node->getInputs())
+            {
+                pushElement(input->getConnectedNode());
+                if (input->hasNodeGraphString())
+                {
+                    pushElement(doc->getNodeGraph(input->getNodeGraphString()));
+                }
+            }
+        }
+        else if (elem->isA<Output>())
+        {
+            ConstOutputPtr output = elem->asA<Output>();
+            pushElement(output->getConnectedNode());
+            if (output->hasNodeGraphString())
+            {
+                pushElement(doc->getNodeGraph(output->getNodeGraphString()));
+            }
+        }
+        else if (elem->isA<NodeGraph>())
+        {
+            ConstNodeGraphPtr graph = elem->asA<NodeGraph>();
+            pushElement(graph->getNodeDef());
+            for (ElementPtr child : graph->getChildren())
+            {
+                pushElement(child);
+            }
+        }
+        else if (elem->isA<NodeDef>())
+        {
+            ConstNodeDefPtr nodeDef = elem->asA<NodeDef>();
+            pushElement(nodeDef->getImplementation(target));
+            pushElement(nodeDef->getInheritsFrom());
+        }
+        else if (elem->isA<Implementation>())
+        {
+            ConstImplementationPtr impl = elem->asA<Implementation>();
+            if (impl->hasFile())
+            {
+                addSourceFile(context.resolveSourceFile(impl->getFile()));
+            }
+        }
+    }
+
+    return key.getKey();
+}
+
+ShaderPtr ShaderCache::load(const string& key, ElementPtr element, GenContext& context) const
+{
+    FilePath path = getShaderPath(key);
+    if (!path.exists())
+    {
+        return nullptr;
+    }
+    string buffer = readFile(path);
+
+    try
+    {
+        CacheReader reader(buffer);
+        if (reader.readString() != SHADER_CACHE_MAGIC ||
+            reader.readUInt32() != SHADER_CACHE_FORMAT_VERSION ||
+            reader.readString() != key)
+        {
+            return nullptr;
+        }
+
+        // Create the shader with an empty graph.
+        string name = reader.readString();
+        ShaderGraphPtr graph = std::make_shared<ShaderGraph>(nullptr, name, element->getDocument(), context.getReservedWords());
+        graph->_classification = reader.readUInt32();
+        ShaderPtr shader = std::make_shared<Shader>(name, graph);
+
+        uint32_t attrCount = reader.readUInt32();
+        for (uint32_t i = 0; i < attrCount; i++)
+        {
+            string attrName = reader.readString();
+            shader->setAttribute(attrName, reader.readValue());
+        }
+
+        ShaderGenerator& generator = context.getShaderGenerator();
+        uint32_t stageCount = reader.readUInt32();
+        for (uint32_t i = 0; i < stageCount; i++)
+        {
+            ShaderStagePtr stage = shader->createStage(reader.readString(), generator._syntax);
+            stage->_functionName = reader.readString();
+            stage->_code.assign(reader.readString());
+            reader.readBlock(stage->_constants);
+            for (VariableBlockMap* blocks : { &stage->_uniforms, &stage->_inputs, &stage->_outputs })
+            {
+                uint32_t blockCount = reader.readUInt32();
+                for (uint32_t j = 0; j < blockCount; j++)
+                {
+                    VariableBlockPtr block = std::make_shared<VariableBlock>(EMPTY_STRING, EMPTY_STRING);
+                    reader.readBlock(*block);
+                    (*blocks)[block->getName()] = block;
+                }
+            }
+        }
+        if (!reader.atEnd())
+        {
+            return nullptr;
+        }
+        return shader;
+    }
+    catch (Exception&)
+    {
+        // Treat invalid cache entries as misses.
+        return nullptr;
+    }
+}
+
+void ShaderCache::save(const string& key, const Shader& shader) const
+{
+    ScopedFloatFormatting fmt(Value::FloatFormatDefault, SHADER_CACHE_FLOAT_PRECISION);
+
+    CacheWriter writer;
+    writer.writeString(SHADER_CACHE_MAGIC);
+    writer.writeUInt32(SHADER_CACHE_FORMAT_VERSION);
+    writer.writeString(key);
+
+    writer.writeString(shader.getName());
+    writer.writeUInt32(shader.getGraph()._classification);
+
+    std::map<string, ValuePtr> sortedAttributes(shader._attributeMap.begin(), shader._attributeMap.end());
+    writer.writeUInt32((uint32_t) sortedAttributes.size());
+    for (const auto& pair : sortedAttributes)
+    {
+        writer.writeString(pair.first);
+        writer.writeValue(pair.second);
+    }
+
+    writer.writeUInt32((uint32_t) shader.numStages());
+    for (size_t i = 0; i < shader.numStages(); i++)
+    {
+        const ShaderStage& stage = shader.getStage(i);
+        writer.writeString(stage.getName());
+        writer.writeString(stage.getFunctionName());
+        writer.writeString(stage.getSourceCode());
+        writer.writeBlock(stage.getConstantBlock());
+        writer.writeBlocks(stage.getUniformBlocks());
+        writer.writeBlocks(stage.getInputBlocks());
+        writer.writeBlocks(stage.getOutputBlocks());
+    }
+
+    // Replace any existing entry in a single step, so that concurrent readers
+    // in any process observe either the previous or the new shader, and never
+    // a partially written one.
+    FilePath path = getShaderPath(key);
+    if (!writeFile(path, writer.getBuffer()))
+    {
+        throw ExceptionShaderGenError("Failed to write cached shader: " + path.asString());
+    }
+}
+
+ShaderCache::SourceFileEntryPtr ShaderCache::getSourceFile(const FilePath& path, const Syntax& syntax)
+{
+    // The source file cache validates the file against its modification
+    // time, and returns the same contents while it is unchanged.
+    SourceFilePtr file = SourceFileCache::get().getFile(path);
+    {
+        std::lock_guard<std::mutex> lock(_sourceFileMutex);
+        auto it = _sourceFiles.find(path.asString());
+        if (it != _sourceFiles.end() && it->second->file == file)
+        {
+            return it->second;
+        }
+    }
+
+    std::shared_ptr<SourceFile> sourceFile = std::make_shared<SourceFile>();
+    sourceFile->file = file;
+    if (file)
+    {
+        sourceFile->hash = toHexString(file->getHash());
+
+        // Find include statements, following the conventions of ShaderStage::addBlock.
+        const string& INCLUDE = syntax.getIncludeStatement();
+        const string& QUOTE = syntax.getStringQuote();
+        for (const string& line : file->getLines())
+        {
+            if (line.find(INCLUDE) == string::npos)
+            {
+                continue;
+            }
+            size_t startQuote = line.find_first_of(QUOTE);
+            size_t endQuote = line.find_last_of(QUOTE);
+            if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote + 1)
+            {
+                sourceFile->includes.push_back(line.substr(startQuote + 1, endQuote - startQuote - 1));
+            }
+        }
+    }
+    else
+    {
+        sourceFile->hash = toHexString(computeContentHash(EMPTY_STRING));
+    }
+
+    std::lock_guard<std::mutex> lock(_sourceFileMutex);
+    _sourceFiles[path.asString()] = sourceFile;
+    return sourceFile;
+}
+
+FilePath ShaderCache::getShaderPath(const string& key) const
+{
+    return _directory / FilePath(key + "." + SHADER_CACHE_EXTENSION);
+}
+
+} // namespace MaterialX
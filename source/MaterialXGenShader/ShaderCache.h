@@ -0,0 +1,126 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_SHADERCACHE_H
+#define MATERIALX_SHADERCACHE_H
+
+/// @file
+/// Persistent cache of generated shaders
+
+#include <MaterialXGenShader/Export.h>
+
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
+
+#include <MaterialXFormat/File.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace MaterialX
+{
+
+/// A shared pointer to a ShaderCache
+using ShaderCachePtr = shared_ptr<class ShaderCache>;
+
+/// @class ShaderCache
+/// A persistent, content-addressed cache of generated shaders.
+///
+/// Each shader is stored on disk under a key computed from the content that
+/// determines its generated code: the upstream subgraph of the element, the
+/// nodedefs and implementations it resolves to, the source files referenced
+/// by those implementations, the generation options, and the target and
+/// version of the shader generator.  A cache hit restores the shader with
+/// its stages, source code, variable blocks and attributes, without creating
+/// a shader graph or emitting any code.
+///
+/// Restored shaders hold an empty shader graph with the classification of
+/// the original, so clients that inspect the graph of a generated shader
+/// should generate it directly.
+class MX_GENSHADER_API ShaderCache
+{
+  public:
+    /// Constructor, taking the directory in which shaders are stored.
+    /// The directory is created if it does not already exist.
+    ShaderCache(const FilePath& directory);
+
+    /// Create a new shader cache stored in the given directory.
+    static ShaderCachePtr create(const FilePath& directory)
+    {
+        return std::make_shared<ShaderCache>(directory);
+    }
+
+    /// Return the directory in which shaders are stored.
+    const FilePath& getDirectory() const
+    {
+        return _directory;
+    }
+
+    /// Generate a shader starting from the given element, returning a cached
+    /// shader when one is available.  On a cache miss the shader is generated
+    /// by the context's shader generator and stored in the cache.
+    ShaderPtr generate(const string& name, ElementPtr element, GenContext& context);
+
+    /// Compute the key under which a shader for the given element is stored.
+    string computeKey(const string& name, ElementPtr element, GenContext& context);
+
+    /// Compute a key for the state of a generation context that determines
+    /// generated code: the shader generator and its target, color management
+    /// and unit systems, the generation options, reserved words, bound light
+    /// shaders, registered metadata and resource binding context.
+    static string computeContextKey(GenContext& context);
+
+    /// Return the shader stored under the given key, or nullptr if no valid
+    /// shader is found.
+    ShaderPtr load(const string& key, ElementPtr element, GenContext& context) const;
+
+    /// Store a shader under the given key.
+    /// @throws ExceptionShaderGenError if the shader cannot be written.
+    void save(const string& key, const Shader& shader) const;
+
+    /// Return the number of shaders restored from the cache.
+    size_t getHitCount() const
+    {
+        return _hitCount;
+    }
+
+    /// Return the number of shaders generated due to cache misses.
+    size_t getMissCount() const
+    {
+        return _missCount;
+    }
+
+  protected:
+    // The content hash of a source file, and the include files that it
+    // references, computed from the given file contents.
+    struct SourceFile
+    {
+        SourceFilePtr file;
+        string hash;
+        StringVec includes;
+    };
+    using SourceFileEntryPtr = shared_ptr<const SourceFile>;
+
+    // Return the content hash and includes of the given source file.  These
+    // are computed again whenever the source file cache returns new contents
+    // for the file.
+    SourceFileEntryPtr getSourceFile(const FilePath& path, const Syntax& syntax);
+
+    // Return the path at which the shader with the given key is stored.
+    FilePath getShaderPath(const string& key) const;
+
+  protected:
+    FilePath _directory;
+
+    std::unordered_map<string, SourceFileEntryPtr> _sourceFiles;
+    std::mutex _sourceFileMutex;
+
+    std::atomic<size_t> _hitCount;
+    std::atomic<size_t> _missCount;
+};
+
+} // namespace MaterialX
+
+#endif
@@ -7,6 +7,7 @@
 
 #include <MaterialXGenShader/GenContext.h>
 #include <MaterialXGenShader/ShaderNodeImpl.h>
+#include <MaterialXGenShader/SourceFileCache.h>
 #include <MaterialXGenShader/Nodes/CompoundNode.h>
 #include <MaterialXGenShader/Nodes/SourceCodeNode.h>
 #include <MaterialXGenShader/Nodes/LayerNode.h>
@@ -20,6 +21,7 @@
 #include <MaterialXCore/Value.h>
 
 #include <sstream>
+#include <typeinfo>
 
 namespace MaterialX
 {
@@ -80,6 +82,11 @@ void ShaderGenerator::emitBlock(const string& str, GenContext& context, ShaderSt
     stage.addBlock(str, context);
 }
 
+void ShaderGenerator::emitSourceFile(const SourceFilePtr& file, GenContext& context, ShaderStage& stage) const
+{
+    stage.addSourceFile(file, context);
+}
+
 void ShaderGenerator::emitInclude(const string& file, GenContext& context, ShaderStage& stage) const
 {
     stage.addInclude(file, context);
@@ -108,7 +115,9 @@ void ShaderGenerator::emitFunctionCall(const ShaderNode& node, GenContext& conte
     }
 
     // Emit the function call.
-    node.getImplementation().emitFunctionCall(node, context, stage);
+    const ShaderNodeImpl& impl = node.getImplementation();
+    ScopedGenTimer timer(context.getProfiler().get(), impl.getName(), GenProfiler::IMPLEMENTATION);
+    impl.emitFunctionCall(node, context, stage);
 }
 
 void ShaderGenerator::emitFunctionDefinitions(const ShaderGraph& graph, GenContext& context, ShaderStage& stage) const
@@ -252,6 +261,61 @@ bool ShaderGenerator::implementationRegistered(const string& name) const
     return _implFactory.classRegistered(name);
 }
 
+namespace
+{
+    uint64_t hashString(const string& str, uint64_t seed)
+    {
+        const uint64_t size = str.size();
+        seed = computeContentHash(reinterpret_cast<const char*>(&size), sizeof(size), seed);
+        return computeContentHash(str, seed);
+    }
+
+    // Hash the category, name, attributes and children of an element.
+    uint64_t hashElement(const Element& element, uint64_t seed)
+    {
+        seed = hashString(element.getCategory(), seed);
+        seed = hashString(element.getName(), seed);
+        for (const string& attrName : element.getAttributeNames())
+        {
+            seed = hashString(attrName, seed);
+            seed = hashString(element.getAttribute(attrName), seed);
+        }
+        for (const ElementPtr& child : element.getChildren())
+        {
+            seed = hashElement(*child, seed);
+        }
+        return hashString(EMPTY_STRING, seed);
+    }
+
+    // Hash the content from which an implementation is initialized: the
+    // implementation or nodegraph element, its nodedef, and the contents of
+    // its source file.
+    uint64_t hashImplementationContent(const InterfaceElement& element, GenContext& context)
+    {
+        uint64_t hash = hashElement(element, computeContentHash(EMPTY_STRING));
+        ConstNodeDefPtr nodeDef;
+        if (element.isA<NodeGraph>())
+        {
+            nodeDef = static_cast<const NodeGraph&>(element).getNodeDef();
+        }
+        else if (element.isA<Implementation>())
+        {
+            const Implementation& impl = static_cast<const Implementation&>(element);
+            nodeDef = impl.getNodeDef();
+            if (impl.hasFile())
+            {
+                SourceFilePtr file = SourceFileCache::get().getFile(context.resolveSourceFile(impl.getFile()));
+                hash = computeContentHash(std::to_string(file ? file->getHash() : 0), hash);
+            }
+        }
+        if (nodeDef)
+        {
+            hash = hashElement(*nodeDef, hash);
+        }
+        return hash;
+    }
+}
+
 ShaderNodeImplPtr ShaderGenerator::getImplementation(const InterfaceElement& element, GenContext& context) const
 {
     const string& name = element.getName();
@@ -263,26 +327,58 @@ ShaderNodeImplPtr ShaderGenerator::getImplementation(const InterfaceElement& ele
         return impl;
     }
 
-    if (element.isA<NodeGraph>())
-    {
-        // Use a compound implementation.
-        impl = createCompoundImplementation(static_cast<const NodeGraph&>(element));
-    }
-    else if (element.isA<Implementation>())
+    auto createImplementation = [this, &element, &name, &context]()
     {
-        // Try creating a new in the factory.
-        impl = _implFactory.create(name);
-        if (!impl)
+        ShaderNodeImplPtr newImpl;
+        if (element.isA<NodeGraph>())
+        {
+            // Use a compound implementation.
+            newImpl = createCompoundImplementation(static_cast<const NodeGraph&>(element));
+        }
+        else if (element.isA<Implementation>())
+        {
+            // Try creating a new in the factory.
+            newImpl = _implFactory.create(name);
+            if (!newImpl)
+            {
+                // Fall back to the source code implementation.
+                newImpl = createSourceCodeImplementation(static_cast<const Implementation&>(element));
+            }
+        }
+        else
         {
-            // Fall back to the source code implementation.
-            impl = createSourceCodeImplementation(static_cast<const Implementation&>(element));
+            throw ExceptionShaderGenError("Element '" + name + "' is neither an Implementation nor an NodeGraph");
         }
+        newImpl->initialize(element, context);
+        return newImpl;
+    };
+
+    // Use the shared cache if one is given and this generator shares its
+    // implementations, keyed by the generator, the content of the element
+    // and the context state that affects initialization.
+    ShaderNodeImplCachePtr sharedCache = sharesNodeImplementations() ? context.getShaderNodeImplCache() : nullptr;
+    if (sharedCache)
+    {
+        const GenOptions& options = context.getOptions();
+        const string key = string(typeid(*this).name()) + "|" +
+                           getTarget() + "|" +
+                           name + "|" +
+                           element.getActiveSourceUri() + "|" +
+                           std::to_string(hashImplementationContent(element, context)) + "|" +
+                           element.getDocument()->getActiveColorSpace() + "|" +
+                           (_colorManagementSystem ? _colorManagementSystem->getName() : EMPTY_STRING) + "|" +
+                           (_unitSystem ? _unitSystem->getName() : EMPTY_STRING) + "|" +
+                           options.targetColorSpaceOverride + "|" +
+                           options.targetDistanceUnit + "|" +
+                           std::to_string(options.addUpstreamDependencies) + "|" +
+                           std::to_string(options.optimizationLevel) + "|" +
+                           context.getSourceCodeSearchPath().asString();
+        impl = sharedCache->findOrCreate(key, createImplementation);
     }
     else
     {
-        throw ExceptionShaderGenError("Element '" + name + "' is neither an Implementation nor an NodeGraph");
+        impl = createImplementation();
     }
-    impl->initialize(element, context);
 
     // Cache it.
     context.addNodeImplementation(name, impl);
@@ -292,14 +388,20 @@ ShaderNodeImplPtr ShaderGenerator::getImplementation(const InterfaceElement& ele
 
 namespace
 {
-    void replace(const StringMap& substitutions, ShaderPort* port)
+    void replace(const TokenSubstitutor& substitutor, ShaderPort* port)
     {
+        // Only assign changed strings.  Ports in shader stages are owned by
+        // their shader, and are never shared with node implementations.
         string name = port->getName();
-        tokenSubstitution(substitutions, name);
-        port->setName(name);
+        if (substitutor.substitute(name))
+        {
+            port->setName(name);
+        }
         string variable = port->getVariable();
-        tokenSubstitution(substitutions, variable);
-        port->setVariable(variable);
+        if (substitutor.substitute(variable))
+        {
+            port->setVariable(variable);
+        }
     }
 }
 
@@ -349,20 +451,29 @@ void ShaderGenerator::registerShaderMetadata(const DocumentPtr& doc, GenContext&
 
 void ShaderGenerator::replaceTokens(const StringMap& substitutions, ShaderStage& stage) const
 {
-    // Replace tokens in source code
-    tokenSubstitution(substitutions, stage._code);
+    // The substitutor is local to each call, so that concurrent calls on a
+    // shared generator do not modify shared state.
+    const TokenSubstitutor substitutor(substitutions);
+
+    // Replace tokens in source code, skipping the code emitted
+    // before the first token.
+    if (stage._tokenOffset != string::npos)
+    {
+        substitutor.substitute(stage._code.str(), stage._tokenOffset);
+        stage._tokenOffset = string::npos;
+    }
 
     // Replace tokens on shader interface
     for (size_t i = 0; i < stage._constants.size(); ++i)
     {
-        replace(substitutions, stage._constants[i]);
+        replace(substitutor, stage._constants[i]);
     }
     for (const auto& it : stage._uniforms)
     {
         VariableBlock& uniforms = *it.second;
         for (size_t i = 0; i < uniforms.size(); ++i)
         {
-            replace(substitutions, uniforms[i]);
+            replace(substitutor, uniforms[i]);
         }
     }
     for (const auto& it : stage._inputs)
@@ -370,7 +481,7 @@ void ShaderGenerator::replaceTokens(const StringMap& substitutions, ShaderStage&
         VariableBlock& inputs = *it.second;
         for (size_t i = 0; i < inputs.size(); ++i)
         {
-            replace(substitutions, inputs[i]);
+            replace(substitutor, inputs[i]);
         }
     }
     for (const auto& it : stage._outputs)
@@ -378,7 +489,7 @@ void ShaderGenerator::replaceTokens(const StringMap& substitutions, ShaderStage&
         VariableBlock& outputs = *it.second;
         for (size_t i = 0; i < outputs.size(); ++i)
         {
-            replace(substitutions, outputs[i]);
+            replace(substitutor, outputs[i]);
         }
     }
 }
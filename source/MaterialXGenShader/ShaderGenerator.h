@@ -66,6 +66,10 @@ class MX_GENSHADER_API ShaderGenerator
     /// Add a block of code.
     virtual void emitBlock(const string& str, GenContext& context, ShaderStage& stage) const;
 
+    /// Add the contents of a cached source file, referencing the file
+    /// contents in place where possible.
+    virtual void emitSourceFile(const SourceFilePtr& file, GenContext& context, ShaderStage& stage) const;
+
     /// Add the contents of an include file. Making sure it is 
     /// only included once for the shader stage.
     virtual void emitInclude(const string& file, GenContext& context, ShaderStage& stage) const;
@@ -162,6 +166,16 @@ class MX_GENSHADER_API ShaderGenerator
     /// will be returned, as defined by the createDefaultImplementation method.
     ShaderNodeImplPtr getImplementation(const InterfaceElement& element, GenContext& context) const;
 
+    /// Return true if node implementations created by this generator may be
+    /// shared between generation calls and contexts through the shared
+    /// implementation cache of a context.  Generators that edit their node
+    /// implementations for each shader return false, and bypass any shared
+    /// cache without removing it from the context.
+    virtual bool sharesNodeImplementations() const
+    {
+        return true;
+    }
+
     /// Return the map of token substitutions used by the generator.
     const StringMap& getTokenSubstitutions() const
     {
@@ -220,6 +234,7 @@ class MX_GENSHADER_API ShaderGenerator
     mutable StringMap _tokenSubstitutions;
 
     friend ShaderGraph;
+    friend class ShaderCache;
 };
 
 /// @class ExceptionShaderGenError
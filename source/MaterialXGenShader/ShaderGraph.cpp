@@ -9,12 +9,26 @@
 #include <MaterialXGenShader/ShaderGenerator.h>
 #include <MaterialXGenShader/Util.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
 #include <queue>
 
 namespace MaterialX
 {
 
+namespace
+{
+
+const string PHASE_CREATE = "ShaderGraph::create";
+const string PHASE_CREATE_NODE = "ShaderGraph::createNode";
+const string PHASE_FINALIZE = "ShaderGraph::finalize";
+const string PHASE_OPTIMIZE = "ShaderGraph::optimize";
+const string PHASE_SET_VARIABLE_NAMES = "ShaderGraph::setVariableNames";
+
+} // anonymous namespace
+
 //
 // ShaderGraph methods
 //
@@ -391,6 +405,8 @@ void ShaderGraph::addUnitTransformNode(ShaderOutput* output, const UnitTransform
 
 ShaderGraphPtr ShaderGraph::create(const ShaderGraph* parent, const NodeGraph& nodeGraph, GenContext& context)
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_CREATE);
+
     NodeDefPtr nodeDef = nodeGraph.getNodeDef();
     if (!nodeDef)
     {
@@ -576,6 +592,8 @@ ShaderGraphPtr ShaderGraph::createSurfaceShader(
 
 ShaderGraphPtr ShaderGraph::create(const ShaderGraph* parent, const string& name, ElementPtr element, GenContext& context)
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_CREATE);
+
     ShaderGraphPtr graph;
     ElementPtr root;
 
@@ -752,6 +770,8 @@ ShaderGraphPtr ShaderGraph::create(const ShaderGraph* parent, const string& name
 
 ShaderNode* ShaderGraph::createNode(const Node& node, GenContext& context)
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_CREATE_NODE);
+
     NodeDefPtr nodeDef = node.getNodeDef();
     if (!nodeDef)
     {
@@ -872,6 +892,8 @@ const ShaderNode* ShaderGraph::getNode(const string& name) const
 
 void ShaderGraph::finalize(GenContext& context)
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_FINALIZE);
+
     // Insert color transformation nodes where needed
     for (const auto& it : _inputColorTransformMap)
     {
@@ -1026,8 +1048,321 @@ void ShaderGraph::disconnect(ShaderNode* node) const
     }
 }
 
+namespace
+{
+    using FloatVec = vector<float>;
+
+    template <class T> void appendVectorComponents(const Value& value, FloatVec& components)
+    {
+        const T& vec = value.asA<T>();
+        for (size_t i = 0; i < T::numElements(); i++)
+        {
+            components.push_back(vec[i]);
+        }
+    }
+
+    // Return the components of a numeric value as floats.
+    bool getComponents(const ValuePtr& value, FloatVec& components)
+    {
+        components.clear();
+        if (!value)
+        {
+            return false;
+        }
+        if (value->isA<float>())
+        {
+            components.push_back(value->asA<float>());
+        }
+        else if (value->isA<int>())
+        {
+            components.push_back(float(value->asA<int>()));
+        }
+        else if (value->isA<bool>())
+        {
+            components.push_back(value->asA<bool>() ? 1.0f : 0.0f);
+        }
+        else if (value->isA<Color3>())
+        {
+            appendVectorComponents<Color3>(*value, components);
+        }
+        else if (value->isA<Color4>())
+        {
+            appendVectorComponents<Color4>(*value, components);
+        }
+        else if (value->isA<Vector2>())
+        {
+            appendVectorComponents<Vector2>(*value, components);
+        }
+        else if (value->isA<Vector3>())
+        {
+            appendVectorComponents<Vector3>(*value, components);
+        }
+        else if (value->isA<Vector4>())
+        {
+            appendVectorComponents<Vector4>(*value, components);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // Create a value of the given float-based type from its components.
+    ValuePtr createValue(const TypeDesc* type, const FloatVec& c)
+    {
+        if (c.size() != type->getSize())
+        {
+            return nullptr;
+        }
+        if (type == Type::FLOAT)
+        {
+            return Value::createValue<float>(c[0]);
+        }
+        if (type == Type::COLOR3)
+        {
+            return Value::createValue<Color3>(Color3(c[0], c[1], c[2]));
+        }
+        if (type == Type::COLOR4)
+        {
+            return Value::createValue<Color4>(Color4(c[0], c[1], c[2], c[3]));
+        }
+        if (type == Type::VECTOR2)
+        {
+            return Value::createValue<Vector2>(Vector2(c[0], c[1]));
+        }
+        if (type == Type::VECTOR3)
+        {
+            return Value::createValue<Vector3>(Vector3(c[0], c[1], c[2]));
+        }
+        if (type == Type::VECTOR4)
+        {
+            return Value::createValue<Vector4>(Vector4(c[0], c[1], c[2], c[3]));
+        }
+        return nullptr;
+    }
+
+    // Apply a channel pattern to the components of a value of the given type.
+    bool swizzleComponents(const FloatVec& components, const TypeDesc* type, const string& channels, FloatVec& result)
+    {
+        result.clear();
+        for (char ch : channels)
+        {
+            if (ch == '0' || ch == '1')
+            {
+                result.push_back(ch == '0' ? 0.0f : 1.0f);
+                continue;
+            }
+            const int index = components.size() == 1 ? 0 : type->getChannelIndex(ch);
+            if (index < 0 || index >= int(components.size()))
+            {
+                return false;
+            }
+            result.push_back(components[index]);
+        }
+        return true;
+    }
+
+    // Evaluate a standard library math node whose inputs all have constant values.
+    // Returns false if the node category is not supported, or if the result
+    // would differ from the generated code, e.g. for a division by zero.
+    bool evaluateNode(const ShaderNode& node, FloatVec& result)
+    {
+        const string& category = node.getCategory();
+        const size_t size = node.getOutput()->getType()->getSize();
+
+        std::unordered_map<string, FloatVec> inputs;
+        for (const ShaderInput* input : node.getInputs())
+        {
+            if (input->getType()->getBaseType() != TypeDesc::BASETYPE_STRING &&
+                !getComponents(input->getValue(), inputs[input->getName()]))
+            {
+                return false;
+            }
+        }
+        auto getInput = [&inputs](const string& name) -> const FloatVec*
+        {
+            auto it = inputs.find(name);
+            return it != inputs.end() ? &it->second : nullptr;
+        };
+
+        // Evaluate a component-wise operation, broadcasting scalar inputs.
+        auto evaluate = [size, &result](const vector<const FloatVec*>& args,
+                                        const std::function<bool(const FloatVec&, float&)>& op) -> bool
+        {
+            for (const FloatVec* arg : args)
+            {
+                if (!arg || (arg->size() != 1 && arg->size() != size))
+                {
+                    return false;
+                }
+            }
+            result.resize(size);
+            FloatVec values(args.size());
+            for (size_t i = 0; i < size; i++)
+            {
+                for (size_t j = 0; j < args.size(); j++)
+                {
+                    values[j] = args[j]->size() == 1 ? (*args[j])[0] : (*args[j])[i];
+                }
+                if (!op(values, result[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        auto unary = [&](const std::function<bool(float, float&)>& op) -> bool
+        {
+            return evaluate({ getInput("in") }, [&op](const FloatVec& v, float& r) { return op(v[0], r); });
+        };
+        auto binary = [&](const std::function<bool(float, float, float&)>& op) -> bool
+        {
+            return evaluate({ getInput("in1"), getInput("in2") }, [&op](const FloatVec& v, float& r) { return op(v[0], v[1], r); });
+        };
+
+        if (category == "add")
+        {
+            return binary([](float a, float b, float& r) { r = a + b; return true; });
+        }
+        if (category == "subtract")
+        {
+            return binary([](float a, float b, float& r) { r = a - b; return true; });
+        }
+        if (category == "multiply")
+        {
+            return binary([](float a, float b, float& r) { r = a * b; return true; });
+        }
+        if (category == "divide")
+        {
+            return binary([](float a, float b, float& r) { r = a / b; return b != 0.0f; });
+        }
+        if (category == "modulo")
+        {
+            return binary([](float a, float b, float& r) { r = a - b * std::floor(a / b); return b != 0.0f; });
+        }
+        if (category == "power")
+        {
+            return binary([](float a, float b, float& r) { r = std::pow(a, b); return a > 0.0f || (a == 0.0f && b > 0.0f); });
+        }
+        if (category == "min")
+        {
+            return binary([](float a, float b, float& r) { r = std::min(a, b); return true; });
+        }
+        if (category == "max")
+        {
+            return binary([](float a, float b, float& r) { r = std::max(a, b); return true; });
+        }
+        if (category == "absval")
+        {
+            return unary([](float a, float& r) { r = std::abs(a); return true; });
+        }
+        if (category == "floor")
+        {
+            return unary([](float a, float& r) { r = std::floor(a); return true; });
+        }
+        if (category == "ceil")
+        {
+            return unary([](float a, float& r) { r = std::ceil(a); return true; });
+        }
+        if (category == "sqrt")
+        {
+            return unary([](float a, float& r) { r = std::sqrt(a); return a >= 0.0f; });
+        }
+        if (category == "invert")
+        {
+            return evaluate({ getInput("in"), getInput("amount") },
+                            [](const FloatVec& v, float& r) { r = v[1] - v[0]; return true; });
+        }
+        if (category == "clamp")
+        {
+            return evaluate({ getInput("in"), getInput("low"), getInput("high") },
+                            [](const FloatVec& v, float& r) { r = std::min(std::max(v[0], v[1]), v[2]); return true; });
+        }
+        if (category == "mix")
+        {
+            return evaluate({ getInput("fg"), getInput("bg"), getInput("mix") },
+                            [](const FloatVec& v, float& r) { r = v[1] + (v[0] - v[1]) * v[2]; return true; });
+        }
+        if (category == "dotproduct")
+        {
+            const FloatVec* in1 = getInput("in1");
+            const FloatVec* in2 = getInput("in2");
+            if (!in1 || !in2 || in1->size() != in2->size() || size != 1)
+            {
+                return false;
+            }
+            result.assign(1, 0.0f);
+            for (size_t i = 0; i < in1->size(); i++)
+            {
+                result[0] += (*in1)[i] * (*in2)[i];
+            }
+            return true;
+        }
+        if (category == "extract")
+        {
+            const FloatVec* in = getInput("in");
+            const FloatVec* index = getInput("index");
+            if (!in || !index || (*index)[0] < 0.0f || size_t((*index)[0]) >= in->size())
+            {
+                return false;
+            }
+            result.assign(1, (*in)[size_t((*index)[0])]);
+            return true;
+        }
+        if (category == "combine2" || category == "combine3" || category == "combine4")
+        {
+            result.clear();
+            for (const char* name : { "in1", "in2", "in3", "in4" })
+            {
+                const FloatVec* in = getInput(name);
+                if (in)
+                {
+                    result.insert(result.end(), in->begin(), in->end());
+                }
+            }
+            return result.size() == size;
+        }
+        if (category == "convert")
+        {
+            // Scalars are broadcast, and vectors are truncated or extended
+            // following the conversion patterns of the convert node.
+            const FloatVec* in = getInput("in");
+            if (!in)
+            {
+                return false;
+            }
+            result.resize(size);
+            for (size_t i = 0; i < size; i++)
+            {
+                result[i] = in->size() == 1 ? (*in)[0] : (i < in->size() ? (*in)[i] : (i == 3 ? 1.0f : 0.0f));
+            }
+            return true;
+        }
+        if (category == "swizzle")
+        {
+            const ShaderInput* in = node.getInput("in");
+            const ShaderInput* channels = node.getInput("channels");
+            if (!in || !channels || !channels->getValue())
+            {
+                return false;
+            }
+            return swizzleComponents(*getInput("in"), in->getType(), channels->getValue()->getValueString(), result) &&
+                   result.size() == size;
+        }
+        return false;
+    }
+}
+
 void ShaderGraph::optimize(GenContext& context)
 {
+    GenProfiler* profiler = context.getProfiler().get();
+    ScopedGenTimer timer(profiler, PHASE_OPTIMIZE);
+    if (profiler)
+    {
+        profiler->addCounter(GenProfiler::NODES_BEFORE_OPTIMIZATION, _nodeOrder.size());
+    }
+
     size_t numEdits = 0;
     for (ShaderNode* node : getNodes())
     {
@@ -1080,6 +1415,15 @@ void ShaderGraph::optimize(GenContext& context)
         }
     }
 
+    if (context.getOptions().optimizationLevel >= SHADER_OPTIMIZATION_FULL)
+    {
+        // Sort the nodes so that upstream nodes are evaluated and merged
+        // before the nodes that depend on them.
+        topologicalSort();
+        numEdits += foldConstantNodes();
+        numEdits += mergeDuplicateNodes();
+    }
+
     if (numEdits > 0)
     {
         std::set<ShaderNode*> usedNodes;
@@ -1096,7 +1440,9 @@ void ShaderGraph::optimize(GenContext& context)
             }
         }
 
-        // Remove any unused nodes
+        // Remove any unused nodes, preserving the order of those remaining.
+        vector<ShaderNode*> nodeOrder;
+        nodeOrder.reserve(usedNodes.size());
         for (ShaderNode* node : _nodeOrder)
         {
             if (usedNodes.count(node) == 0)
@@ -1107,13 +1453,157 @@ void ShaderGraph::optimize(GenContext& context)
                 // Erase from storage
                 _nodeMap.erase(node->getName());
             }
+            else
+            {
+                nodeOrder.push_back(node);
+            }
         }
 
-        _nodeOrder.resize(usedNodes.size());
-        _nodeOrder.assign(usedNodes.begin(), usedNodes.end());
+        _nodeOrder.swap(nodeOrder);
+    }
+
+    if (profiler)
+    {
+        profiler->addCounter(GenProfiler::NODES_AFTER_OPTIMIZATION, _nodeOrder.size());
     }
 }
 
+size_t ShaderGraph::foldConstantNodes()
+{
+    size_t numFolded = 0;
+    FloatVec result;
+    FloatVec swizzled;
+    for (ShaderNode* node : _nodeOrder)
+    {
+        // Only nodes with standard library definitions are evaluated, since
+        // other nodedefs may give a standard node string different behavior.
+        if (!node->hasClassification(ShaderNode::Classification::TEXTURE) || node->numOutputs() != 1 ||
+            !node->getFlag(ShaderNodeFlag::STANDARD_DEFINITION))
+        {
+            continue;
+        }
+        ShaderOutput* output = node->getOutput();
+        if (output->getConnections().empty() || output->getType()->getBaseType() != TypeDesc::BASETYPE_FLOAT)
+        {
+            continue;
+        }
+
+        // Only nodes with constant values on all inputs can be evaluated.
+        bool constantInputs = true;
+        for (const ShaderInput* input : node->getInputs())
+        {
+            if (input->getConnection() || !input->getValue() || !input->getChannels().empty())
+            {
+                constantInputs = false;
+                break;
+            }
+        }
+        if (!constantInputs || !evaluateNode(*node, result))
+        {
+            continue;
+        }
+        ValuePtr value = createValue(output->getType(), result);
+        if (!value)
+        {
+            continue;
+        }
+
+        // Assign the result to the downstream inputs, swizzling it where needed.
+        // Iterate a copy of the connection set since the
+        // original set will change when breaking connections.
+        ShaderInputSet downstreamConnections = output->getConnections();
+        for (ShaderInput* downstream : downstreamConnections)
+        {
+            output->breakConnection(downstream);
+            const string& channels = downstream->getChannels();
+            if (channels.empty())
+            {
+                downstream->setValue(value);
+            }
+            else
+            {
+                ValuePtr swizzledValue = swizzleComponents(result, output->getType(), channels, swizzled) ?
+                                         createValue(downstream->getType(), swizzled) : nullptr;
+                if (!swizzledValue)
+                {
+                    throw ExceptionShaderGenError("Invalid channel pattern '" + channels + "' on input '" +
+                                                  downstream->getFullName() + "'.");
+                }
+                downstream->setValue(swizzledValue);
+                downstream->setChannels(EMPTY_STRING);
+            }
+        }
+        ++numFolded;
+    }
+    return numFolded;
+}
+
+size_t ShaderGraph::mergeDuplicateNodes()
+{
+    size_t numMerged = 0;
+    std::unordered_map<string, ShaderNode*> uniqueNodes;
+    for (ShaderNode* node : _nodeOrder)
+    {
+        // Closures and shaders depend on their context of use,
+        // so only texture nodes are considered.
+        if (!node->hasClassification(ShaderNode::Classification::TEXTURE) || node->getCategory().empty())
+        {
+            continue;
+        }
+        bool used = false;
+        for (const ShaderOutput* output : node->getOutputs())
+        {
+            used = used || !output->getConnections().empty();
+        }
+        if (!used)
+        {
+            continue;
+        }
+
+        // Describe the node by its definition and the sources of its inputs.
+        // Since nodes are visited in topological order, duplicate upstream
+        // nodes have already been merged when their outputs are compared.
+        string key = node->getCategory() + "|" + std::to_string(reinterpret_cast<uintptr_t>(&node->getImplementation()));
+        for (const ShaderOutput* output : node->getOutputs())
+        {
+            key += "|" + output->getType()->getName();
+        }
+        for (const ShaderInput* input : node->getInputs())
+        {
+            key += "|" + input->getName() + ":" + input->getType()->getName() + ":" + input->getChannels() + ":" + input->getUnit() + ":";
+            if (input->getConnection())
+            {
+                key += "@" + std::to_string(reinterpret_cast<uintptr_t>(input->getConnection()));
+            }
+            else if (input->getValue())
+            {
+                key += "=" + input->getValue()->getValueString();
+            }
+        }
+
+        auto it = uniqueNodes.emplace(key, node);
+        if (it.second)
+        {
+            continue;
+        }
+
+        // Reroute the downstream connections to the identical node.
+        ShaderNode* uniqueNode = it.first->second;
+        for (size_t i = 0; i < node->numOutputs(); i++)
+        {
+            ShaderOutput* output = node->getOutput(i);
+            ShaderInputSet downstreamConnections = output->getConnections();
+            for (ShaderInput* downstream : downstreamConnections)
+            {
+                output->breakConnection(downstream);
+                downstream->makeConnection(uniqueNode->getOutput(i));
+            }
+        }
+        ++numMerged;
+    }
+    return numMerged;
+}
+
 void ShaderGraph::bypass(GenContext& context, ShaderNode* node, size_t inputIndex, size_t outputIndex)
 {
     ShaderInput* input = node->getInput(inputIndex);
@@ -1169,13 +1659,21 @@ void ShaderGraph::bypass(GenContext& context, ShaderNode* node, size_t inputInde
 void ShaderGraph::topologicalSort()
 {
     // Calculate a topological order of the children, using Kahn's algorithm
-    // to avoid recursion.
+    // to avoid recursion.  Nodes that are ready at the same time are ordered
+    // by name, so the result depends only on the graph itself and not on the
+    // order in which nodes were added or stored.
     //
-    // Running time: O(numNodes + numEdges).
+    // Running time: O((numNodes + numEdges) * log(numNodes)).
+
+    auto compareNames = [](const ShaderNode* a, const ShaderNode* b)
+    {
+        return a->getName() > b->getName();
+    };
+    using NodeQueue = std::priority_queue<ShaderNode*, vector<ShaderNode*>, decltype(compareNames)>;
 
     // Calculate in-degrees for all nodes, and enqueue those with degree 0.
     std::unordered_map<ShaderNode*, int> inDegree(_nodeMap.size());
-    std::deque<ShaderNode*> nodeQueue;
+    NodeQueue nodeQueue(compareNames);
     for (const auto& it : _nodeMap)
     {
         ShaderNode* node = it.second.get();
@@ -1193,7 +1691,7 @@ void ShaderGraph::topologicalSort()
 
         if (connectionCount == 0)
         {
-            nodeQueue.push_back(node);
+            nodeQueue.push(node);
         }
     }
 
@@ -1203,8 +1701,8 @@ void ShaderGraph::topologicalSort()
     while (!nodeQueue.empty())
     {
         // Pop the queue and add to topological order.
-        ShaderNode* node = nodeQueue.front();
-        nodeQueue.pop_front();
+        ShaderNode* node = nodeQueue.top();
+        nodeQueue.pop();
         _nodeOrder[count++] = node;
 
         // Find connected nodes and decrease their in-degree,
@@ -1217,7 +1715,7 @@ void ShaderGraph::topologicalSort()
                 {
                     if (--inDegree[input->getNode()] <= 0)
                     {
-                        nodeQueue.push_back(input->getNode());
+                        nodeQueue.push(input->getNode());
                     }
                 }
             }
@@ -1302,6 +1800,8 @@ void ShaderGraph::calculateScopes()
 
 void ShaderGraph::setVariableNames(GenContext& context)
 {
+    ScopedGenTimer timer(context.getProfiler().get(), PHASE_SET_VARIABLE_NAMES);
+
     // Make sure inputs and outputs have variable names valid for the
     // target shading language, and are unique to avoid name conflicts.
 
@@ -159,6 +159,16 @@ class MX_GENSHADER_API ShaderGraph : public ShaderNode
     /// Optimize the graph, removing redundant paths.
     void optimize(GenContext& context);
 
+    /// Evaluate math nodes whose inputs are all constant, assigning
+    /// their results to downstream inputs.  Nodes must be sorted in
+    /// topological order.  Returns the number of nodes evaluated.
+    size_t foldConstantNodes();
+
+    /// Reroute the downstream connections of nodes that are identical to
+    /// an earlier node with identical inputs.  Nodes must be sorted in
+    /// topological order.  Returns the number of nodes rerouted.
+    size_t mergeDuplicateNodes();
+
     /// Bypass a node for a particular input and output,
     /// effectively connecting the input's upstream connection
     /// with the output's downstream connections.
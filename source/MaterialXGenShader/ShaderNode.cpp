@@ -200,6 +200,11 @@ void ShaderNode::ScopeInfo::merge(const ScopeInfo &fromScope)
 ShaderNodePtr ShaderNode::create(const ShaderGraph* parent, const string& name, const NodeDef& nodeDef, GenContext& context)
 {
     ShaderNodePtr newNode = std::make_shared<ShaderNode>(parent, name);
+    newNode->_category = nodeDef.getNodeString();
+    const string standardPrefix = "ND_" + newNode->_category + "_";
+    const bool standardDefinition = nodeDef.getName().compare(0, standardPrefix.size(), standardPrefix) == 0 &&
+                                    nodeDef.getQualifiedName(nodeDef.getName()) == nodeDef.getName();
+    newNode->setFlag(ShaderNodeFlag::STANDARD_DEFINITION, standardDefinition);
 
     const ShaderGenerator& shadergen = context.getShaderGenerator();
 
@@ -318,6 +318,10 @@ enum class ShaderNodeFlag
 {
     /// Omit the function call for this node.
     EXCLUDE_FUNCTION_CALL = 1 << 0,
+    /// The node is defined by a nodedef following the naming convention of
+    /// the standard library, outside of any namespace, so its behavior is
+    /// given by its node string.
+    STANDARD_DEFINITION = 1 << 1,
 };
 
 /// @class ShaderNode
@@ -438,6 +442,13 @@ class MX_GENSHADER_API ShaderNode
         return _name;
     }
 
+    /// Return the category of the nodedef this node was created from,
+    /// or an empty string if it was created directly from an implementation.
+    const string& getCategory() const
+    {
+        return _category;
+    }
+
     /// Return the implementation used for this node.
     const ShaderNodeImpl& getImplementation() const
     {
@@ -536,6 +547,7 @@ class MX_GENSHADER_API ShaderNode
 
     const ShaderGraph* _parent;
     string _name;
+    string _category;
     uint32_t _classification;
     uint32_t _flags;
 
@@ -551,6 +563,7 @@ class MX_GENSHADER_API ShaderNode
     std::set<const ShaderNode*> _usedClosures;
 
     friend class ShaderGraph;
+    friend class ShaderCache;
 };
 
 } // namespace MaterialX
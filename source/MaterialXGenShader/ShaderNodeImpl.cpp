@@ -31,7 +31,7 @@ void ShaderNodeImpl::initialize(const InterfaceElement& element, GenContext&)
     // Derived classes can override this to create other hashes,
     // e.g. to share the same hash beteen nodes that can share
     // the same function definition.
-    _hash = std::hash<string>{}(_name);
+    _hash = computeContentHash(_name);
 }
 
 void ShaderNodeImpl::addInputs(ShaderNode&, GenContext&) const
@@ -54,7 +54,7 @@ class MX_GENSHADER_API ShaderNodeImpl
     /// The hash should correspond to the function signature generated for the node,
     /// and can be used to compare implementations, e.g. to query if an identical
     /// function has already been emitted during shader generation.
-    size_t getHash() const
+    uint64_t getHash() const
     {
         return _hash;
     }
@@ -103,7 +103,7 @@ class MX_GENSHADER_API ShaderNodeImpl
 
   protected:
     string _name;
-    size_t _hash;
+    uint64_t _hash;
 };
 
 } // namespace MaterialX
@@ -0,0 +1,379 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/ShaderPermutationCache.h>
+
+#include <MaterialXGenShader/ShaderCache.h>
+#include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/TypeDesc.h>
+
+#include <MaterialXFormat/Util.h>
+
+#include <MaterialXCore/Geom.h>
+
+#include <iomanip>
+#include <sstream>
+
+namespace MaterialX
+{
+
+namespace {
+
+// Node groups whose implementations read input values at generation time,
+// so that all of their values are part of the signature.
+const StringSet VALUE_DEPENDENT_NODEGROUPS = { "convolution2d", "application" };
+
+// Tags separating the parts of a signature.
+enum SignatureTag
+{
+    TAG_NODE,
+    TAG_OUTPUT,
+    TAG_INPUT,
+    TAG_CONNECTION,
+    TAG_INTERFACE,
+    TAG_GEOMPROP,
+    TAG_CONSTANT,
+    TAG_VALUE,
+    TAG_NO_VALUE
+};
+
+// The value of an input that is not part of the signature.
+struct InputValue
+{
+    string path;
+    ValuePtr value;
+};
+
+string toHexString(uint64_t value)
+{
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << value;
+    return stream.str();
+}
+
+// Accumulate the topology of the upstream graph of an element, visiting
+// nodes in a canonical order that depends on connections rather than on
+// node names, and collecting input values that are left out of it.
+class SignatureBuilder
+{
+  public:
+    SignatureBuilder(GenContext& context, vector<InputValue>* values) :
+        _context(context),
+        _target(context.getShaderGenerator().getTarget()),
+        _values(values)
+    {
+        addString(ShaderCache::computeContextKey(context));
+    }
+
+    void addElement(ElementPtr element)
+    {
+        ConstDocumentPtr doc = element->getDocument();
+        for (const string& attrName : doc->getAttributeNames())
+        {
+            addString(attrName);
+            addString(doc->getAttribute(attrName));
+        }
+
+        if (element->isA<Node>())
+        {
+            addNode(element->asA<Node>());
+        }
+        else if (element->isA<Output>())
+        {
+            addOutput(element->asA<Output>());
+        }
+        else
+        {
+            // Other elements are not shared.
+            addString(element->getNamePath());
+        }
+    }
+
+    string getSignature() const
+    {
+        return toHexString(computeContentHash(_data)) +
+               toHexString(computeContentHash(_data.data(), _data.size(), 0x9E3779B97F4A7C15ULL));
+    }
+
+  private:
+    void addString(const string& str)
+    {
+        addUInt((uint64_t) str.size());
+        _data += str;
+    }
+
+    void addUInt(uint64_t value)
+    {
+        _data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void addOutput(OutputPtr output)
+    {
+        addUInt(TAG_OUTPUT);
+        addString(output->getName());
+        addString(output->getType());
+        addString(output->getChannels());
+        addString(output->getUnit());
+
+        // Values on the interface of a graph output are always compiled.
+        ElementPtr parent = output->getParent();
+        InterfaceElementPtr interface;
+        if (parent->isA<NodeGraph>())
+        {
+            NodeGraphPtr nodeGraph = parent->asA<NodeGraph>();
+            NodeDefPtr nodeDef = nodeGraph->getNodeDef();
+            interface = nodeDef ? nodeDef->asA<InterfaceElement>() : nodeGraph->asA<InterfaceElement>();
+        }
+        if (interface)
+        {
+            for (InputPtr input : interface->getActiveInputs())
+            {
+                ValuePtr value = input->getResolvedValue();
+                addString(input->getName());
+                addString(input->getType());
+                addString(value ? value->getValueString() : EMPTY_STRING);
+                addString(input->getActiveColorSpace());
+                addString(input->getUnit());
+            }
+        }
+
+        NodePtr node = output->getConnectedNode();
+        if (node && _context.getOptions().addUpstreamDependencies)
+        {
+            addUInt(addNode(node));
+        }
+    }
+
+    size_t addNode(NodePtr node)
+    {
+        auto it = _nodeIds.find(node);
+        if (it != _nodeIds.end())
+        {
+            return it->second;
+        }
+        const size_t id = _nodeIds.size();
+        _nodeIds[node] = id;
+
+        addUInt(TAG_NODE);
+        addString(node->getCategory());
+        addString(node->getType());
+        NodeDefPtr nodeDef = node->getNodeDef(_target);
+        if (!nodeDef)
+        {
+            return id;
+        }
+        addString(nodeDef->getName());
+
+        const bool valueDependent = VALUE_DEPENDENT_NODEGROUPS.count(nodeDef->getNodeGroup()) > 0;
+        for (InputPtr nodeDefInput : nodeDef->getActiveInputs())
+        {
+            const string& inputName = nodeDefInput->getName();
+            InputPtr input = node->getInput(inputName);
+            addUInt(TAG_INPUT);
+            addString(inputName);
+            if (input)
+            {
+                addString(input->getActiveColorSpace());
+                addString(input->getUnit());
+                addString(input->getUnitType());
+                addString(input->getChannels());
+            }
+
+            if (input && input->hasInterfaceName())
+            {
+                addUInt(TAG_INTERFACE);
+                addString(input->getInterfaceName());
+            }
+            NodePtr upstream = input ? input->getConnectedNode() : nullptr;
+            if (upstream)
+            {
+                addUInt(TAG_CONNECTION);
+                addString(input->getOutputString());
+                if (_context.getOptions().addUpstreamDependencies)
+                {
+                    addUInt(addNode(upstream));
+                }
+                continue;
+            }
+            GeomPropDefPtr geomProp = nodeDefInput->getDefaultGeomProp();
+            if (geomProp)
+            {
+                addUInt(TAG_GEOMPROP);
+                addString(geomProp->getName());
+            }
+
+            // Find the value of the input, following its interface
+            // or falling back to its definition.
+            ValuePtr value = input ? input->getResolvedValue() : nullptr;
+            if (!value && input)
+            {
+                InputPtr interfaceInput = input->getInterfaceInput();
+                value = interfaceInput ? interfaceInput->getResolvedValue() : nullptr;
+            }
+            if (!value)
+            {
+                value = nodeDefInput->getResolvedValue();
+            }
+            if (!value)
+            {
+                addUInt(TAG_NO_VALUE);
+                continue;
+            }
+
+            // String and uniform values commonly select code at generation time,
+            // so they are part of the signature, with the exception of filenames.
+            const string& type = nodeDefInput->getType();
+            const string valueString = value->getValueString();
+            if (valueDependent || type == STRING_TYPE_STRING ||
+                (nodeDefInput->getIsUniform() && type != FILENAME_TYPE_STRING))
+            {
+                addUInt(TAG_CONSTANT);
+                addString(valueString);
+                continue;
+            }
+            addUInt(TAG_VALUE);
+            if (type == FILENAME_TYPE_STRING)
+            {
+                addUInt(valueString.find(UDIM_TOKEN) != string::npos);
+            }
+            if (_values)
+            {
+                // Remap enumerations as they are when published as uniforms.
+                std::pair<const TypeDesc*, ValuePtr> enumResult;
+                const string& enumNames = nodeDefInput->getAttribute(ValueElement::ENUM_ATTRIBUTE);
+                if (_context.getShaderGenerator().getSyntax().remapEnumeration(valueString, TypeDesc::get(type), enumNames, enumResult))
+                {
+                    value = enumResult.second;
+                }
+                _values->push_back({ node->getNamePath() + NAME_PATH_SEPARATOR + inputName, value });
+            }
+        }
+        return id;
+    }
+
+  private:
+    GenContext& _context;
+    const string& _target;
+    vector<InputValue>* _values;
+    std::unordered_map<NodePtr, size_t> _nodeIds;
+    string _data;
+};
+
+// Return a key for the values of the given inputs.
+string getValueKey(const vector<InputValue>& values, const vector<size_t>& indices)
+{
+    string key;
+    for (size_t index : indices)
+    {
+        const string valueString = values[index].value->getValueString();
+        key += std::to_string(valueString.size()) + ":" + valueString;
+    }
+    return key;
+}
+
+} // anonymous namespace
+
+//
+// ShaderPermutationCache methods
+//
+
+ShaderPermutationCache::ShaderPermutationCache() :
+    _shaderCount(0),
+    _hitCount(0)
+{
+}
+
+string ShaderPermutationCache::computeSignature(ElementPtr element, GenContext& context) const
+{
+    SignatureBuilder builder(context, nullptr);
+    builder.addElement(element);
+    return builder.getSignature();
+}
+
+ShaderPermutation ShaderPermutationCache::generate(const string& name, ElementPtr element, GenContext& context)
+{
+    ShaderPermutation result;
+    vector<InputValue> values;
+    SignatureBuilder builder(context, &values);
+    builder.addElement(element);
+    result.signature = builder.getSignature();
+
+    Permutation& permutation = _permutations[result.signature];
+    const bool newPermutation = permutation.variants.empty();
+    string variantKey = newPermutation ? EMPTY_STRING : getValueKey(values, permutation.compiledValues);
+    auto it = permutation.variants.find(variantKey);
+    if (!newPermutation && it != permutation.variants.end())
+    {
+        _hitCount++;
+    }
+    else
+    {
+        Variant variant;
+        variant.shader = context.getShaderGenerator().generate(name, element, context);
+        if (!variant.shader)
+        {
+            throw ExceptionShaderGenError("Failed to generate shader for element: " + element->getNamePath());
+        }
+
+        // Bind uniforms to the input values from which they are published,
+        // identified by element path and value.
+        std::unordered_map<string, size_t> valueIndices;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            valueIndices[values[i].path] = i;
+        }
+        vector<bool> bound(values.size(), false);
+        for (size_t i = 0; i < variant.shader->numStages(); i++)
+        {
+            for (const auto& block : variant.shader->getStage(i).getUniformBlocks())
+            {
+                for (size_t j = 0; j < block.second->size(); j++)
+                {
+                    const ShaderPort* port = (*block.second)[j];
+                    auto valueIt = valueIndices.find(port->getPath());
+                    if (valueIt == valueIndices.end() || !port->getValue() ||
+                        port->getValue()->getValueString() != values[valueIt->second].value->getValueString())
+                    {
+                        continue;
+                    }
+                    variant.bindings.push_back({ port->getVariable(), valueIt->second });
+                    bound[valueIt->second] = true;
+                }
+            }
+        }
+
+        // Values that are not published are compiled into the code, so they
+        // select between variants of the permutation.
+        if (newPermutation)
+        {
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                if (!bound[i])
+                {
+                    permutation.compiledValues.push_back(i);
+                }
+            }
+            variantKey = getValueKey(values, permutation.compiledValues);
+        }
+        it = permutation.variants.emplace(variantKey, variant).first;
+        _shaderCount++;
+    }
+
+    result.shader = it->second.shader;
+    for (const Binding& binding : it->second.bindings)
+    {
+        result.uniformValues[binding.variable] = values[binding.valueIndex].value;
+    }
+    return result;
+}
+
+void ShaderPermutationCache::clear()
+{
+    _permutations.clear();
+    _shaderCount = 0;
+    _hitCount = 0;
+}
+
+} // namespace MaterialX
@@ -0,0 +1,129 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_SHADERPERMUTATIONCACHE_H
+#define MATERIALX_SHADERPERMUTATIONCACHE_H
+
+/// @file
+/// Sharing of generated shaders between elements of identical topology
+
+#include <MaterialXGenShader/Export.h>
+
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
+
+namespace MaterialX
+{
+
+/// A shared pointer to a ShaderPermutationCache
+using ShaderPermutationCachePtr = shared_ptr<class ShaderPermutationCache>;
+
+/// A map from uniform variable names to values
+using UniformValueMap = std::unordered_map<string, ValuePtr>;
+
+/// @struct ShaderPermutation
+/// A shader shared by all elements of the same topology, along with the
+/// uniform values of a single element.
+struct MX_GENSHADER_API ShaderPermutation
+{
+    /// The shared shader, or nullptr if generation failed.
+    ShaderPtr shader;
+
+    /// The topology signature of the element.
+    string signature;
+
+    /// The values of the element for uniforms of the shared shader, keyed
+    /// by uniform variable name.  Uniforms that are not in the map have the
+    /// same value for all elements sharing the shader, as stored in the
+    /// shader itself.
+    UniformValueMap uniformValues;
+};
+
+/// @class ShaderPermutationCache
+/// A cache of generated shaders, shared between elements whose upstream
+/// graphs differ only in the values of their inputs.
+///
+/// Elements are described by a topology signature, covering the nodes and
+/// connections of their upstream graphs, the types and definitions of nodes,
+/// the inputs that are connected or given values, uniform declarations, color
+/// spaces and units, and the state of the generation context.  Values of
+/// inputs are not part of the signature, except for those that select code
+/// at generation time, such as string and uniform integer inputs.
+///
+/// The first element with a given signature is generated by the shader
+/// generator of the context, and the uniforms of its shader are matched to
+/// the inputs from which they are published.  Inputs whose values are not
+/// published as uniforms, for example under a reduced shader interface or
+/// when folded by the optimizer, are compiled into the code, so elements
+/// that differ in these values are given separate shaders.
+///
+/// Shared shaders are named after the first element that generated them.
+/// The cache is not thread-safe.
+class MX_GENSHADER_API ShaderPermutationCache
+{
+  public:
+    ShaderPermutationCache();
+
+    /// Create a new shader permutation cache.
+    static ShaderPermutationCachePtr create()
+    {
+        return std::make_shared<ShaderPermutationCache>();
+    }
+
+    /// Compute the topology signature of the given element.
+    string computeSignature(ElementPtr element, GenContext& context) const;
+
+    /// Return the shader for the given element along with its uniform values,
+    /// generating a shader only if no element of the same topology has been
+    /// generated before.
+    /// @throws ExceptionShaderGenError if shader generation fails.
+    ShaderPermutation generate(const string& name, ElementPtr element, GenContext& context);
+
+    /// Return the number of distinct shaders generated by the cache.
+    size_t getShaderCount() const
+    {
+        return _shaderCount;
+    }
+
+    /// Return the number of elements served with a previously generated shader.
+    size_t getHitCount() const
+    {
+        return _hitCount;
+    }
+
+    /// Clear all shaders from the cache.
+    void clear();
+
+  protected:
+    // A uniform of a shared shader, bound to an input value of its elements.
+    struct Binding
+    {
+        string variable;
+        size_t valueIndex;
+    };
+
+    // A shader for a given set of compiled input values.
+    struct Variant
+    {
+        ShaderPtr shader;
+        vector<Binding> bindings;
+    };
+
+    // The shaders for a given topology signature.
+    struct Permutation
+    {
+        vector<size_t> compiledValues;
+        std::unordered_map<string, Variant> variants;
+    };
+
+  protected:
+    std::unordered_map<string, Permutation> _permutations;
+    size_t _shaderCount;
+    size_t _hitCount;
+};
+
+} // namespace MaterialX
+
+#endif
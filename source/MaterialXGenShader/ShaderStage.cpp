@@ -7,6 +7,7 @@
 
 #include <MaterialXGenShader/ShaderGenerator.h>
 #include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/SourceFileCache.h>
 #include <MaterialXGenShader/Syntax.h>
 #include <MaterialXGenShader/Util.h>
 
@@ -14,6 +15,9 @@
 
 #include <MaterialXFormat/Util.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace MaterialX
 {
 
@@ -22,6 +26,83 @@ namespace Stage
     const string PIXEL = "pixel";
 }
 
+namespace
+{
+    // Capacity of each chunk of copied code.
+    const size_t CODE_CHUNK_CAPACITY = 16 * 1024;
+
+    // Fragments of source files smaller than this are copied
+    // rather than referenced.
+    const size_t MIN_REFERENCED_FRAGMENT_SIZE = 256;
+
+    const string PHASE_ADD_INCLUDE = "ShaderStage::addInclude";
+}
+
+//
+// SourceCodeBuffer methods
+//
+
+void SourceCodeBuffer::append(const char* data, size_t size)
+{
+    if (!size)
+    {
+        return;
+    }
+    if (_chunks.empty() || _chunks.back().data ||
+        _chunks.back().text.size() + size > _chunks.back().text.capacity())
+    {
+        _chunks.push_back(Chunk{ string(), nullptr, 0 });
+        _chunks.back().text.reserve(std::max(size, CODE_CHUNK_CAPACITY));
+    }
+    _chunks.back().text.append(data, size);
+    _size += size;
+}
+
+void SourceCodeBuffer::append(const char* data, size_t size, const SourceFilePtr& file)
+{
+    if (size < MIN_REFERENCED_FRAGMENT_SIZE)
+    {
+        append(data, size);
+        return;
+    }
+    if (_files.empty() || _files.back() != file)
+    {
+        _files.push_back(file);
+    }
+    _chunks.push_back(Chunk{ string(), data, size });
+    _size += size;
+}
+
+void SourceCodeBuffer::assign(string str)
+{
+    _chunks.clear();
+    _files.clear();
+    _code = std::move(str);
+    _size = _code.size();
+}
+
+void SourceCodeBuffer::join() const
+{
+    if (_chunks.empty())
+    {
+        return;
+    }
+    _code.reserve(_size);
+    for (const Chunk& chunk : _chunks)
+    {
+        if (chunk.data)
+        {
+            _code.append(chunk.data, chunk.size);
+        }
+        else
+        {
+            _code += chunk.text;
+        }
+    }
+    _chunks.clear();
+    _files.clear();
+}
+
 //
 // VariableBlock methods
 //
@@ -96,7 +177,8 @@ ShaderStage::ShaderStage(const string& name, ConstSyntaxPtr syntax) :
     _name(name),
     _syntax(syntax),
     _indentations(0),
-    _constants("Constants", "cn")
+    _constants("Constants", "cn"),
+    _tokenOffset(string::npos)
 {
 }
 
@@ -196,23 +278,25 @@ void ShaderStage::beginScope(Syntax::Punctuation punc)
     switch (punc) {
     case Syntax::CURLY_BRACKETS:
         beginLine();
-        _code += "{" + _syntax->getNewline();
+        _code.append("{", 1);
         break;
     case Syntax::PARENTHESES:
         beginLine();
-        _code += "(" + _syntax->getNewline();
+        _code.append("(", 1);
         break;
     case Syntax::SQUARE_BRACKETS:
         beginLine();
-        _code += "[" + _syntax->getNewline();
+        _code.append("[", 1);
         break;
     case Syntax::DOUBLE_SQUARE_BRACKETS:
         beginLine();
-        _code += "[[" + _syntax->getNewline();
+        _code.append("[[", 2);
         break;
     }
+    newLine();
 
     ++_indentations;
+    _indentation += _syntax->getIndentation();
     _scopes.push_back(punc);
 }
 
@@ -226,56 +310,58 @@ void ShaderStage::endScope(bool semicolon, bool newline)
     Syntax::Punctuation punc = _scopes.back();
     _scopes.pop_back();
     --_indentations;
+    _indentation.resize(_indentation.size() - _syntax->getIndentation().size());
 
     switch (punc) {
     case Syntax::CURLY_BRACKETS:
         beginLine();
-        _code += "}";
+        _code.append("}", 1);
         break;
     case Syntax::PARENTHESES:
         beginLine();
-        _code += ")";
+        _code.append(")", 1);
         break;
     case Syntax::SQUARE_BRACKETS:
         beginLine();
-        _code += "]";
+        _code.append("]", 1);
         break;
     case Syntax::DOUBLE_SQUARE_BRACKETS:
         beginLine();
-        _code += "]]";
+        _code.append("]]", 2);
         break;
     }
     if (semicolon)
-        _code += ";";
+        _code.append(";", 1);
     if (newline)
-        _code += _syntax->getNewline();
+        newLine();
 }
 
 void ShaderStage::beginLine()
 {
-    for (int i = 0; i < _indentations; ++i)
-    {
-        _code += _syntax->getIndentation();
-    }
+    _code.append(_indentation);
 }
 
 void ShaderStage::endLine(bool semicolon)
 {
     if (semicolon)
     {
-        _code += ";";
+        _code.append(";", 1);
     }
     newLine();
 }
 
 void ShaderStage::newLine()
 {
-    _code += _syntax->getNewline();
+    _code.append(_syntax->getNewline());
 }
 
 void ShaderStage::addString(const string& str)
 {
-    _code += str;
+    if (_tokenOffset == string::npos && str.find(TokenSubstitutor::TOKEN_PREFIX) != string::npos)
+    {
+        _tokenOffset = _code.size();
+    }
+    _code.append(str);
 }
 
 void ShaderStage::addLine(const string& str, bool semicolon)
@@ -288,39 +374,53 @@ void ShaderStage::addLine(const string& str, bool semicolon)
 void ShaderStage::addComment(const string& str)
 {
     beginLine();
-    _code += _syntax->getSingleLineComment() + str;
+    _code.append(_syntax->getSingleLineComment());
+    addString(str);
     endLine(false);
 }
 
 void ShaderStage::addBlock(const string& str, GenContext& context)
+{
+    // Add each line in the block seperatelly
+    // to get correct indentation
+    string line;
+    size_t start = 0;
+    while (start < str.size())
+    {
+        size_t end = str.find('\n', start);
+        if (end == string::npos)
+        {
+            end = str.size();
+        }
+        line.assign(str, start, end - start);
+        addBlockLine(line, context);
+        start = end + 1;
+    }
+}
+
+void ShaderStage::addBlockLine(const string& line, GenContext& context)
 {
     const string& INCLUDE = _syntax->getIncludeStatement();
     const string& QUOTE   = _syntax->getStringQuote();
 
-    // Add each line in the block seperatelly
-    // to get correct indentation
-    StringStream stream(str);
-    for (string line; std::getline(stream, line); )
+    size_t pos = line.find(INCLUDE);
+    if (pos != string::npos)
     {
-        size_t pos = line.find(INCLUDE);
-        if (pos != string::npos)
+        size_t startQuote = line.find_first_of(QUOTE);
+        size_t endQuote = line.find_last_of(QUOTE);
+        if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote)
         {
-            size_t startQuote = line.find_first_of(QUOTE);
-            size_t endQuote = line.find_last_of(QUOTE);
-            if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote)
+            size_t length = (endQuote - startQuote) - 1;
+            if (length)
             {
-                size_t length = (endQuote - startQuote) - 1;
-                if (length)
-                {
-                    const string filename = line.substr(startQuote + 1, length);
-                    addInclude(filename, context);
-                }
+                const string filename = line.substr(startQuote + 1, length);
+                addInclude(filename, context);
             }
         }
-        else
-        {
-            addLine(line, false);
-        }
+    }
+    else
+    {
+        addLine(line, false);
     }
 }
 
@@ -332,24 +432,85 @@ void ShaderStage::addInclude(const string& file, GenContext& context)
 
     if (!_includes.count(resolvedFile))
     {
-        string content = readFile(resolvedFile);
-        if (content.empty())
+        SourceFilePtr sourceFile = SourceFileCache::get().getFile(resolvedFile);
+        if (!sourceFile)
         {
             throw ExceptionShaderGenError("Could not find include file: '" + file + "'");
         }
         _includes.insert(resolvedFile);
-        addBlock(content, context);
+
+        GenProfiler* profiler = context.getProfiler().get();
+        ScopedGenTimer timer(profiler, PHASE_ADD_INCLUDE);
+        if (profiler)
+        {
+            profiler->addCounter(GenProfiler::INCLUDE_READS);
+            profiler->addCounter(GenProfiler::INCLUDE_BYTES, sourceFile->getContent().size());
+        }
+        addSourceFile(sourceFile, context);
+    }
+}
+
+void ShaderStage::addSourceFile(const SourceFilePtr& file, GenContext& context)
+{
+    const StringVec& lines = file->getLines();
+
+    // Lines that need indentation or newline translation are added one by one.
+    if (_indentations > 0 || _syntax->getNewline() != "\n")
+    {
+        for (const string& line : lines)
+        {
+            addBlockLine(line, context);
+        }
+        return;
+    }
+
+    // Otherwise each run of lines between include statements is identical
+    // to the corresponding range of the file, which is referenced in place.
+    const string& INCLUDE = _syntax->getIncludeStatement();
+    const string& content = file->getContent();
+    size_t runStart = 0;
+    for (size_t i = 0; i <= lines.size(); i++)
+    {
+        if (i < lines.size() && lines[i].find(INCLUDE) == string::npos)
+        {
+            continue;
+        }
+        if (i > runStart)
+        {
+            const size_t begin = file->getLineOffset(runStart);
+            const size_t end = file->getLineOffset(i - 1) + lines[i - 1].size();
+            const bool newline = end < content.size();
+            if (_tokenOffset == string::npos)
+            {
+                const char* token = static_cast<const char*>(std::memchr(content.data() + begin, TokenSubstitutor::TOKEN_PREFIX, end - begin));
+                if (token)
+                {
+                    _tokenOffset = _code.size() + (token - content.data() - begin);
+                }
+            }
+            _code.append(content.data() + begin, end - begin + (newline ? 1 : 0), file);
+            if (!newline)
+            {
+                newLine();
+            }
+        }
+        if (i < lines.size())
+        {
+            addBlockLine(lines[i], context);
+        }
+        runStart = i + 1;
     }
 }
 
 void ShaderStage::addFunctionDefinition(const ShaderNode& node, GenContext& context)
 {
     const ShaderNodeImpl& impl = node.getImplementation();
-    const size_t id = impl.getHash();
+    const uint64_t id = impl.getHash();
 
     if (!_definedFunctions.count(id))
     {
         _definedFunctions.insert(id);
+        ScopedGenTimer timer(context.getProfiler().get(), impl.getName(), GenProfiler::IMPLEMENTATION);
         impl.emitFunctionDefinition(node, context, *this);
     }
 }
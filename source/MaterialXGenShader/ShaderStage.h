@@ -13,6 +13,7 @@
 
 #include <MaterialXGenShader/GenOptions.h>
 #include <MaterialXGenShader/ShaderGraph.h>
+#include <MaterialXGenShader/SourceFileCache.h>
 #include <MaterialXGenShader/Syntax.h>
 
 #include <MaterialXCore/Node.h>
@@ -116,6 +117,72 @@ class MX_GENSHADER_API VariableBlock
     vector<ShaderPort*> _variableOrder;
 };
 
+/// @class SourceCodeBuffer
+/// A buffer of generated source code, stored as a list of chunks.
+///
+/// Appended text is copied into chunks of fixed capacity, so the code is never
+/// reallocated as it grows, and fragments of cached source files are referenced
+/// in place without copying.  The chunks are joined into a single string once,
+/// when the code is first requested.
+class MX_GENSHADER_API SourceCodeBuffer
+{
+  public:
+    SourceCodeBuffer() :
+        _size(0)
+    {
+    }
+
+    /// Append the given string.
+    void append(const string& str)
+    {
+        append(str.data(), str.size());
+    }
+
+    /// Append the given characters.
+    void append(const char* data, size_t size);
+
+    /// Append a fragment of the contents of the given source file, which is
+    /// referenced rather than copied when large enough to benefit.
+    void append(const char* data, size_t size, const SourceFilePtr& file);
+
+    /// Replace the contents of the buffer with the given string.
+    void assign(string str);
+
+    /// Return the total length of the code in the buffer.
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /// Return the code as a single string, joining any pending chunks.
+    string& str()
+    {
+        join();
+        return _code;
+    }
+
+    /// Return the code as a single string, joining any pending chunks.
+    const string& str() const
+    {
+        join();
+        return _code;
+    }
+
+  private:
+    void join() const;
+
+    struct Chunk
+    {
+        string text;
+        const char* data;
+        size_t size;
+    };
+
+    mutable string _code;
+    mutable vector<Chunk> _chunks;
+    mutable vector<SourceFilePtr> _files;
+    size_t _size;
+};
 
 /// @class ShaderStage
 /// A shader stage, containing the state and 
@@ -133,7 +200,7 @@ class MX_GENSHADER_API ShaderStage
     const string& getFunctionName() const { return _functionName; }
 
     /// Return the stage source code.
-    const string& getSourceCode() const { return _code; }
+    const string& getSourceCode() const { return _code.str(); }
 
     /// Create a new uniform variable block.
     VariableBlockPtr createUniformBlock(const string& name, const string& instance = EMPTY_STRING);
@@ -214,17 +281,23 @@ class MX_GENSHADER_API ShaderStage
     /// Add a block of code.
     void addBlock(const string& str, GenContext& context);
 
+    /// Add a single line of a block of code, expanding include statements.
+    void addBlockLine(const string& line, GenContext& context);
+
     /// Add the contents of an include file. Making sure it is 
     /// only included once for the shader stage.
     void addInclude(const string& file, GenContext& context);
 
+    /// Add the lines of a cached source file, expanding include statements.
+    void addSourceFile(const SourceFilePtr& file, GenContext& context);
+
     /// Add a value.
     template<typename T>
     void addValue(const T& value)
     {
         StringStream str;
         str << value;
-        _code += str.str();
+        addString(str.str());
     }
 
     /// Add the function definition for a node.
@@ -256,7 +329,7 @@ class MX_GENSHADER_API ShaderStage
     StringSet _includes;
 
     /// Set of hash ID's for functions that has been defined.
-    std::set<size_t> _definedFunctions;
+    std::set<uint64_t> _definedFunctions;
 
     /// Block holding constant variables for this stage.
     VariableBlock _constants;
@@ -271,9 +344,17 @@ class MX_GENSHADER_API ShaderStage
     VariableBlockMap _outputs;
 
     /// Resulting source code for this stage.
-    string _code;
+    SourceCodeBuffer _code;
+
+    /// Indentation string for the current indentation level.
+    string _indentation;
+
+    /// Offset of the first code that may contain tokens,
+    /// or string::npos if no tokens have been emitted.
+    size_t _tokenOffset;
 
     friend class ShaderGenerator;
+    friend class ShaderCache;
 };
 
 /// Shared pointer to a ShaderStage
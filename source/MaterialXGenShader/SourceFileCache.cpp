@@ -0,0 +1,114 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXGenShader/SourceFileCache.h>
+
+#include <MaterialXFormat/Util.h>
+
+namespace MaterialX
+{
+
+//
+// SourceFile methods
+//
+
+SourceFile::SourceFile(string content) :
+    _content(std::move(content)),
+    _hash(computeContentHash(_content))
+{
+    // Split lines following std::getline, with no trailing empty line.
+    size_t start = 0;
+    while (start < _content.size())
+    {
+        size_t end = _content.find('\n', start);
+        if (end == string::npos)
+        {
+            end = _content.size();
+        }
+        _lines.emplace_back(_content, start, end - start);
+        _lineOffsets.push_back(start);
+        start = end + 1;
+    }
+}
+
+//
+// SourceFileCache methods
+//
+
+SourceFileCache& SourceFileCache::get()
+{
+    static SourceFileCache cache;
+    return cache;
+}
+
+SourceFilePtr SourceFileCache::getFile(const FilePath& path)
+{
+    const string key = path.asString();
+    const uint64_t modificationTime = path.getModificationTime();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it != _entries.end() && modificationTime && it->second.modificationTime == modificationTime)
+        {
+            return it->second.file;
+        }
+    }
+
+    // Read the file outside the lock, so that other files may be served
+    // while it is loaded.
+    string content = readFile(path);
+    if (content.empty())
+    {
+        invalidate(path);
+        return nullptr;
+    }
+    SourceFilePtr file = std::make_shared<SourceFile>(std::move(content));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::weak_ptr<const SourceFile>& shared = _contents[file->getHash()];
+    SourceFilePtr sharedFile = shared.lock();
+    if (sharedFile && sharedFile->getContent() == file->getContent())
+    {
+        file = sharedFile;
+    }
+    else
+    {
+        shared = file;
+    }
+    _entries[key] = { file, modificationTime };
+    return file;
+}
+
+void SourceFileCache::invalidate(const FilePath& path)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(path.asString());
+    if (it == _entries.end())
+    {
+        return;
+    }
+    const uint64_t hash = it->second.file->getHash();
+    _entries.erase(it);
+    auto contentIt = _contents.find(hash);
+    if (contentIt != _contents.end() && contentIt->second.expired())
+    {
+        _contents.erase(contentIt);
+    }
+}
+
+size_t SourceFileCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+void SourceFileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _contents.clear();
+}
+
+} // namespace MaterialX
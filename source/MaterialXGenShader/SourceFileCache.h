@@ -0,0 +1,108 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_SOURCEFILECACHE_H
+#define MATERIALX_SOURCEFILECACHE_H
+
+/// @file
+/// Process-wide cache of shader source files
+
+#include <MaterialXGenShader/Export.h>
+
+#include <MaterialXFormat/File.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace MaterialX
+{
+
+/// A shared pointer to a const SourceFile
+using SourceFilePtr = shared_ptr<const class SourceFile>;
+
+/// @class SourceFile
+/// The contents of a shader source file, along with its content hash and
+/// its lines, split as they are added to a shader stage.
+class MX_GENSHADER_API SourceFile
+{
+  public:
+    /// Constructor, taking the contents of the file.
+    SourceFile(string content);
+
+    /// Return the contents of the file.
+    const string& getContent() const
+    {
+        return _content;
+    }
+
+    /// Return the lines of the file, without newline characters.
+    const StringVec& getLines() const
+    {
+        return _lines;
+    }
+
+    /// Return the offset of the given line within the contents of the file.
+    size_t getLineOffset(size_t index) const
+    {
+        return _lineOffsets[index];
+    }
+
+    /// Return the content hash of the file.
+    uint64_t getHash() const
+    {
+        return _hash;
+    }
+
+  private:
+    string _content;
+    StringVec _lines;
+    vector<size_t> _lineOffsets;
+    uint64_t _hash;
+};
+
+/// @class SourceFileCache
+/// A thread-safe, process-wide cache of shader source files, shared by
+/// source code implementations and shader stage includes.
+///
+/// Files are stored by resolved path and validated against their modification
+/// time on each lookup, so edited files are read again.  Files with identical
+/// contents share a single SourceFile.
+class MX_GENSHADER_API SourceFileCache
+{
+  public:
+    /// Return the process-wide source file cache.
+    static SourceFileCache& get();
+
+    /// Return the source file at the given resolved path, reading it from the
+    /// file system if it is not cached or has been modified since it was read.
+    /// Returns nullptr if the file cannot be read or is empty.
+    SourceFilePtr getFile(const FilePath& path);
+
+    /// Remove the file at the given path from the cache.
+    void invalidate(const FilePath& path);
+
+    /// Return the number of files in the cache.
+    size_t size() const;
+
+    /// Clear all files from the cache.
+    void clear();
+
+  protected:
+    SourceFileCache() { }
+
+    struct Entry
+    {
+        SourceFilePtr file;
+        uint64_t modificationTime;
+    };
+
+    std::unordered_map<string, Entry> _entries;
+    std::unordered_map<uint64_t, std::weak_ptr<const SourceFile>> _contents;
+    mutable std::mutex _mutex;
+};
+
+} // namespace MaterialX
+
+#endif
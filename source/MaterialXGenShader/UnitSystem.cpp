@@ -45,7 +45,7 @@ void ScalarUnitNode::initialize(const InterfaceElement& element, GenContext& /*c
 
     // Use the unit ratio function name has hash to make sure this function
     // is shared, and only emitted once, for all units of the same unit type.
-    _hash = std::hash<string>{}(_unitRatioFunctionName);
+    _hash = computeContentHash(_unitRatioFunctionName);
 }
 
 void ScalarUnitNode::emitFunctionDefinition(const ShaderNode& /*node*/, GenContext& context, ShaderStage& stage) const
@@ -7,6 +7,9 @@
 
 #include <MaterialXGenShader/HwShaderGenerator.h>
 
+#include <algorithm>
+#include <cctype>
+
 namespace MaterialX
 {
 
@@ -461,35 +464,110 @@ InputPtr getNodeDefInput(InputPtr nodeInput, const string& target)
 
 namespace
 {
-    const char TOKEN_PREFIX = '$';
+    // Replace tokens in the given string in a single scan, starting from the
+    // given offset, using the given function to look up each token.
+    template<class LookupFunction>
+    bool substituteTokens(string& source, size_t start, const LookupFunction& lookup)
+    {
+        const char TOKEN_PREFIX = TokenSubstitutor::TOKEN_PREFIX;
+        size_t pos = source.find(TOKEN_PREFIX, start);
+        if (pos == string::npos)
+        {
+            return false;
+        }
+
+        const size_t len = source.length();
+        string buffer;
+        buffer.reserve(len + len / 4);
+        buffer.append(source, 0, pos);
+        bool replaced = false;
+        while (pos != string::npos && pos + 1 < len)
+        {
+            size_t end = pos + 1;
+            while (end < len && isalnum(static_cast<unsigned char>(source[end])))
+            {
+                end++;
+            }
+            const string* value = lookup(source.data() + pos, end - pos);
+            if (value)
+            {
+                buffer += *value;
+                replaced = true;
+            }
+            else
+            {
+                buffer.append(source, pos, end - pos);
+            }
+            pos = source.find(TOKEN_PREFIX, end);
+            buffer.append(source, end, (pos != string::npos ? pos : len) - end);
+        }
+        if (pos != string::npos)
+        {
+            buffer.append(source, pos, string::npos);
+        }
+
+        if (replaced)
+        {
+            source.swap(buffer);
+        }
+        return replaced;
+    }
 }
 
 void tokenSubstitution(const StringMap& substitutions, string& source)
 {
-    string buffer;
-    size_t pos = 0, len = source.length();
-    while (pos < len)
+    substituteTokens(source, 0, [&substitutions](const char* token, size_t length) -> const string*
+    {
+        auto it = substitutions.find(string(token, length));
+        return it != substitutions.end() ? &it->second : nullptr;
+    });
+}
+
+//
+// TokenSubstitutor methods
+//
+
+const char TokenSubstitutor::TOKEN_PREFIX;
+
+void TokenSubstitutor::setSubstitutions(const StringMap& substitutions)
+{
+    if (substitutions.size() == _substitutions.size())
     {
-        size_t p1 = source.find_first_of(TOKEN_PREFIX, pos);
-        if (p1 != string::npos && p1 + 1 < len)
+        bool equal = true;
+        for (const auto& entry : _substitutions)
         {
-            buffer += source.substr(pos, p1 - pos);
-            pos = p1 + 1;
-            string token = { TOKEN_PREFIX };
-            while (pos < len && isalnum(source[pos]))
+            auto it = substitutions.find(entry.first);
+            if (it == substitutions.end() || it->second != entry.second)
             {
-                token += source[pos++];
+                equal = false;
+                break;
             }
-            auto it = substitutions.find(token);
-            buffer += (it != substitutions.end() ? it->second : token);
         }
-        else
+        if (equal)
         {
-            buffer += source.substr(pos);
-            break;
+            return;
         }
     }
-    source = buffer;
+
+    _substitutions.assign(substitutions.begin(), substitutions.end());
+    std::sort(_substitutions.begin(), _substitutions.end());
+}
+
+bool TokenSubstitutor::substitute(string& source, size_t start) const
+{
+    return substituteTokens(source, start, [this](const char* token, size_t length) -> const string*
+    {
+        auto it = std::lower_bound(_substitutions.begin(), _substitutions.end(), std::make_pair(token, length),
+            [](const std::pair<string, string>& entry, const std::pair<const char*, size_t>& key)
+            {
+                return entry.first.compare(0, string::npos, key.first, key.second) < 0;
+            });
+        if (it != _substitutions.end() && it->first.compare(0, string::npos, token, length) == 0)
+        {
+            return &it->second;
+        }
+        return nullptr;
+    });
 }
 
 vector<Vector2> getUdimCoordinates(const StringVec& udimIdentifiers)
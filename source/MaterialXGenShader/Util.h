@@ -73,6 +73,38 @@ MX_GENSHADER_API InputPtr getNodeDefInput(InputPtr nodeInput, const string& targ
 /// by the corresponding string in the substitution map, if the token exists in the map.
 MX_GENSHADER_API void tokenSubstitution(const StringMap& substitutions, string& source);
 
+/// @class TokenSubstitutor
+/// A precompiled set of token substitutions, following the token conventions
+/// of tokenSubstitution.  Tokens are looked up in a sorted table without
+/// allocation, and each string is rewritten in a single linear scan.
+class MX_GENSHADER_API TokenSubstitutor
+{
+  public:
+    /// The character starting each token.
+    static const char TOKEN_PREFIX = '$';
+
+  public:
+    TokenSubstitutor() { }
+
+    /// Constructor, compiling the given substitution map.
+    explicit TokenSubstitutor(const StringMap& substitutions)
+    {
+        setSubstitutions(substitutions);
+    }
+
+    /// Set the substitution map, recompiling the substitutor only if the
+    /// map differs from the one it was compiled from.
+    void setSubstitutions(const StringMap& substitutions);
+
+    /// Perform token substitutions on the given string, starting the scan
+    /// at the given offset.
+    /// @return True if any token was replaced.
+    bool substitute(string& source, size_t start = 0) const;
+
+  private:
+    vector<std::pair<string, string>> _substitutions;
+};
+
 /// Compute the UDIM coordinates for a set of UDIM identifiers
 /// @return List of UDIM coordinates
 MX_GENSHADER_API vector<Vector2> getUdimCoordinates(const StringVec& udimIdentifiers);
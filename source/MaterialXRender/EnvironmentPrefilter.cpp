@@ -0,0 +1,382 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXRender/EnvironmentPrefilter.h>
+
+#include <MaterialXRender/Types.h>
+
+#include <cmath>
+
+namespace MaterialX
+{
+
+namespace {
+
+const double PI = std::acos(-1.0);
+const double GOLDEN_RATIO = 1.6180339887498948482;
+
+// Width of the last level of a prefiltered chain.
+const unsigned int MIN_LEVEL_WIDTH = 8;
+
+// Number of rows processed by each task of a prefilter.
+const unsigned int ROWS_PER_TASK = 8;
+
+// Bias applied to the source mip level of each sample, as recommended for
+// filtered importance sampling.
+const double SAMPLE_LOD_BIAS = 1.0;
+
+// Smallest value of the sine of latitude used in computing sample footprints.
+const double MIN_SIN_THETA = 1.0e-4;
+
+// A chain of box-filtered mip levels of a source environment, with three
+// channels per texel.
+class SourceMips
+{
+  public:
+    explicit SourceMips(const Image& env)
+    {
+        // Expand the channels of the environment to colors, following
+        // Image::getTexelColor.
+        const unsigned int width = env.getWidth();
+        const unsigned int height = env.getHeight();
+        const unsigned int channelCount = env.getChannelCount();
+        Level base = { width, height, vector<float>((size_t) width * height * 3) };
+        vector<float> row((size_t) width * channelCount);
+        for (unsigned int y = 0; y < height; y++)
+        {
+            env.getRowValues(y, row.data());
+            float* dst = &base.data[(size_t) y * width * 3];
+            for (unsigned int x = 0; x < width; x++)
+            {
+                const float* texel = &row[(size_t) x * channelCount];
+                dst[x * 3 + 0] = texel[0];
+                dst[x * 3 + 1] = channelCount > 1 ? texel[1] : texel[0];
+                dst[x * 3 + 2] = channelCount > 2 ? texel[2] : (channelCount > 1 ? 0.0f : texel[0]);
+            }
+        }
+        _levels.push_back(std::move(base));
+
+        // Downsample by averaging blocks of two by two texels.
+        while (_levels.back().width > 1 || _levels.back().height > 1)
+        {
+            const Level& src = _levels.back();
+            Level dst = { std::max(src.width / 2, 1u), std::max(src.height / 2, 1u), { } };
+            dst.data.resize((size_t) dst.width * dst.height * 3);
+            for (unsigned int y = 0; y < dst.height; y++)
+            {
+                const unsigned int y0 = std::min(y * 2, src.height - 1);
+                const unsigned int y1 = std::min(y * 2 + 1, src.height - 1);
+                for (unsigned int x = 0; x < dst.width; x++)
+                {
+                    const unsigned int x0 = std::min(x * 2, src.width - 1);
+                    const unsigned int x1 = std::min(x * 2 + 1, src.width - 1);
+                    for (unsigned int c = 0; c < 3; c++)
+                    {
+                        dst.data[((size_t) y * dst.width + x) * 3 + c] = 0.25f *
+                            (src.at(x0, y0, c) + src.at(x1, y0, c) + src.at(x0, y1, c) + src.at(x1, y1, c));
+                    }
+                }
+            }
+            _levels.push_back(std::move(dst));
+        }
+    }
+
+    unsigned int getWidth() const
+    {
+        return _levels[0].width;
+    }
+
+    unsigned int getHeight() const
+    {
+        return _levels[0].height;
+    }
+
+    // Add the trilinear sample of the chain at the given coordinates, scaled
+    // by the given weight, to a color.
+    void addSample(double u, double v, double lod, double weight, double* color) const
+    {
+        lod = std::min(std::max(lod, 0.0), (double) (_levels.size() - 1));
+        const size_t level0 = (size_t) lod;
+        const size_t level1 = std::min(level0 + 1, _levels.size() - 1);
+        const double f = lod - level0;
+        addBilinearSample(_levels[level0], u, v, weight * (1.0 - f), color);
+        if (f > 0.0)
+        {
+            addBilinearSample(_levels[level1], u, v, weight * f, color);
+        }
+    }
+
+  private:
+    struct Level
+    {
+        unsigned int width;
+        unsigned int height;
+        vector<float> data;
+
+        float at(unsigned int x, unsigned int y, unsigned int c) const
+        {
+            return data[((size_t) y * width + x) * 3 + c];
+        }
+    };
+
+    // Add a bilinear sample of a level, wrapping horizontally and clamping
+    // vertically.
+    static void addBilinearSample(const Level& level, double u, double v, double weight, double* color)
+    {
+        const double x = u * level.width - 0.5;
+        const double y = std::min(std::max(v * level.height - 0.5, 0.0), (double) (level.height - 1));
+        const double xFloor = std::floor(x);
+        const double fx = x - xFloor;
+        const unsigned int y0 = (unsigned int) y;
+        const unsigned int y1 = std::min(y0 + 1, level.height - 1);
+        const double fy = y - y0;
+        const int width = (int) level.width;
+        const unsigned int x0 = (unsigned int) ((((int) xFloor % width) + width) % width);
+        const unsigned int x1 = (x0 + 1) % level.width;
+
+        const double w00 = weight * (1.0 - fx) * (1.0 - fy);
+        const double w10 = weight * fx * (1.0 - fy);
+        const double w01 = weight * (1.0 - fx) * fy;
+        const double w11 = weight * fx * fy;
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            color[c] += w00 * level.at(x0, y0, c) + w10 * level.at(x1, y0, c) +
+                        w01 * level.at(x0, y1, c) + w11 * level.at(x1, y1, c);
+        }
+    }
+
+  private:
+    vector<Level> _levels;
+};
+
+// Light directions of the GGX lobe around the normal (0, 0, 1), for a view
+// direction equal to the normal, stored as separate arrays of components
+// so that their transformation to each texel vectorizes.
+struct LobeSamples
+{
+    vector<double> x;
+    vector<double> y;
+    vector<double> z;
+    vector<double> lod;
+};
+
+LobeSamples createLobeSamples(double alpha, unsigned int sampleCount, const SourceMips& source)
+{
+    // Solid angle of a source texel on the equator.
+    const double texelSolidAngle = 2.0 * PI * PI / ((double) source.getWidth() * source.getHeight());
+    const double alpha2 = alpha * alpha;
+
+    LobeSamples samples;
+    for (unsigned int i = 0; i < sampleCount; i++)
+    {
+        // Generate a spherical Fibonacci point, as in mx_spherical_fibonacci.
+        double xi0 = (i + 0.5) / sampleCount;
+        double xi1 = std::fmod((i + 1.0) * GOLDEN_RATIO, 1.0);
+
+        // Importance sample the GGX distribution, as in mx_ggx_importance_sample_NDF.
+        double phi = 2.0 * PI * xi0;
+        double tanTheta = std::sqrt(xi1 / (1.0 - xi1));
+        double hx = tanTheta * alpha * std::cos(phi);
+        double hy = tanTheta * alpha * std::sin(phi);
+        double hLength = std::sqrt(hx * hx + hy * hy + 1.0);
+        hx /= hLength;
+        hy /= hLength;
+        double hz = 1.0 / hLength;
+
+        // Reflect the view direction about the half vector.
+        double lz = 2.0 * hz * hz - 1.0;
+        if (lz <= 0.0)
+        {
+            continue;
+        }
+
+        // Compute the source mip level from the solid angle of the sample,
+        // where the probability density of the light direction is D / 4.
+        double ndf = alpha2 / (PI * std::pow(hz * hz * (alpha2 - 1.0) + 1.0, 2.0));
+        double sampleSolidAngle = 4.0 / (sampleCount * ndf);
+        samples.x.push_back(2.0 * hz * hx);
+        samples.y.push_back(2.0 * hz * hy);
+        samples.z.push_back(lz);
+        samples.lod.push_back(0.5 * std::log2(sampleSolidAngle / texelSolidAngle) + SAMPLE_LOD_BIAS);
+    }
+    return samples;
+}
+
+Vector3d crossProduct(const Vector3d& v1, const Vector3d& v2)
+{
+    return Vector3d(v1[1] * v2[2] - v1[2] * v2[1],
+                    v1[2] * v2[0] - v1[0] * v2[2],
+                    v1[0] * v2[1] - v1[1] * v2[0]);
+}
+
+// Return the direction of the center of a texel in a lat-long map, following
+// mx_latlong_projection.
+Vector3d texelDirection(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    double theta = PI * (y + 0.5) / height;
+    double phi = 2.0 * PI * ((x + 0.5) / width - 0.5);
+    return Vector3d(std::sin(theta) * std::sin(phi), std::cos(theta), -std::sin(theta) * std::cos(phi));
+}
+
+// Prefilter a single level of the chain.
+ImagePtr prefilterLevel(const SourceMips& source, unsigned int width, unsigned int height,
+                        double alpha, unsigned int sampleCount)
+{
+    ImagePtr image = Image::create(width, height, 3, Image::BaseType::FLOAT);
+    image->createResourceBuffer();
+
+    // Unfiltered levels are downsampled from the source level matching their
+    // resolution.
+    const double baseLod = std::max(std::log2((double) source.getWidth() / width), 0.0);
+    const LobeSamples samples = alpha > 0.0 ? createLobeSamples(alpha, sampleCount, source) : LobeSamples();
+    const size_t count = samples.x.size();
+
+    forEachImageRowBlock(width, height, ROWS_PER_TASK, [&](size_t, unsigned int begin, unsigned int end)
+    {
+        vector<float> row((size_t) width * 3);
+        vector<double> dirX(count), dirY(count), dirZ(count);
+        for (unsigned int y = begin; y < end; y++)
+        {
+            for (unsigned int x = 0; x < width; x++)
+            {
+                const Vector3d n = texelDirection(x, y, width, height);
+                double color[3] = { 0.0, 0.0, 0.0 };
+                if (!count)
+                {
+                    double v = std::acos(std::min(std::max(n[1], -1.0), 1.0)) / PI;
+                    double u = std::atan2(n[0], -n[2]) / (2.0 * PI) + 0.5;
+                    source.addSample(u, v, baseLod, 1.0, color);
+                    std::copy(color, color + 3, &row[x * 3]);
+                    continue;
+                }
+
+                // Build a tangent frame around the texel direction.
+                const Vector3d up = std::abs(n[1]) < 0.999 ? Vector3d(0.0, 1.0, 0.0) : Vector3d(1.0, 0.0, 0.0);
+                const Vector3d t = crossProduct(up, n).getNormalized();
+                const Vector3d b = crossProduct(n, t);
+
+                // Transform the lobe to the texel direction.
+                for (size_t i = 0; i < count; i++)
+                {
+                    dirX[i] = samples.x[i] * t[0] + samples.y[i] * b[0] + samples.z[i] * n[0];
+                    dirY[i] = samples.x[i] * t[1] + samples.y[i] * b[1] + samples.z[i] * n[1];
+                    dirZ[i] = samples.x[i] * t[2] + samples.y[i] * b[2] + samples.z[i] * n[2];
+                }
+
+                // Accumulate samples weighted by the cosine of the light direction.
+                double weightSum = 0.0;
+                for (size_t i = 0; i < count; i++)
+                {
+                    double dirYClamped = std::min(std::max(dirY[i], -1.0), 1.0);
+                    double v = std::acos(dirYClamped) / PI;
+                    double u = std::atan2(dirX[i], -dirZ[i]) / (2.0 * PI) + 0.5;
+                    double sinTheta = std::max(std::sqrt(1.0 - dirYClamped * dirYClamped), MIN_SIN_THETA);
+                    double lod = std::max(samples.lod[i] - 0.5 * std::log2(sinTheta), 0.0);
+                    source.addSample(u, v, lod, samples.z[i], color);
+                    weightSum += samples.z[i];
+                }
+                for (unsigned int c = 0; c < 3; c++)
+                {
+                    row[x * 3 + c] = (float) (color[c] / weightSum);
+                }
+            }
+            image->setRowValues(y, row.data());
+        }
+    });
+
+    return image;
+}
+
+} // anonymous namespace
+
+ImageVec prefilterEnvironment(ConstImagePtr env, unsigned int width, unsigned int sampleCount)
+{
+    if (width < MIN_LEVEL_WIDTH || (width & (width - 1)))
+    {
+        throw Exception("Prefiltered environment width must be a power of two of at least " +
+                        std::to_string(MIN_LEVEL_WIDTH));
+    }
+    if (!sampleCount)
+    {
+        throw Exception("Invalid sample count in prefilterEnvironment");
+    }
+
+    SourceMips source(*env);
+    ImageVec levels;
+    const unsigned int levelCount = getPrefilterLevelCount(width);
+    for (unsigned int level = 0; level < levelCount; level++)
+    {
+        levels.push_back(prefilterLevel(source, width >> level, width >> (level + 1),
+                                        getPrefilterRoughness(level, levelCount), sampleCount));
+    }
+    return levels;
+}
+
+unsigned int getPrefilterLevelCount(unsigned int width)
+{
+    unsigned int levelCount = 0;
+    for (; width >= MIN_LEVEL_WIDTH; width /= 2)
+    {
+        levelCount++;
+    }
+    return levelCount;
+}
+
+float getPrefilterRoughness(unsigned int level, unsigned int levelCount)
+{
+    if (levelCount <= 1)
+    {
+        return 0.0f;
+    }
+    float t = std::min((float) level / (float) (levelCount - 1), 1.0f);
+    return t * t;
+}
+
+ImagePtr createPrefilterAtlas(const ImageVec& levels)
+{
+    if (levels.empty())
+    {
+        throw Exception("Empty prefiltered chain in createPrefilterAtlas");
+    }
+    const unsigned int width = levels[0]->getWidth();
+    const unsigned int channelCount = levels[0]->getChannelCount();
+    if (levels.size() != getPrefilterLevelCount(width) || (width & (width - 1)))
+    {
+        throw Exception("Invalid level count in createPrefilterAtlas");
+    }
+    unsigned int atlasHeight = 0;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        const ImagePtr& level = levels[i];
+        if (level->getWidth() != width >> i || level->getHeight() != width >> (i + 1) ||
+            level->getChannelCount() != channelCount)
+        {
+            throw Exception("Invalid level dimensions in createPrefilterAtlas");
+        }
+        atlasHeight += level->getHeight();
+    }
+
+    ImagePtr atlas = Image::create(width, atlasHeight, channelCount, levels[0]->getBaseType());
+    atlas->createResourceBuffer();
+    vector<float> row((size_t) width * channelCount);
+    unsigned int atlasY = 0;
+    for (const ImagePtr& level : levels)
+    {
+        std::fill(row.begin(), row.end(), 0.0f);
+        for (unsigned int y = 0; y < level->getHeight(); y++, atlasY++)
+        {
+            level->getRowValues(y, row.data());
+            atlas->setRowValues(atlasY, row.data());
+        }
+    }
+    return atlas;
+}
+
+bool savePrefilteredEnvironment(ImageHandlerPtr imageHandler, const FilePath& filePath, const ImageVec& levels)
+{
+    return imageHandler->saveImage(filePath, createPrefilterAtlas(levels));
+}
+
+} // namespace MaterialX
@@ -0,0 +1,64 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#ifndef MATERIALX_ENVIRONMENTPREFILTER_H
+#define MATERIALX_ENVIRONMENTPREFILTER_H
+
+/// @file
+/// Prefiltering of environment maps for specular lighting
+
+#include <MaterialXRender/Export.h>
+#include <MaterialXRender/ImageHandler.h>
+
+namespace MaterialX
+{
+
+/// Prefilter an environment map by the GGX distribution, returning a chain
+/// of lat-long maps of decreasing resolution and increasing roughness.
+///
+/// Each level of the chain halves the resolution of the previous level, down
+/// to a width of eight texels, and stores the radiance reflected towards each
+/// direction by a GGX lobe centered on that direction, with the roughness
+/// returned by getPrefilterRoughness.  The lobe is integrated by filtered
+/// importance sampling of the environment, using the sample distribution of
+/// the FIS specular environment method.  Rows of each level are filtered
+/// concurrently.
+///
+/// Texels follow the lat-long projection of generated hardware shaders, with
+/// the first row of each level in the upward direction.
+///
+/// @param env An environment map in lat-long format.
+/// @param width The width of the first level of the chain, which must be a
+///    power of two of at least eight.  The height of each level is half its
+///    width.
+/// @param sampleCount The number of GGX samples per texel.
+/// @return The levels of the chain, as three-channel float images.
+/// @throws Exception if the width is invalid.
+MX_RENDER_API ImageVec prefilterEnvironment(ConstImagePtr env, unsigned int width, unsigned int sampleCount = 256);
+
+/// Return the number of levels in a prefiltered chain with the given width
+/// at its first level.
+MX_RENDER_API unsigned int getPrefilterLevelCount(unsigned int width);
+
+/// Return the GGX roughness of the given level of a prefiltered chain, which
+/// rises from zero at the first level to one at the last level, linearly in
+/// the square root of roughness.
+MX_RENDER_API float getPrefilterRoughness(unsigned int level, unsigned int levelCount);
+
+/// Pack the levels of a prefiltered chain into a single image, with levels
+/// stacked vertically from the first level at the top.  This is the format
+/// of the radiance map expected by the SPECULAR_ENVIRONMENT_PREFILTER_GGX
+/// specular environment method of generated hardware shaders.
+/// @throws Exception if the levels do not form a prefiltered chain.
+MX_RENDER_API ImagePtr createPrefilterAtlas(const ImageVec& levels);
+
+/// Save the levels of a prefiltered chain to the given file path, as a single
+/// image in the format of createPrefilterAtlas.
+/// @return True if the image was saved by the given image handler.
+MX_RENDER_API bool savePrefilteredEnvironment(ImageHandlerPtr imageHandler, const FilePath& filePath, const ImageVec& levels);
+
+} // namespace MaterialX
+
+#endif
@@ -5,6 +5,10 @@
 
 #include <MaterialXRender/Harmonics.h>
 
+#include <MaterialXCore/Exception.h>
+#include <MaterialXCore/Util.h>
+
+#include <cstring>
 #include <iostream>
 
 namespace MaterialX
@@ -26,6 +30,13 @@ const double COSINE_CONSTANT_2 = 1.0 / 4.0;
 
 const Color3d LUMA_COEFFS_REC709(0.2126, 0.7152, 0.0722);
 
+// Number of rows processed by each task of a projection.
+const unsigned int ROWS_PER_TASK = 16;
+
+// Number of independent lanes used in hashing image contents.
+const size_t HASH_LANES = 4;
+const uint64_t HASH_PRIME = 1099511628211ULL;
+
 double imageXToPhi(unsigned int x, unsigned int width)
 {
     // Align spherical coordinates with texel centers by adding 0.5.
@@ -82,125 +93,142 @@ Sh3ScalarCoeffs evalDirection(const Vector3d& dir)
     });
 }
 
-} // anonymous namespace
-
-Sh3ColorCoeffs projectEnvironment(ConstImagePtr env, bool irradiance)
+// Tables of the longitude terms of the SH basis, per column of a lat-long map.
+struct ColumnBasis
 {
-    Sh3ColorCoeffs shEnv;
-
-    for (unsigned int y = 0; y < env->getHeight(); y++)
+    explicit ColumnBasis(unsigned int width) :
+        cosPhi(width),
+        sinPhi(width),
+        cosCosPhi(width),
+        sinCosPhi(width),
+        sinSinPhi(width)
     {
-        double theta = imageYToTheta(y, env->getHeight());
-        double texelWeight = texelSolidAngle(y, env->getWidth(), env->getHeight());
-
-        for (unsigned int x = 0; x < env->getWidth(); x++)
+        for (unsigned int x = 0; x < width; x++)
         {
-            // Sample the color at these coordinates.
-            Color4 color = env->getTexelColor(x, y);
-
-            // Compute the direction vector.
-            double phi = imageXToPhi(x, env->getWidth());
-            Vector3d dir = sphericalToCartesian(theta, phi);
-
-            // Evaluate the given direction as SH coefficients.
-            Sh3ScalarCoeffs shDir = evalDirection(dir);
-
-            // Combine color with texel weight.
-            Color3d weightedColor(color[0] * texelWeight,
-                                  color[1] * texelWeight,
-                                  color[2] * texelWeight);
+            double phi = imageXToPhi(x, width);
+            cosPhi[x] = std::cos(phi);
+            sinPhi[x] = std::sin(phi);
+            cosCosPhi[x] = cosPhi[x] * cosPhi[x];
+            sinCosPhi[x] = sinPhi[x] * cosPhi[x];
+            sinSinPhi[x] = sinPhi[x] * sinPhi[x];
+        }
+    }
 
-            // Update coefficients for the influence of this texel.
-            for (size_t i = 0; i < shEnv.NUM_COEFFS; i++)
-            {
-                shEnv[i] += weightedColor * shDir[i];
-            }
+    vector<double> cosPhi;
+    vector<double> sinPhi;
+    vector<double> cosCosPhi;
+    vector<double> sinCosPhi;
+    vector<double> sinSinPhi;
+};
+
+// Project a row of a lat-long map to SH.  The signal of each color channel
+// is reduced to its moments against the longitude terms of the basis, which
+// are then combined with the latitude terms of the row.
+Sh3ColorCoeffs projectRow(const float* row, unsigned int y, unsigned int width, unsigned int height,
+                          unsigned int channelCount, const ColumnBasis& basis)
+{
+    // Channels are expanded to colors as in Image::getTexelColor.
+    const unsigned int sourceChannels = std::min(channelCount, 3u);
+    double moments[3][6] = { };
+    for (unsigned int c = 0; c < sourceChannels; c++)
+    {
+        double m0 = 0.0, m1 = 0.0, m2 = 0.0, m3 = 0.0, m4 = 0.0, m5 = 0.0;
+        for (unsigned int x = 0; x < width; x++)
+        {
+            double value = row[x * channelCount + c];
+            m0 += value;
+            m1 += value * basis.cosPhi[x];
+            m2 += value * basis.sinPhi[x];
+            m3 += value * basis.cosCosPhi[x];
+            m4 += value * basis.sinCosPhi[x];
+            m5 += value * basis.sinSinPhi[x];
         }
+        double* m = moments[c];
+        m[0] = m0; m[1] = m1; m[2] = m2; m[3] = m3; m[4] = m4; m[5] = m5;
+    }
+    if (channelCount == 1)
+    {
+        std::memcpy(moments[1], moments[0], sizeof(moments[0]));
+        std::memcpy(moments[2], moments[0], sizeof(moments[0]));
     }
 
-    // If irradiance is requested, then apply constant factors to convolve the
-    // signal by a clamped cosine kernel.
-    if (irradiance)
+    const double theta = imageYToTheta(y, height);
+    const double s = std::sin(theta);
+    const double k = std::cos(theta);
+    const double weight = texelSolidAngle(y, width, height);
+
+    Sh3ColorCoeffs shRow;
+    for (size_t c = 0; c < 3; c++)
     {
-        shEnv[0] *= COSINE_CONSTANT_0;
-        shEnv[1] *= COSINE_CONSTANT_1;
-        shEnv[2] *= COSINE_CONSTANT_1;
-        shEnv[3] *= COSINE_CONSTANT_1;
-        shEnv[4] *= COSINE_CONSTANT_2;
-        shEnv[5] *= COSINE_CONSTANT_2;
-        shEnv[6] *= COSINE_CONSTANT_2;
-        shEnv[7] *= COSINE_CONSTANT_2;
-        shEnv[8] *= COSINE_CONSTANT_2;
+        const double* m = moments[c];
+        shRow[0][c] = weight * BASIS_CONSTANT_0 * m[0];
+        shRow[1][c] = weight * BASIS_CONSTANT_1 * -k * m[0];
+        shRow[2][c] = weight * BASIS_CONSTANT_1 * s * m[1];
+        shRow[3][c] = weight * BASIS_CONSTANT_1 * -s * m[2];
+        shRow[4][c] = weight * BASIS_CONSTANT_2 * s * k * m[2];
+        shRow[5][c] = weight * BASIS_CONSTANT_2 * -s * k * m[1];
+        shRow[6][c] = weight * BASIS_CONSTANT_3 * (3.0 * s * s * m[3] - m[0]);
+        shRow[7][c] = weight * BASIS_CONSTANT_2 * -s * s * m[4];
+        shRow[8][c] = weight * BASIS_CONSTANT_4 * (s * s * m[5] - k * k * m[0]);
     }
+    return shRow;
+}
 
+// Scale the given coefficients to convolve their signal by a clamped cosine
+// kernel.
+Sh3ColorCoeffs convolveIrradiance(Sh3ColorCoeffs shEnv)
+{
+    shEnv[0] *= COSINE_CONSTANT_0;
+    shEnv[1] *= COSINE_CONSTANT_1;
+    shEnv[2] *= COSINE_CONSTANT_1;
+    shEnv[3] *= COSINE_CONSTANT_1;
+    shEnv[4] *= COSINE_CONSTANT_2;
+    shEnv[5] *= COSINE_CONSTANT_2;
+    shEnv[6] *= COSINE_CONSTANT_2;
+    shEnv[7] *= COSINE_CONSTANT_2;
+    shEnv[8] *= COSINE_CONSTANT_2;
     return shEnv;
 }
 
-ImagePtr normalizeEnvironment(ConstImagePtr env, float envRadiance, float maxTexelRadiance)
+// Scale the texels of a row whose radiance exceeds the given maximum,
+// returning the total radiance of the row weighted by texel solid angle.
+double clampRowRadiance(float* row, unsigned int y, unsigned int width, unsigned int height,
+                        unsigned int channelCount, float maxTexelRadiance)
 {
-    // Compute the radiance of the original environment map.
-    double origEnvRadiance = 0.0;
-    for (unsigned int y = 0; y < env->getHeight(); y++)
+    const double texelWeight = texelSolidAngle(y, width, height);
+    double rowRadiance = 0.0;
+    for (unsigned int x = 0; x < width; x++)
     {
-        double texelWeight = texelSolidAngle(y, env->getWidth(), env->getHeight());
-
-        for (unsigned int x = 0; x < env->getWidth(); x++)
+        // Expand channels to a color as in Image::getTexelColor.
+        float* texel = row + x * channelCount;
+        Color3d color(texel[0],
+                      channelCount > 1 ? texel[1] : texel[0],
+                      channelCount > 2 ? texel[2] : (channelCount > 1 ? 0.0 : texel[0]));
+
+        // Apply maximum texel radiance.
+        double texelRadiance = color.dot(LUMA_COEFFS_REC709);
+        if ((float) texelRadiance > maxTexelRadiance)
         {
-            // Sample the color at these coordinates.
-            Color4 color = env->getTexelColor(x, y);
-
-            // Apply maximum texel radiance.
-            double texelRadiance = Color3d(color[0], color[1], color[2]).dot(LUMA_COEFFS_REC709);
-            if ((float) texelRadiance > maxTexelRadiance)
+            float scale = maxTexelRadiance / (float) texelRadiance;
+            for (unsigned int c = 0; c < std::min(channelCount, 4u); c++)
             {
-                color *= maxTexelRadiance / (float) texelRadiance;
+                texel[c] *= scale;
             }
-
-            // Combine color with texel weight.
-            Color3d weightedColor(color[0] * texelWeight,
-                                  color[1] * texelWeight,
-                                  color[2] * texelWeight);
-
-            // Add to environment radiance.
-            double texelContribution = weightedColor.dot(LUMA_COEFFS_REC709);
-            origEnvRadiance += texelContribution;
+            color = Color3d(color[0] * scale, color[1] * scale, color[2] * scale);
         }
-    }
 
-    // Generate the normalized map.
-    ImagePtr normEnv = Image::create(env->getWidth(), env->getHeight(), env->getChannelCount(), env->getBaseType());
-    normEnv->createResourceBuffer();
-    float envNormFactor = origEnvRadiance ? (float) (envRadiance / origEnvRadiance) : 1.0f;
-    for (unsigned int y = 0; y < env->getHeight(); y++)
-    {
-        for (unsigned int x = 0; x < env->getWidth(); x++)
-        {
-            // Sample the color at these coordinates.
-            Color4 color = env->getTexelColor(x, y);
-
-            // Apply maximum texel radiance.
-            double texelRadiance = Color3d(color[0], color[1], color[2]).dot(LUMA_COEFFS_REC709);
-            if ((float) texelRadiance > maxTexelRadiance)
-            {
-                color *= maxTexelRadiance / (float) texelRadiance;
-            }
-
-            // Store the normalized color.
-            normEnv->setTexelColor(x, y, color * envNormFactor);
-        }
+        // Add the weighted texel to the row radiance.
+        rowRadiance += (color * texelWeight).dot(LUMA_COEFFS_REC709);
     }
-
-    return normEnv;
+    return rowRadiance;
 }
 
-void computeDominantLight(ConstImagePtr env, Vector3& lightDir, Color3& lightColor)
+// Compute the dominant light of an environment from its projection to SH.
+void computeShDominantLight(const Sh3ColorCoeffs& shEnv, Vector3& lightDir, Color3& lightColor)
 {
     // Reference:
     //   https://seblagarde.wordpress.com/2011/10/09/dive-in-sh-buffer-idea/
 
-    // Project the environment to spherical harmonics.
-    Sh3ColorCoeffs shEnv = projectEnvironment(env);
-
     // Handle empty environments.
     if (shEnv == Sh3ColorCoeffs())
     {
@@ -232,6 +260,138 @@ void computeDominantLight(ConstImagePtr env, Vector3& lightDir, Color3& lightCol
     lightColor = Color3((float) color[0], (float) color[1], (float) color[2]);
 }
 
+// Compute a hash of the format and contents of an image.  Each block of
+// rows is hashed separately, with independent lanes over 64-bit words, and
+// block hashes are combined in order, so that the result does not depend
+// on the thread count.
+uint64_t computeImageHash(const Image& image)
+{
+    const size_t rowStride = image.getRowStride();
+    const size_t blockCount = (image.getHeight() + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    vector<uint64_t> blockHashes(blockCount);
+    forEachImageRowBlock(image.getWidth(), image.getHeight(), ROWS_PER_TASK, [&](size_t block, unsigned int begin, unsigned int end)
+    {
+        const char* data = static_cast<const char*>(image.getResourceBuffer()) + begin * rowStride;
+        const size_t size = (end - begin) * rowStride;
+        const size_t laneBytes = HASH_LANES * sizeof(uint64_t);
+        const size_t wordBytes = size - size % laneBytes;
+        uint64_t lanes[HASH_LANES];
+        for (size_t i = 0; i < HASH_LANES; i++)
+        {
+            lanes[i] = computeContentHash(reinterpret_cast<const char*>(&i), sizeof(i));
+        }
+        for (size_t offset = 0; offset < wordBytes; offset += laneBytes)
+        {
+            uint64_t words[HASH_LANES];
+            std::memcpy(words, data + offset, laneBytes);
+            for (size_t i = 0; i < HASH_LANES; i++)
+            {
+                lanes[i] = (lanes[i] ^ words[i]) * HASH_PRIME;
+            }
+        }
+        uint64_t hash = computeContentHash(reinterpret_cast<const char*>(lanes), sizeof(lanes));
+        blockHashes[block] = computeContentHash(data + wordBytes, size - wordBytes, hash);
+    });
+
+    const unsigned int format[] =
+    {
+        image.getWidth(),
+        image.getHeight(),
+        image.getChannelCount(),
+        (unsigned int) image.getBaseType()
+    };
+    uint64_t hash = computeContentHash(reinterpret_cast<const char*>(format), sizeof(format));
+    return computeContentHash(reinterpret_cast<const char*>(blockHashes.data()), blockHashes.size() * sizeof(uint64_t), hash);
+}
+
+} // anonymous namespace
+
+Sh3ColorCoeffs projectEnvironment(ConstImagePtr env, bool irradiance)
+{
+    const unsigned int width = env->getWidth();
+    const unsigned int height = env->getHeight();
+    const unsigned int channelCount = env->getChannelCount();
+    const ColumnBasis basis(width);
+
+    // Project each row separately, and combine the rows in order, so that
+    // the result does not depend on the thread count.
+    vector<Sh3ColorCoeffs> shRows(height);
+    forEachImageRowBlock(width, height, ROWS_PER_TASK, [&](size_t, unsigned int begin, unsigned int end)
+    {
+        vector<float> row((size_t) width * channelCount);
+        for (unsigned int y = begin; y < end; y++)
+        {
+            env->getRowValues(y, row.data());
+            shRows[y] = projectRow(row.data(), y, width, height, channelCount, basis);
+        }
+    });
+
+    Sh3ColorCoeffs shEnv;
+    for (const Sh3ColorCoeffs& shRow : shRows)
+    {
+        for (size_t i = 0; i < shEnv.NUM_COEFFS; i++)
+        {
+            shEnv[i] += shRow[i];
+        }
+    }
+
+    // If irradiance is requested, then apply constant factors to convolve the
+    // signal by a clamped cosine kernel.
+    return irradiance ? convolveIrradiance(shEnv) : shEnv;
+}
+
+ImagePtr normalizeEnvironment(ConstImagePtr env, float envRadiance, float maxTexelRadiance)
+{
+    const unsigned int width = env->getWidth();
+    const unsigned int height = env->getHeight();
+    const unsigned int channelCount = env->getChannelCount();
+
+    // Compute the radiance of the original environment map, combining the
+    // radiance of rows in order.
+    vector<double> rowRadiances(height);
+    forEachImageRowBlock(width, height, ROWS_PER_TASK, [&](size_t, unsigned int begin, unsigned int end)
+    {
+        vector<float> row((size_t) width * channelCount);
+        for (unsigned int y = begin; y < end; y++)
+        {
+            env->getRowValues(y, row.data());
+            rowRadiances[y] = clampRowRadiance(row.data(), y, width, height, channelCount, maxTexelRadiance);
+        }
+    });
+    double origEnvRadiance = 0.0;
+    for (double rowRadiance : rowRadiances)
+    {
+        origEnvRadiance += rowRadiance;
+    }
+
+    // Generate the normalized map.
+    ImagePtr normEnv = Image::create(width, height, channelCount, env->getBaseType());
+    normEnv->createResourceBuffer();
+    float envNormFactor = origEnvRadiance ? (float) (envRadiance / origEnvRadiance) : 1.0f;
+    forEachImageRowBlock(width, height, ROWS_PER_TASK, [&](size_t, unsigned int begin, unsigned int end)
+    {
+        vector<float> row((size_t) width * channelCount);
+        for (unsigned int y = begin; y < end; y++)
+        {
+            env->getRowValues(y, row.data());
+            clampRowRadiance(row.data(), y, width, height, channelCount, maxTexelRadiance);
+            for (float& value : row)
+            {
+                value *= envNormFactor;
+            }
+            normEnv->setRowValues(y, row.data());
+        }
+    });
+
+    return normEnv;
+}
+
+void computeDominantLight(ConstImagePtr env, Vector3& lightDir, Color3& lightColor)
+{
+    // Project the environment to spherical harmonics.
+    computeShDominantLight(projectEnvironment(env), lightDir, lightColor);
+}
+
 ImagePtr renderEnvironment(const Sh3ColorCoeffs& shEnv, unsigned int width, unsigned int height)
 {
     ImagePtr env = Image::create(width, height, 3, Image::BaseType::FLOAT);
@@ -331,4 +491,67 @@ ImagePtr renderReferenceIrradiance(ConstImagePtr env, unsigned int width, unsign
     return outImage;
 }
 
+//
+// ShProjectionCache methods
+//
+
+ShProjectionCache::ShProjectionCache() :
+    _hitCount(0),
+    _missCount(0)
+{
+}
+
+Sh3ColorCoeffs ShProjectionCache::projectEnvironment(ConstImagePtr env, bool irradiance)
+{
+    if (!env->getResourceBuffer())
+    {
+        throw Exception("Invalid resource buffer in projectEnvironment");
+    }
+    const uint64_t hash = computeImageHash(*env);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _coeffs.find(hash);
+        if (it != _coeffs.end())
+        {
+            _hitCount++;
+            return irradiance ? convolveIrradiance(it->second) : it->second;
+        }
+    }
+
+    // Project outside of the lock, so that distinct environments may be
+    // projected concurrently.
+    Sh3ColorCoeffs shEnv = MaterialX::projectEnvironment(env);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _coeffs[hash] = shEnv;
+        _missCount++;
+    }
+    return irradiance ? convolveIrradiance(shEnv) : shEnv;
+}
+
+void ShProjectionCache::computeDominantLight(ConstImagePtr env, Vector3& lightDir, Color3& lightColor)
+{
+    computeShDominantLight(projectEnvironment(env), lightDir, lightColor);
+}
+
+size_t ShProjectionCache::getHitCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hitCount;
+}
+
+size_t ShProjectionCache::getMissCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _missCount;
+}
+
+void ShProjectionCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _coeffs.clear();
+    _hitCount = 0;
+    _missCount = 0;
+}
+
 } // namespace MaterialX
@@ -13,6 +13,8 @@
 #include <MaterialXRender/Image.h>
 #include <MaterialXRender/Types.h>
 
+#include <mutex>
+
 namespace MaterialX
 {
 
@@ -63,7 +65,8 @@ using Sh3ScalarCoeffs = ShCoeffs<double, 3>;
 using Sh3ColorCoeffs = ShCoeffs<Color3d, 3>;
 
 /// Project an environment map to third-order SH, with an optional convolution
-/// to convert radiance to irradiance.
+/// to convert radiance to irradiance.  Rows of large maps are projected
+/// concurrently, and the result is identical for any number of threads.
 /// @param env An environment map in lat-long format.
 /// @param irradiance If true, then the returned signal will be convolved
 ///    by a clamped cosine kernel to generate irradiance.
@@ -98,6 +101,52 @@ MX_RENDER_API ImagePtr renderEnvironment(const Sh3ColorCoeffs& shEnv, unsigned i
 /// @return An irradiance map in the lat-long format.
 MX_RENDER_API ImagePtr renderReferenceIrradiance(ConstImagePtr env, unsigned int width, unsigned int height);
 
+/// A shared pointer to an ShProjectionCache
+using ShProjectionCachePtr = shared_ptr<class ShProjectionCache>;
+
+/// @class ShProjectionCache
+/// A thread-safe cache of the spherical harmonic projections of environment
+/// maps, keyed by a hash of the format and texels of each map, so that
+/// repeated projections of an environment skip all but the hashing of its
+/// texels.  Entries are retained until the cache is cleared.
+class MX_RENDER_API ShProjectionCache
+{
+  public:
+    ShProjectionCache();
+    ~ShProjectionCache() { }
+
+    /// Create a new SH projection cache.
+    static ShProjectionCachePtr create()
+    {
+        return std::make_shared<ShProjectionCache>();
+    }
+
+    /// Project an environment map to third-order SH, returning the cached
+    /// projection if the same environment has been projected before.
+    /// @see MaterialX::projectEnvironment
+    Sh3ColorCoeffs projectEnvironment(ConstImagePtr env, bool irradiance = false);
+
+    /// Compute the dominant light direction and color of an environment map,
+    /// using the cached projection of the environment.
+    /// @see MaterialX::computeDominantLight
+    void computeDominantLight(ConstImagePtr env, Vector3& lightDir, Color3& lightColor);
+
+    /// Return the number of projections served from the cache.
+    size_t getHitCount() const;
+
+    /// Return the number of projections computed and added to the cache.
+    size_t getMissCount() const;
+
+    /// Clear all projections from the cache.
+    void clear();
+
+  protected:
+    std::unordered_map<uint64_t, Sh3ColorCoeffs> _coeffs;
+    size_t _hitCount;
+    size_t _missCount;
+    mutable std::mutex _mutex;
+};
+
 } // namespace MaterialX
 
 #endif
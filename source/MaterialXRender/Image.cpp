@@ -9,16 +9,286 @@
 
 #include <MaterialXGenShader/Nodes/ConvolutionNode.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstring>
+#include <exception>
+#include <functional>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 namespace MaterialX
 {
 
+namespace {
+
+// Number of rows processed by each task of an image kernel.
+const unsigned int ROWS_PER_TASK = 32;
+
+// Images with fewer texels than this are processed on a single thread.
+const size_t MIN_PARALLEL_TEXELS = 256 * 256;
+
+//
+// Conversion of rows between base types and normalized floats.
+//
+
+template <class T> struct TexelTraits
+{
+    // Integer types are normalized to [0, 1].
+    static constexpr float MAX_VALUE = (float) std::numeric_limits<T>::max();
+
+    static float toFloat(T value)
+    {
+        return value / MAX_VALUE;
+    }
+
+    static T fromFloat(float value)
+    {
+        return (T) std::round(std::min(std::max(value, 0.0f), 1.0f) * MAX_VALUE);
+    }
+};
+
+template <class T> constexpr float TexelTraits<T>::MAX_VALUE;
+
+template <> struct TexelTraits<Half>
+{
+    static float toFloat(Half value)
+    {
+        return value;
+    }
+
+    static Half fromFloat(float value)
+    {
+        return Half(value);
+    }
+};
+
+template <> struct TexelTraits<float>
+{
+    static float toFloat(float value)
+    {
+        return value;
+    }
+
+    static float fromFloat(float value)
+    {
+        return value;
+    }
+};
+
+template <class T> void loadRowTyped(const void* src, size_t count, float* dst)
+{
+    const T* data = static_cast<const T*>(src);
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = TexelTraits<T>::toFloat(data[i]);
+    }
+}
+
+template <class T> void storeRowTyped(const float* src, size_t count, void* dst)
+{
+    T* data = static_cast<T*>(dst);
+    for (size_t i = 0; i < count; i++)
+    {
+        data[i] = TexelTraits<T>::fromFloat(src[i]);
+    }
+}
+
+// Load a row of the given image as normalized floats, with the channels of
+// each texel interleaved.
+void loadRow(const Image& image, unsigned int y, float* dst)
+{
+    const size_t count = (size_t) image.getWidth() * image.getChannelCount();
+    const void* src = static_cast<const uint8_t*>(image.getResourceBuffer()) + (size_t) y * image.getRowStride();
+    switch (image.getBaseType())
+    {
+        case Image::BaseType::UINT8: loadRowTyped<uint8_t>(src, count, dst); break;
+        case Image::BaseType::UINT16: loadRowTyped<uint16_t>(src, count, dst); break;
+        case Image::BaseType::HALF: loadRowTyped<Half>(src, count, dst); break;
+        case Image::BaseType::FLOAT: loadRowTyped<float>(src, count, dst); break;
+    }
+}
+
+// Store a row of normalized floats to the given image.
+void storeRow(Image& image, unsigned int y, const float* src)
+{
+    const size_t count = (size_t) image.getWidth() * image.getChannelCount();
+    void* dst = static_cast<uint8_t*>(image.getResourceBuffer()) + (size_t) y * image.getRowStride();
+    switch (image.getBaseType())
+    {
+        case Image::BaseType::UINT8: storeRowTyped<uint8_t>(src, count, dst); break;
+        case Image::BaseType::UINT16: storeRowTyped<uint16_t>(src, count, dst); break;
+        case Image::BaseType::HALF: storeRowTyped<Half>(src, count, dst); break;
+        case Image::BaseType::FLOAT: storeRowTyped<float>(src, count, dst); break;
+    }
+}
+
+// Check that the given image is supported by the row kernels.
+void validateKernelImage(const Image& image, const string& function)
+{
+    if (!image.getResourceBuffer())
+    {
+        throw Exception("Invalid resource buffer in " + function);
+    }
+    if (image.getChannelCount() < 1 || image.getChannelCount() > 4)
+    {
+        throw Exception("Unsupported channel count in " + function);
+    }
+}
+
+// Expand the channels of a texel to a color, following getTexelColor.
+Color4 expandTexel(const double* texel, unsigned int channelCount)
+{
+    switch (channelCount)
+    {
+        case 1: return Color4((float) texel[0], (float) texel[0], (float) texel[0], 1.0f);
+        case 2: return Color4((float) texel[0], (float) texel[1], 0.0f, 1.0f);
+        case 3: return Color4((float) texel[0], (float) texel[1], (float) texel[2], 1.0f);
+        default: return Color4((float) texel[0], (float) texel[1], (float) texel[2], (float) texel[3]);
+    }
+}
+
+//
+// Row kernels, specialized per channel count.
+//
+
+// Add the texels of a row to per-channel sums.
+template <unsigned int N> void sumRow(const float* row, unsigned int width, double* sums)
+{
+    double rowSums[N] = { };
+    for (unsigned int x = 0; x < width; x++)
+    {
+        for (unsigned int c = 0; c < N; c++)
+        {
+            rowSums[c] += row[x * N + c];
+        }
+    }
+    for (unsigned int c = 0; c < N; c++)
+    {
+        sums[c] += rowSums[c];
+    }
+}
+
+// Return true if all texels of a row match the given texel.
+template <unsigned int N> bool matchRow(const float* row, unsigned int width, const float* texel)
+{
+    for (unsigned int x = 0; x < width; x++)
+    {
+        for (unsigned int c = 0; c < N; c++)
+        {
+            if (row[x * N + c] != texel[c])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void sumRow(const float* row, unsigned int width, unsigned int channelCount, double* sums)
+{
+    switch (channelCount)
+    {
+        case 1: sumRow<1>(row, width, sums); break;
+        case 2: sumRow<2>(row, width, sums); break;
+        case 3: sumRow<3>(row, width, sums); break;
+        default: sumRow<4>(row, width, sums); break;
+    }
+}
+
+bool matchRow(const float* row, unsigned int width, unsigned int channelCount, const float* texel)
+{
+    switch (channelCount)
+    {
+        case 1: return matchRow<1>(row, width, texel);
+        case 2: return matchRow<2>(row, width, texel);
+        case 3: return matchRow<3>(row, width, texel);
+        default: return matchRow<4>(row, width, texel);
+    }
+}
+
+// Accumulate a weighted copy of a row of values into another.  Rows are
+// processed as flat arrays of channel values, so that the loop vectorizes.
+void addWeightedRow(const float* src, float weight, size_t count, float* dst)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] += weight * src[i];
+    }
+}
+
+} // anonymous namespace
+
 //
 // Global functions
 //
 
+void forEachImageRowBlock(unsigned int width, unsigned int height, unsigned int blockRows,
+                          const ImageRowBlockFunction& func, unsigned int threadCount)
+{
+    if (!blockRows)
+    {
+        throw Exception("Invalid block size in forEachImageRowBlock");
+    }
+    const size_t blockCount = (height + blockRows - 1) / blockRows;
+    auto runBlock = [&](size_t block)
+    {
+        const unsigned int begin = (unsigned int) block * blockRows;
+        func(block, begin, std::min(begin + blockRows, height));
+    };
+
+    if (!threadCount)
+    {
+        threadCount = ((size_t) width * height >= MIN_PARALLEL_TEXELS) ? std::max(std::thread::hardware_concurrency(), 1u) : 1;
+    }
+    threadCount = (unsigned int) std::min((size_t) threadCount, blockCount);
+    if (threadCount <= 1)
+    {
+        for (size_t block = 0; block < blockCount; block++)
+        {
+            runBlock(block);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextBlock(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    vector<std::thread> workers;
+    for (unsigned int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back([&]()
+        {
+            for (size_t block = nextBlock++; block < blockCount; block = nextBlock++)
+            {
+                try
+                {
+                    runBlock(block);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    nextBlock = blockCount;
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
 ImagePtr createUniformImage(unsigned int width, unsigned int height, unsigned int channelCount, Image::BaseType baseType, const Color4& color)
 {
     ImagePtr image = Image::create(width, height, channelCount, baseType);
@@ -178,6 +448,32 @@ void Image::setTexelColor(unsigned int x, unsigned int y, const Color4& color)
     }
 }
 
+void Image::getRowValues(unsigned int y, float* values) const
+{
+    if (y >= _height)
+    {
+        throw Exception("Invalid row in getRowValues");
+    }
+    if (!_resourceBuffer)
+    {
+        throw Exception("Invalid resource buffer in getRowValues");
+    }
+    loadRow(*this, y, values);
+}
+
+void Image::setRowValues(unsigned int y, const float* values)
+{
+    if (y >= _height)
+    {
+        throw Exception("Invalid row in setRowValues");
+    }
+    if (!_resourceBuffer)
+    {
+        throw Exception("Invalid resource buffer in setRowValues");
+    }
+    storeRow(*this, y, values);
+}
+
 Color4 Image::getTexelColor(unsigned int x, unsigned int y) const
 {
     if (x >= _width || y >= _height)
@@ -297,35 +593,65 @@ Color4 Image::getTexelColor(unsigned int x, unsigned int y) const
 
 Color4 Image::getAverageColor()
 {
-    Color4 averageColor;
-    for (unsigned int y = 0; y < getHeight(); y++)
+    validateKernelImage(*this, "getAverageColor");
+
+    // Sum each block of rows separately, and combine the block sums in
+    // order, so that the result does not depend on the thread count.
+    const unsigned int channelCount = getChannelCount();
+    const size_t blockCount = (getHeight() + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    vector<double> blockSums(blockCount * channelCount, 0.0);
+    forEachImageRowBlock(getWidth(), getHeight(), ROWS_PER_TASK, [&](size_t block, unsigned int begin, unsigned int end)
+    {
+        vector<float> row((size_t) getWidth() * channelCount);
+        for (unsigned int y = begin; y < end; y++)
+        {
+            loadRow(*this, y, row.data());
+            sumRow(row.data(), getWidth(), channelCount, &blockSums[block * channelCount]);
+        }
+    });
+
+    double sums[4] = { };
+    for (size_t block = 0; block < blockCount; block++)
     {
-        for (unsigned int x = 0; x < getWidth(); x++)
+        for (unsigned int c = 0; c < channelCount; c++)
         {
-            averageColor += getTexelColor(x, y);
+            sums[c] += blockSums[block * channelCount + c];
         }
     }
-    unsigned int sampleCount = getWidth() * getHeight();
-    averageColor /= (float) sampleCount;
-    return averageColor;
+    const double sampleCount = (double) getWidth() * getHeight();
+    for (unsigned int c = 0; c < channelCount; c++)
+    {
+        sums[c] /= sampleCount;
+    }
+    return expandTexel(sums, channelCount);
 }
 
 bool Image::isUniformColor(Color4* uniformColor)
 {
     Color4 refColor = getTexelColor(0, 0);
-    for (unsigned int y = 0; y < getHeight(); y++)
+    validateKernelImage(*this, "isUniformColor");
+
+    const unsigned int channelCount = getChannelCount();
+    vector<float> refRow((size_t) getWidth() * channelCount);
+    loadRow(*this, 0, refRow.data());
+    const vector<float> refTexel(refRow.begin(), refRow.begin() + channelCount);
+
+    std::atomic<bool> uniform(true);
+    forEachImageRowBlock(getWidth(), getHeight(), ROWS_PER_TASK, [&](size_t, unsigned int begin, unsigned int end)
     {
-        for (unsigned int x = 0; x < getWidth(); x++)
+        vector<float> row((size_t) getWidth() * channelCount);
+        for (unsigned int y = begin; y < end && uniform; y++)
         {
-            if (!x && !y)
+            loadRow(*this, y, row.data());
+            if (!matchRow(row.data(), getWidth(), channelCount, refTexel.data()))
             {
-                continue;
-            }
-            if (getTexelColor(x, y) != refColor)
-            {
-                return false;
+                uniform = false;
             }
         }
+    });
+    if (!uniform)
+    {
+        return false;
     }
     if (uniformColor)
     {
@@ -336,106 +662,148 @@ bool Image::isUniformColor(Color4* uniformColor)
 
 void Image::setUniformColor(const Color4& color)
 {
-    for (unsigned int y = 0; y < getHeight(); y++)
+    if (!getWidth() || !getHeight())
     {
-        for (unsigned int x = 0; x < getWidth(); x++)
-        {
-            setTexelColor(x, y, color);
-        }
+        return;
     }
-}
-
-ImagePtr Image::applyBoxBlur()
-{
-    ImagePtr blurImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    blurImage->createResourceBuffer();
-
-    for (int y = 0; y < (int) getHeight(); y++)
+    if (getChannelCount() > 4)
     {
-        for (int x = 0; x < (int) getWidth(); x++)
+        for (unsigned int y = 0; y < getHeight(); y++)
         {
-            Color4 blurColor;
-            for (int dy = -1; dy <= 1; dy++)
+            for (unsigned int x = 0; x < getWidth(); x++)
             {
-                int sy = std::min(std::max(y + dy, 0), (int) getHeight() - 1);
-                for (int dx = -1; dx <= 1; dx++)
-                {
-                    int sx = std::min(std::max(x + dx, 0), (int) getWidth() - 1);
-                    blurColor += getTexelColor(sx, sy);
-                }
+                setTexelColor(x, y, color);
             }
-            blurColor /= 9.0f;
-            blurImage->setTexelColor(x, y, blurColor);
         }
+        return;
     }
+    validateKernelImage(*this, "setUniformColor");
 
-    return blurImage;
+    // Store a single row, and copy it to all others.
+    const unsigned int channelCount = getChannelCount();
+    vector<float> row((size_t) getWidth() * channelCount);
+    for (unsigned int x = 0; x < getWidth(); x++)
+    {
+        for (unsigned int c = 0; c < channelCount; c++)
+        {
+            row[x * channelCount + c] = color[c];
+        }
+    }
+    storeRow(*this, 0, row.data());
+    uint8_t* data = static_cast<uint8_t*>(_resourceBuffer);
+    const size_t rowStride = getRowStride();
+    for (unsigned int y = 1; y < getHeight(); y++)
+    {
+        std::memcpy(data + y * rowStride, data, rowStride);
+    }
 }
 
-ImagePtr Image::applyGaussianBlur()
+ImagePtr Image::applySeparableFilter(const vector<float>& weights)
 {
-    ImagePtr blurImage1 = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    ImagePtr blurImage2 = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
-    blurImage1->createResourceBuffer();
-    blurImage2->createResourceBuffer();
+    if (weights.size() % 2 != 1)
+    {
+        throw Exception("Filter weights must have an odd size in applySeparableFilter");
+    }
+    validateKernelImage(*this, "applySeparableFilter");
 
-    for (int y = 0; y < (int) getHeight(); y++)
+    ImagePtr filterImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
+    filterImage->createResourceBuffer();
+
+    const int radius = (int) weights.size() / 2;
+    const unsigned int width = getWidth();
+    const int height = (int) getHeight();
+    const unsigned int channelCount = getChannelCount();
+    const size_t rowSize = (size_t) width * channelCount;
+    const unsigned int blockRows = std::max(ROWS_PER_TASK, (unsigned int) radius * 2);
+
+    forEachImageRowBlock(getWidth(), getHeight(), blockRows, [&](size_t, unsigned int begin, unsigned int end)
     {
-        for (int x = 0; x < (int) getWidth(); x++)
-        {
-            Color4 blurColor;
-            unsigned int weightIndex = 0;
-            for (int dy = -3; dy <= 3; dy++, weightIndex++)
+        // Filter the source rows of the block horizontally, padding each row
+        // with copies of its edge texels.
+        const int first = (int) begin - radius;
+        const int last = (int) end - 1 + radius;
+        vector<float> padded((width + 2 * radius) * channelCount);
+        vector<float> filtered((size_t) (last - first + 1) * rowSize, 0.0f);
+        for (int sy = first; sy <= last; sy++)
+        {
+            const unsigned int y = (unsigned int) std::min(std::max(sy, 0), height - 1);
+            float* paddedRow = padded.data() + radius * channelCount;
+            loadRow(*this, y, paddedRow);
+            for (int i = 0; i < radius; i++)
             {
-                int sy = std::min(std::max(y + dy, 0), (int) getHeight() - 1);
-                blurColor += getTexelColor(x, sy) * GAUSSIAN_KERNEL_7[weightIndex];
+                std::memcpy(padded.data() + i * channelCount, paddedRow, channelCount * sizeof(float));
+                std::memcpy(paddedRow + (width + i) * channelCount, paddedRow + (width - 1) * channelCount, channelCount * sizeof(float));
+            }
+            float* filteredRow = filtered.data() + (size_t) (sy - first) * rowSize;
+            for (size_t k = 0; k < weights.size(); k++)
+            {
+                addWeightedRow(padded.data() + k * channelCount, weights[k], rowSize, filteredRow);
             }
-            blurImage1->setTexelColor(x, y, blurColor);
         }
-    }
 
-    for (int y = 0; y < (int) getHeight(); y++)
-    {
-        for (int x = 0; x < (int) getWidth(); x++)
+        // Filter vertically into each row of the block.
+        vector<float> row(rowSize);
+        for (unsigned int y = begin; y < end; y++)
         {
-            Color4 blurColor;
-            unsigned int weightIndex = 0;
-            for (int dx = -3; dx <= 3; dx++, weightIndex++)
+            std::fill(row.begin(), row.end(), 0.0f);
+            for (size_t k = 0; k < weights.size(); k++)
             {
-                int sx = std::min(std::max(x + dx, 0), (int) getWidth() - 1);
-                blurColor += blurImage1->getTexelColor(sx, y) * GAUSSIAN_KERNEL_7[weightIndex];
+                addWeightedRow(filtered.data() + (y - begin + k) * rowSize, weights[k], rowSize, row.data());
             }
-            blurImage2->setTexelColor(x, y, blurColor);
+            storeRow(*filterImage, y, row.data());
         }
-    }
+    });
+
+    return filterImage;
+}
+
+ImagePtr Image::applyBoxBlur()
+{
+    return applySeparableFilter({ 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f });
+}
 
-    return blurImage2;
+ImagePtr Image::applyGaussianBlur()
+{
+    return applySeparableFilter(vector<float>(GAUSSIAN_KERNEL_7.begin(), GAUSSIAN_KERNEL_7.end()));
 }
 
 ImagePair Image::splitByLuminance(float luminance)
 {
+    validateKernelImage(*this, "splitByLuminance");
+
     ImagePtr underflowImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
     ImagePtr overflowImage = Image::create(getWidth(), getHeight(), getChannelCount(), getBaseType());
     underflowImage->createResourceBuffer();
     overflowImage->createResourceBuffer();
 
-    for (unsigned int y = 0; y < getHeight(); y++)
+    // Color channels are split by the given luminance, and alpha is set to one.
+    const unsigned int channelCount = getChannelCount();
+    const unsigned int colorChannels = std::min(channelCount, 3u);
+    forEachImageRowBlock(getWidth(), getHeight(), ROWS_PER_TASK, [&](size_t, unsigned int begin, unsigned int end)
     {
-        for (unsigned int x = 0; x < getWidth(); x++)
+        const size_t rowSize = (size_t) getWidth() * channelCount;
+        vector<float> row(rowSize), underflowRow(rowSize), overflowRow(rowSize);
+        for (unsigned int y = begin; y < end; y++)
         {
-            Color4 envColor = getTexelColor(x, y);
-            Color4 underflowColor(
-                std::min(envColor[0], luminance),
-                std::min(envColor[1], luminance),
-                std::min(envColor[2], luminance), 1.0f);
-            Color4 overflowColor(
-                std::max(envColor[0] - underflowColor[0], 0.0f),
-                std::max(envColor[1] - underflowColor[1], 0.0f),
-                std::max(envColor[2] - underflowColor[2], 0.0f), 1.0f);
-            underflowImage->setTexelColor(x, y, underflowColor);
-            overflowImage->setTexelColor(x, y, overflowColor);
+            loadRow(*this, y, row.data());
+            for (size_t i = 0; i < rowSize; i += channelCount)
+            {
+                for (unsigned int c = 0; c < colorChannels; c++)
+                {
+                    const float underflow = std::min(row[i + c], luminance);
+                    underflowRow[i + c] = underflow;
+                    overflowRow[i + c] = std::max(row[i + c] - underflow, 0.0f);
+                }
+                if (channelCount == 4)
+                {
+                    underflowRow[i + 3] = 1.0f;
+                    overflowRow[i + 3] = 1.0f;
+                }
+            }
+            storeRow(*underflowImage, y, underflowRow.data());
+            storeRow(*overflowImage, y, overflowRow.data());
         }
-    }
+    });
 
     return std::make_pair(underflowImage, overflowImage);
 }
@@ -36,6 +36,10 @@ using ImagePair = std::pair<ImagePtr, ImagePtr>;
 /// A function to perform image buffer deallocation
 using ImageBufferDeallocator = std::function<void(void*)>;
 
+/// A function to process a block of image rows, given the index of the
+/// block and the range [begin, end) of its rows.
+using ImageRowBlockFunction = std::function<void(size_t, unsigned int, unsigned int)>;
+
 /// @class Image
 /// Class representing an image in system memory
 class MX_RENDER_API Image
@@ -109,6 +113,18 @@ class MX_RENDER_API Image
     /// or image resource buffer are invalid, then an exception is thrown.
     Color4 getTexelColor(unsigned int x, unsigned int y) const;
 
+    /// Read the given row of this image as normalized floats, with the
+    /// channels of each texel interleaved.  The values array must hold
+    /// width times channel count floats.  If the row or image resource
+    /// buffer are invalid, then an exception is thrown.
+    void getRowValues(unsigned int y, float* values) const;
+
+    /// Write the given row of this image from normalized floats, with the
+    /// channels of each texel interleaved.  Values are clamped to [0, 1]
+    /// for integer base types.  If the row or image resource buffer are
+    /// invalid, then an exception is thrown.
+    void setRowValues(unsigned int y, const float* values);
+
     /// @}
     /// @name Image Analysis
     /// @{
@@ -127,6 +143,12 @@ class MX_RENDER_API Image
     /// Set all texels of this image to a uniform color.
     void setUniformColor(const Color4& color);
 
+    /// Apply a separable filter to this image, returning a new filtered image.
+    /// The given weights, of odd size, are applied both horizontally and
+    /// vertically, with texels beyond the edges of the image clamped.
+    /// @throws Exception if the weights do not have an odd size.
+    ImagePtr applySeparableFilter(const vector<float>& weights);
+
     /// Apply a 3x3 box blur to this image, returning a new blurred image.
     ImagePtr applyBoxBlur();
 
@@ -212,6 +234,15 @@ MX_RENDER_API ImagePtr createImageStrip(const vector<ImagePtr>& imageVec);
 /// Compute the maximum width and height of all images in the given vector.
 MX_RENDER_API std::pair<unsigned int, unsigned int> getMaxDimensions(const vector<ImagePtr>& imageVec);
 
+/// Call the given function for each block of rows of an image with the given
+/// dimensions, where every block but the last has the given number of rows.
+/// Blocks are processed concurrently by the given number of threads, and the
+/// first exception thrown by the function is rethrown to the caller.
+/// @param threadCount The number of threads to use, where zero selects the
+///    hardware concurrency for large images and a single thread otherwise.
+MX_RENDER_API void forEachImageRowBlock(unsigned int width, unsigned int height, unsigned int blockRows,
+                                        const ImageRowBlockFunction& func, unsigned int threadCount = 0);
+
 } // namespace MaterialX
 
 #endif
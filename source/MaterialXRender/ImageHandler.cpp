@@ -53,7 +53,12 @@ ImagePtr ImageLoader::loadImage(const FilePath&)
 // ImageHandler methods
 //
 
-ImageHandler::ImageHandler(ImageLoaderPtr imageLoader)
+ImageHandler::ImageHandler(ImageLoaderPtr imageLoader) :
+    _imageCacheBudget(0),
+    _imageCacheSize(0),
+    _imageCacheHitCount(0),
+    _imageCacheMissCount(0),
+    _imageCacheEvictionCount(0)
 {
     addLoader(imageLoader);
     _zeroImage = createUniformImage(2, 2, 4, Image::BaseType::UINT8, Color4(0.0f));
@@ -121,22 +126,26 @@ bool ImageHandler::saveImage(const FilePath& filePath,
 
 ImagePtr ImageHandler::acquireImage(const FilePath& filePath)
 {
-    // Resolve the input filepath.
+    // Resolve the input filepath, and find it on the search path, so that
+    // images are cached by the file from which they are loaded.
     FilePath resolvedFilePath = filePath;
     if (_resolver)
     {
         resolvedFilePath = _resolver->resolve(resolvedFilePath, FILENAME_TYPE_STRING);
     }
+    resolvedFilePath = _searchPath.find(resolvedFilePath);
 
     // Return a cached image if available.
     ImagePtr cachedImage = getCachedImage(resolvedFilePath);
     if (cachedImage)
     {
+        _imageCacheHitCount++;
         return cachedImage;
     }
+    _imageCacheMissCount++;
 
     // Load and cache the requested image.
-    ImagePtr image = loadImage(_searchPath.find(resolvedFilePath));
+    ImagePtr image = loadImage(resolvedFilePath);
     if (image)
     {
         cacheImage(resolvedFilePath, image);
@@ -162,7 +171,7 @@ void ImageHandler::unbindImages()
 {
     for (auto iter : _imageCache)
     {
-        unbindImage(iter.second);
+        unbindImage(iter.second.image);
     }
 }
 
@@ -175,6 +184,46 @@ void ImageHandler::releaseRenderResources(ImagePtr)
 {
 }
 
+void ImageHandler::clearImageCache()
+{
+    releaseRenderResources();
+    _imageCache.clear();
+    _imageUseOrder.clear();
+    _imageCacheSize = 0;
+    _imageCacheHitCount = 0;
+    _imageCacheMissCount = 0;
+    _imageCacheEvictionCount = 0;
+}
+
+void ImageHandler::setImageCacheBudget(size_t byteCount)
+{
+    _imageCacheBudget = byteCount;
+    evictImages();
+}
+
+void ImageHandler::pinImage(ImagePtr image)
+{
+    if (image)
+    {
+        _pinCounts[image]++;
+    }
+}
+
+void ImageHandler::unpinImage(ImagePtr image)
+{
+    auto iter = _pinCounts.find(image);
+    if (iter != _pinCounts.end() && !--iter->second)
+    {
+        _pinCounts.erase(iter);
+    }
+}
+
+unsigned int ImageHandler::getPinCount(ImagePtr image) const
+{
+    auto iter = _pinCounts.find(image);
+    return iter != _pinCounts.end() ? iter->second : 0;
+}
+
 ImageVec ImageHandler::getReferencedImages(DocumentPtr doc)
 {
     ImageVec imageVec;
@@ -248,27 +297,69 @@ ImagePtr ImageHandler::loadImage(const FilePath& filePath)
 
 void ImageHandler::cacheImage(const string& filePath, ImagePtr image)
 {
-    _imageCache[filePath] = image;
+    // The sentinel invalid image is shared between entries, so it is not
+    // counted towards the size of the cache.
+    size_t byteCount = 0;
+    if (image && image != _invalidImage)
+    {
+        byteCount = (size_t) image->getRowStride() * image->getHeight();
+    }
+
+    auto iter = _imageCache.find(filePath);
+    if (iter != _imageCache.end())
+    {
+        _imageCacheSize -= iter->second.byteCount;
+        _imageUseOrder.splice(_imageUseOrder.begin(), _imageUseOrder, iter->second.useOrder);
+        iter->second.image = image;
+        iter->second.byteCount = byteCount;
+    }
+    else
+    {
+        _imageUseOrder.push_front(filePath);
+        _imageCache[filePath] = { image, byteCount, _imageUseOrder.begin() };
+    }
+    _imageCacheSize += byteCount;
+
+    evictImages(image);
 }
 
 ImagePtr ImageHandler::getCachedImage(const FilePath& filePath)
 {
-    if (_imageCache.count(filePath))
+    auto iter = _imageCache.find(filePath);
+    if (iter == _imageCache.end())
+    {
+        return nullptr;
+    }
+
+    // Mark the image as most recently used.
+    _imageUseOrder.splice(_imageUseOrder.begin(), _imageUseOrder, iter->second.useOrder);
+    return iter->second.image;
+}
+
+void ImageHandler::evictImages(ImagePtr retainedImage)
+{
+    if (!_imageCacheBudget)
     {
-        return _imageCache[filePath];
+        return;
     }
-    if (!filePath.isAbsolute())
+
+    auto orderIter = _imageUseOrder.end();
+    while (_imageCacheSize > _imageCacheBudget && orderIter != _imageUseOrder.begin())
     {
-        for (const FilePath& path : _searchPath)
+        --orderIter;
+        auto cacheIter = _imageCache.find(*orderIter);
+        ImagePtr image = cacheIter->second.image;
+        if (!cacheIter->second.byteCount || image == retainedImage || _pinCounts.count(image))
         {
-            FilePath combined = path / filePath;
-            if (_imageCache.count(combined))
-            {
-                return _imageCache[combined];
-            }
+            continue;
         }
+
+        releaseRenderResources(image);
+        _imageCacheSize -= cacheIter->second.byteCount;
+        _imageCacheEvictionCount++;
+        _imageCache.erase(cacheIter);
+        orderIter = _imageUseOrder.erase(orderIter);
     }
-    return nullptr;
 }
 
 //
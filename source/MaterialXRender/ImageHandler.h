@@ -16,6 +16,8 @@
 
 #include <MaterialXCore/Document.h>
 
+#include <list>
+
 namespace MaterialX
 {
 
@@ -145,6 +147,11 @@ class MX_RENDER_API ImageLoader
 /// disk via supplied ImageLoader. Derived classes are responsible for
 /// determinining how to perform the logic for "binding" of these resources
 /// for a given target (such as a given shading language).
+///
+/// Acquired images are held in a cache, which may be given a budget in bytes.
+/// When the resource buffers of cached images exceed the budget, the least
+/// recently acquired images are evicted from the cache, skipping images that
+/// are pinned.
 class MX_RENDER_API ImageHandler
 {
   public:
@@ -154,6 +161,18 @@ class MX_RENDER_API ImageHandler
     }
     virtual ~ImageHandler() { }
 
+    /// A cached image, with the size of its resource buffer and its position
+    /// in the order of use.
+    struct CachedImage
+    {
+        ImagePtr image;
+        size_t byteCount;
+        std::list<string>::iterator useOrder;
+    };
+
+    /// Map from resolved file paths to cached images
+    using ImageCache = std::unordered_map<string, CachedImage>;
+
     /// Add another image loader to the handler, which will be invoked if
     /// existing loaders cannot load a given image.
     void addLoader(ImageLoaderPtr loader);
@@ -219,13 +238,65 @@ class MX_RENDER_API ImageHandler
     virtual void releaseRenderResources(ImagePtr image = nullptr);
 
     /// Clear the contents of the image cache, first releasing any render
-    /// resources associated with cached images.
-    void clearImageCache()
+    /// resources associated with cached images, and reset the statistics
+    /// of the cache.
+    void clearImageCache();
+
+    /// Set the budget of the image cache in bytes, evicting images until the
+    /// cache fits within the budget.  A budget of zero, the default, allows
+    /// the cache to grow without bound.
+    void setImageCacheBudget(size_t byteCount);
+
+    /// Return the budget of the image cache in bytes.
+    size_t getImageCacheBudget() const
+    {
+        return _imageCacheBudget;
+    }
+
+    /// Return the total size in bytes of the resource buffers of cached images.
+    size_t getImageCacheSize() const
+    {
+        return _imageCacheSize;
+    }
+
+    /// Return the number of images in the image cache.
+    size_t getImageCacheCount() const
     {
-        releaseRenderResources();
-        _imageCache.clear();
+        return _imageCache.size();
     }
 
+    /// Return the number of image acquisitions served from the cache.
+    size_t getImageCacheHitCount() const
+    {
+        return _imageCacheHitCount;
+    }
+
+    /// Return the number of image acquisitions that were not found in the
+    /// cache.
+    size_t getImageCacheMissCount() const
+    {
+        return _imageCacheMissCount;
+    }
+
+    /// Return the number of images evicted from the cache to meet its budget.
+    size_t getImageCacheEvictionCount() const
+    {
+        return _imageCacheEvictionCount;
+    }
+
+    /// Pin an image, preventing its eviction from the cache until it has been
+    /// unpinned as many times as it was pinned.  Derived classes pin images
+    /// while they are bound for rendering.
+    void pinImage(ImagePtr image);
+
+    /// Unpin an image that was previously pinned.  Images exceeding the cache
+    /// budget are evicted once they have been unpinned and another image is
+    /// acquired.
+    void unpinImage(ImagePtr image);
+
+    /// Return the pin count of the given image.
+    unsigned int getPinCount(ImagePtr image) const;
+
     /// Return a fallback image with zeroes in all channels.
     ImagePtr getZeroImage() const
     {
@@ -250,16 +321,28 @@ class MX_RENDER_API ImageHandler
     // Load an image from the file system.
     ImagePtr loadImage(const FilePath& filePath);
 
-    // Add an image to the cache.
+    // Add an image to the cache, evicting other images as needed to meet
+    // the budget of the cache.
     void cacheImage(const string& filePath, ImagePtr image);
 
-    // Return the cached image, if found; otherwise return an empty
-    // shared pointer.
+    // Return the cached image for the given resolved file path, if found;
+    // otherwise return an empty shared pointer.
     ImagePtr getCachedImage(const FilePath& filePath);
 
+    // Evict the least recently used unpinned images until the cache fits
+    // within its budget, retaining the given image.
+    void evictImages(ImagePtr retainedImage = nullptr);
+
   protected:
     ImageLoaderMap _imageLoaders;
-    ImageMap _imageCache;
+    ImageCache _imageCache;
+    std::list<string> _imageUseOrder;
+    std::unordered_map<ImagePtr, unsigned int> _pinCounts;
+    size_t _imageCacheBudget;
+    size_t _imageCacheSize;
+    size_t _imageCacheHitCount;
+    size_t _imageCacheMissCount;
+    size_t _imageCacheEvictionCount;
     FileSearchPath _searchPath;
     StringResolverPtr _resolver;
     ImagePtr _zeroImage;
@@ -39,11 +39,16 @@ bool GLTextureHandler::bindImage(ImagePtr image, const ImageSamplingProperties&
         }
     }
 
-    // Update bound location if not already bound
+    // Update bound location if not already bound, pinning newly bound
+    // images in the cache.
     int textureUnit = getBoundTextureLocation(image->getResourceId());
     if (textureUnit < 0)
     {
         textureUnit = getNextAvailableTextureLocation();
+        if (textureUnit >= 0)
+        {
+            pinImage(image);
+        }
     }
     if (textureUnit < 0)
     {
@@ -81,6 +86,7 @@ bool GLTextureHandler::unbindImage(ImagePtr image)
             glActiveTexture(GL_TEXTURE0 + textureUnit);
             glBindTexture(GL_TEXTURE_2D, GlslProgram::UNDEFINED_OPENGL_RESOURCE_ID);
             _boundTextureLocations[textureUnit] = GlslProgram::UNDEFINED_OPENGL_RESOURCE_ID;
+            unpinImage(image);
             return true;
         }
     }
@@ -137,9 +143,9 @@ void GLTextureHandler::releaseRenderResources(ImagePtr image)
     {
         for (auto iter : _imageCache)
         {
-            if (iter.second)
+            if (iter.second.image)
             {
-                releaseRenderResources(iter.second);
+                releaseRenderResources(iter.second.image);
             }
         }
         return;
@@ -8,6 +8,8 @@
 #include <MaterialXCore/Util.h>
 #include <MaterialXCore/Document.h>
 
+#include <thread>
+
 namespace mx = MaterialX;
 
 TEST_CASE("String utilities", "[coreutil]")
@@ -28,6 +30,32 @@ TEST_CASE("String utilities", "[coreutil]")
 
     REQUIRE(mx::splitString("robot1, robot2", ", ") == (std::vector<std::string>{"robot1", "robot2"}));
     REQUIRE(mx::splitString("[one...two...three]", "[.]") == (std::vector<std::string>{"one", "two", "three"}));
+
+    // Equal strings are interned at one address across threads.
+    const std::string& interned = mx::internString(std::string("internedName"));
+    REQUIRE(&mx::internString("internedName") == &interned);
+    std::vector<const std::string*> threadResults(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadResults.size(); i++)
+    {
+        threads.emplace_back([&threadResults, i]()
+        {
+            mx::internString("threadName" + std::to_string(i));
+            threadResults[i] = &mx::internString("internedName");
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (const std::string* result : threadResults)
+    {
+        REQUIRE(result == &interned);
+    }
+
+    // Attribute name constants are the interned instances of their names.
+    REQUIRE(&mx::internString("type") == &mx::TypedElement::TYPE_ATTRIBUTE);
+    REQUIRE(&mx::internString("node") == &mx::NodeDef::NODE_ATTRIBUTE);
 }
 
 TEST_CASE("Print utilities", "[coreutil]")
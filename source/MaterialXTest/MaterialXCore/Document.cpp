@@ -10,6 +10,11 @@
 #include <MaterialXFormat/Util.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
 namespace mx = MaterialX;
 
 TEST_CASE("Document", "[document]")
@@ -109,6 +114,196 @@ TEST_CASE("Document", "[document]")
     REQUIRE(doc->validate());
 }
 
+TEST_CASE("Document cache", "[document]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_simpleSrf", "surfaceshader", "simpleSrf");
+    mx::ImplementationPtr impl = doc->addImplementation("IM_simpleSrf");
+    impl->setNodeDef(nodeDef);
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr constant = nodeGraph->addNode("constant", "constant1", "color3");
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(constant);
+
+    // Populate the cache.
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").size() == 1);
+    REQUIRE(doc->getMatchingImplementations("ND_simpleSrf").size() == 1);
+    REQUIRE(constant->getDownstreamPorts().size() == 1);
+
+    // Add and rename elements.
+    mx::NodeDefPtr nodeDef2 = doc->addNodeDef("ND_simpleSrf2", "surfaceshader", "simpleSrf");
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").size() == 2);
+    nodeDef2->setName("ND_simpleSrf3");
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").size() == 2);
+    mx::OutputPtr output2 = nodeGraph->addOutput("out2", "color3");
+    output2->setConnectedNode(constant);
+    REQUIRE(constant->getDownstreamPorts().size() == 2);
+
+    // Change key attributes.
+    nodeDef2->setNodeString("otherSrf");
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").size() == 1);
+    REQUIRE(doc->getMatchingNodeDefs("otherSrf").size() == 1);
+    impl->setNodeDef(nodeDef2);
+    REQUIRE(doc->getMatchingImplementations("ND_simpleSrf").empty());
+    REQUIRE(doc->getMatchingImplementations("ND_simpleSrf3").size() == 1);
+    output2->removeAttribute(mx::PortElement::NODE_NAME_ATTRIBUTE);
+    REQUIRE(constant->getDownstreamPorts().size() == 1);
+
+    // Change namespaces.
+    nodeGraph->setNamespace("custom");
+    REQUIRE(doc->getMatchingPorts("constant1").empty());
+    REQUIRE(doc->getMatchingPorts("custom:constant1").size() == 1);
+    nodeGraph->removeAttribute(mx::Element::NAMESPACE_ATTRIBUTE);
+    REQUIRE(doc->getMatchingPorts("constant1").size() == 1);
+
+    // Remove elements, retaining references to them.
+    doc->removeNodeDef(nodeDef2->getName());
+    REQUIRE(doc->getMatchingNodeDefs("otherSrf").empty());
+    nodeDef2->setNodeString("simpleSrf");
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").size() == 1);
+    doc->removeNodeGraph(nodeGraph->getName());
+    REQUIRE(doc->getMatchingPorts("constant1").empty());
+
+    // Compare against a full rebuild.
+    mx::DocumentPtr copy = doc->copy();
+    doc->invalidateCache();
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").size() == copy->getMatchingNodeDefs("simpleSrf").size());
+    REQUIRE(doc->getMatchingImplementations("ND_simpleSrf3").size() == copy->getMatchingImplementations("ND_simpleSrf3").size());
+    doc->initialize();
+    REQUIRE(doc->getMatchingNodeDefs("simpleSrf").empty());
+}
+
+// Perform node string lookups on a shared document from the given number of
+// threads, returning the number of lookups that found no nodedefs.
+static size_t lookupNodeDefsConcurrently(mx::DocumentPtr doc, const mx::StringVec& nodeStrings,
+                                         size_t threadCount, size_t lookupsPerThread)
+{
+    std::atomic<size_t> mismatches(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&doc, &nodeStrings, &mismatches, t, lookupsPerThread]()
+        {
+            for (size_t i = 0; i < lookupsPerThread; i++)
+            {
+                const std::string& nodeString = nodeStrings[(i + t) % nodeStrings.size()];
+                if (doc->getMatchingNodeDefs(nodeString).empty())
+                {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    return mismatches;
+}
+
+TEST_CASE("Document cache threading", "[document]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+
+    mx::StringVec nodeStrings;
+    for (mx::NodeDefPtr nodeDef : doc->getNodeDefs())
+    {
+        nodeStrings.push_back(nodeDef->getNodeString());
+    }
+    REQUIRE(!nodeStrings.empty());
+
+    // Concurrent lookups on a shared document find every nodedef.
+    REQUIRE(lookupNodeDefsConcurrently(doc, nodeStrings, 4, 2000) == 0);
+}
+
+TEST_CASE("Document cache threading performance", "[.][benchmark]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+
+    mx::StringVec nodeStrings;
+    for (mx::NodeDefPtr nodeDef : doc->getNodeDefs())
+    {
+        nodeStrings.push_back(nodeDef->getNodeString());
+    }
+    REQUIRE(!nodeStrings.empty());
+
+    // Measure lookup throughput on a shared document at increasing thread counts.
+    const size_t LOOKUPS_PER_THREAD = 20000;
+    for (size_t threadCount : { 1, 2, 4, 8 })
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        size_t mismatches = lookupNodeDefsConcurrently(doc, nodeStrings, threadCount, LOOKUPS_PER_THREAD);
+        std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+        REQUIRE(mismatches == 0);
+
+        double lookupsPerSecond = (double) (threadCount * LOOKUPS_PER_THREAD) / duration.count();
+        std::cout << "Document lookups with " << threadCount << " thread(s): " <<
+            (size_t) lookupsPerSecond << " per second" << std::endl;
+    }
+}
+
+TEST_CASE("Document arena", "[document]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+
+    // Documents loaded with and without arena allocation are equal.
+    mx::DocumentPtr docs[2];
+    for (bool useArena : { false, true })
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        if (useArena)
+        {
+            doc->enableElementArena();
+        }
+        mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+        REQUIRE(doc->hasElementArena() == useArena);
+        REQUIRE(doc->copy()->hasElementArena() == useArena);
+        docs[useArena ? 1 : 0] = doc;
+    }
+    REQUIRE(*docs[0] == *docs[1]);
+
+    // Elements remain valid while referenced, even after their document is released.
+    mx::DocumentPtr arenaDoc = mx::createDocument();
+    arenaDoc->enableElementArena();
+    mx::NodeDefPtr nodeDef = arenaDoc->addNodeDef("ND_test", "float", "test");
+    arenaDoc = nullptr;
+    REQUIRE(nodeDef->getName() == "ND_test");
+    REQUIRE_THROWS_AS(nodeDef->getDocument(), mx::ExceptionOrphanedElement&);
+}
+
+TEST_CASE("Document arena performance", "[.][benchmark]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+
+    // Compare load and teardown times with and without arena allocation.
+    for (bool useArena : { false, true })
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        mx::DocumentPtr doc = mx::createDocument();
+        if (useArena)
+        {
+            doc->enableElementArena();
+        }
+        mx::loadLibraries({ "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+        std::chrono::duration<double> loadTime = std::chrono::steady_clock::now() - startTime;
+        REQUIRE(doc.use_count() == 1);
+
+        startTime = std::chrono::steady_clock::now();
+        doc.reset();
+        std::chrono::duration<double> teardownTime = std::chrono::steady_clock::now() - startTime;
+        std::cout << (useArena ? "Arena" : "Heap") << " document load: " << loadTime.count() <<
+            " seconds, teardown: " << teardownTime.count() << " seconds" << std::endl;
+    }
+}
+
 TEST_CASE("Version", "[document]")
 {
     mx::DocumentPtr doc = mx::createDocument();
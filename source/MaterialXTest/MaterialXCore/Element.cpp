@@ -40,6 +40,18 @@ TEST_CASE("Element", "[element]")
     REQUIRE(elem1->getTypedAttribute<bool>("customColor") == false);
     REQUIRE(elem1->getTypedAttribute<mx::Color3>("customFlag") == mx::Color3(0.0f));
 
+    // Set and remove attributes.
+    elem2->setAttribute("attr1", "value1");
+    elem2->setAttribute("attr2", "value2");
+    elem2->setAttribute("attr1", "value3");
+    REQUIRE(elem2->getAttributeNames() == (mx::StringVec{ "attr1", "attr2" }));
+    REQUIRE(elem2->getAttribute("attr1") == "value3");
+    elem2->removeAttribute("attr1");
+    REQUIRE(!elem2->hasAttribute("attr1"));
+    REQUIRE(elem2->getAttributeNames() == (mx::StringVec{ "attr2" }));
+    elem2->removeAttribute("attr2");
+    REQUIRE(elem2->getAttributeNames().empty());
+
     // Modify element names.
     elem1->setName("elem1");
     elem2->setName("elem2");
@@ -66,3 +78,45 @@ TEST_CASE("Element", "[element]")
     }
     REQUIRE_THROWS_AS(orphan->getDocument(), mx::ExceptionOrphanedElement&);    
 }
+
+TEST_CASE("Value cache", "[element]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr constant = nodeGraph->addNode("constant");
+    mx::InputPtr input = constant->setInputValue("value", mx::Color3(0.1f, 0.2f, 0.3f));
+
+    // Repeated queries return the same parsed value.
+    mx::ValuePtr value = input->getValue();
+    REQUIRE(value->asA<mx::Color3>() == mx::Color3(0.1f, 0.2f, 0.3f));
+    REQUIRE(input->getValue() == value);
+    REQUIRE(input->getResolvedValue() == value);
+
+    // Changes to the value string invalidate the cache.
+    input->setValueString("0.5, 0.5, 0.5");
+    REQUIRE(input->getValue() != value);
+    REQUIRE(input->getValue()->asA<mx::Color3>() == mx::Color3(0.5f));
+
+    // Changes to the type invalidate the cache.
+    value = input->getValue();
+    input->setType("vector3");
+    REQUIRE(input->getValue()->asA<mx::Vector3>() == mx::Vector3(0.5f));
+
+    // Unrelated attributes leave the cache intact.
+    value = input->getValue();
+    input->setDocString("A constant value");
+    REQUIRE(input->getValue() == value);
+
+    // Removing the value clears the cache.
+    input->removeAttribute(mx::ValueElement::VALUE_ATTRIBUTE);
+    REQUIRE(!input->getValue());
+    input->setValue(2.0f);
+    REQUIRE(input->getValue()->asA<float>() == 2.0f);
+
+    // Copied content is reparsed.
+    mx::InputPtr input2 = constant->addInput("value2", "float");
+    input2->setValue(3.0f);
+    REQUIRE(input2->getValue()->asA<float>() == 3.0f);
+    input2->copyContentFrom(input);
+    REQUIRE(input2->getValue()->asA<float>() == 2.0f);
+}
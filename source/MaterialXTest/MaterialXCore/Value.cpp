@@ -8,6 +8,13 @@
 #include <MaterialXCore/Util.h>
 #include <MaterialXCore/Value.h>
 
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
 namespace mx = MaterialX;
 
 template<class T> void testTypedValue(const T& v1, const T& v2)
@@ -78,6 +85,125 @@ TEST_CASE("Value strings", "[value]")
     REQUIRE_THROWS_AS(mx::fromValueString<float>("text"), mx::ExceptionTypeError&);
     REQUIRE_THROWS_AS(mx::fromValueString<bool>("1"), mx::ExceptionTypeError&);
     REQUIRE_THROWS_AS(mx::fromValueString<mx::Color3>("1"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<mx::Color3>("1, 1, 1, 1"), mx::ExceptionTypeError&);
+    REQUIRE_THROWS_AS(mx::fromValueString<int>("99999999999"), mx::ExceptionTypeError&);
+
+    // Convert from value strings with varied syntax.
+    REQUIRE(mx::fromValueString<int>(" -12") == -12);
+    REQUIRE(mx::fromValueString<float>("1.5e2") == 150.0f);
+    REQUIRE(mx::fromValueString<float>("-.25") == -0.25f);
+    REQUIRE(mx::fromValueString<double>("0.1") == 0.1);
+    REQUIRE(mx::fromValueString<mx::Vector3>("1,2 , 3") == mx::Vector3(1.0f, 2.0f, 3.0f));
+    REQUIRE(mx::fromValueString<mx::Matrix33>("1, 2, 3, 4, 5, 6, 7, 8, 9") ==
+            mx::Matrix33(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f));
+    REQUIRE(mx::fromValueString<mx::FloatVec>("0.5, 1e-3, 123456789") ==
+            mx::FloatVec({ 0.5f, 1e-3f, 123456789.0f }));
+    REQUIRE(mx::fromValueString<mx::StringVec>("a, b c") == mx::StringVec({ "a", "b", "c" }));
+}
+
+TEST_CASE("Value string precision", "[value]")
+{
+    // Verify that parsed floats match stream extraction exactly.
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<uint32_t> bitDist;
+    std::uniform_int_distribution<int> precisionDist(1, 9);
+    for (int i = 0; i < 20000; i++)
+    {
+        uint32_t bits = bitDist(rng);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0.0f)
+        {
+            continue;
+        }
+
+        mx::ScopedFloatFormatting fmt(mx::Value::FloatFormatDefault, precisionDist(rng));
+        std::string str = mx::toValueString(value);
+        std::stringstream ss(str);
+        float expected = 0.0f;
+        ss >> expected;
+        REQUIRE(mx::fromValueString<float>(str) == expected);
+
+        std::ostringstream os;
+        os.precision(mx::Value::getFloatPrecision());
+        os << value;
+        REQUIRE(str == os.str());
+    }
+
+    // Verify that full-precision strings round-trip exactly.
+    mx::ScopedFloatFormatting fmt(mx::Value::FloatFormatDefault, 9);
+    for (float value : { 0.1f, 1.0f / 3.0f, 16777217.0f, 1e-30f, 3.4e38f, -2.5e-5f })
+    {
+        REQUIRE(mx::fromValueString<float>(mx::toValueString(value)) == value);
+    }
+
+    // Process-wide formatting applies to other threads, while scoped
+    // formatting applies only to the thread that created it.
+    mx::Value::setFloatPrecision(3);
+    REQUIRE(mx::Value::getFloatPrecision() == 9);
+    std::string threadString;
+    std::thread([&threadString]()
+    {
+        threadString = mx::toValueString(1.0f / 3.0f);
+    }).join();
+    REQUIRE(threadString == "0.333");
+    REQUIRE(mx::toValueString(1.0f / 3.0f) == "0.333333343");
+    mx::Value::setFloatPrecision(6);
+}
+
+template<class T> void benchmarkValueType(const std::string& valueString)
+{
+    const int ITERATIONS = 20000;
+    const std::string& typeString = mx::getTypeString<T>();
+    T data = mx::fromValueString<T>(valueString);
+
+    auto parseStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        data = mx::fromValueString<T>(valueString);
+    }
+    std::chrono::duration<double> parseTime = std::chrono::steady_clock::now() - parseStart;
+
+    size_t length = 0;
+    auto formatStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        length += mx::toValueString(data).size();
+    }
+    std::chrono::duration<double> formatTime = std::chrono::steady_clock::now() - formatStart;
+    REQUIRE(length > 0);
+
+    std::cout << "  " << typeString << ": " <<
+        parseTime.count() * 1e9 / ITERATIONS << " ns parse, " <<
+        formatTime.count() * 1e9 / ITERATIONS << " ns format" << std::endl;
+}
+
+TEST_CASE("Value string performance", "[.][benchmark]")
+{
+    std::cout << "Value string conversion timings:" << std::endl;
+
+    // Base types
+    benchmarkValueType<int>("42");
+    benchmarkValueType<bool>("true");
+    benchmarkValueType<float>("0.18");
+    benchmarkValueType<mx::Color3>("0.18, 0.18, 0.18");
+    benchmarkValueType<mx::Color4>("0.18, 0.18, 0.18, 1");
+    benchmarkValueType<mx::Vector2>("0.5, 0.5");
+    benchmarkValueType<mx::Vector3>("0, 1, 0");
+    benchmarkValueType<mx::Vector4>("0, 0, 1, 1");
+    benchmarkValueType<mx::Matrix33>("1, 0, 0, 0, 1, 0, 0, 0, 1");
+    benchmarkValueType<mx::Matrix44>("1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0.5, 0.25, 0.125, 1");
+    benchmarkValueType<std::string>("value");
+
+    // Array types
+    benchmarkValueType<mx::IntVec>("1, 2, 3, 4, 5, 6, 7, 8");
+    benchmarkValueType<mx::BoolVec>("true, false, true, false");
+    benchmarkValueType<mx::FloatVec>("0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8");
+    benchmarkValueType<mx::StringVec>("one, two, three, four");
+
+    // Alias types
+    benchmarkValueType<long>("42");
+    benchmarkValueType<double>("0.18");
 }
 
 TEST_CASE("Typed values", "[value]")
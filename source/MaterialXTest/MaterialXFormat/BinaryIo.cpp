@@ -0,0 +1,107 @@
+//
+// TM & (c) 2017 Lucasfilm Entertainment Company Ltd. and Lucasfilm Ltd.
+// All rights reserved.  See LICENSE.txt for license.
+//
+
+#include <MaterialXTest/Catch/catch.hpp>
+
+#include <MaterialXFormat/BinaryIo.h>
+#include <MaterialXFormat/Util.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace mx = MaterialX;
+
+TEST_CASE("Binary snapshots", "[binaryio]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::FilePathVec libraryFolders = { "targets", "stdlib", "pbrlib", "bxdf" };
+
+    // Load libraries from XML.
+    mx::DocumentPtr xmlDoc = mx::createDocument();
+    mx::StringSet sourceFiles = mx::loadLibraries(libraryFolders, searchPath, xmlDoc);
+    REQUIRE(!sourceFiles.empty());
+
+    // Write a snapshot and verify that it is current.
+    mx::FilePath snapshotPath = "libraries." + mx::MTLX_BINARY_EXTENSION;
+    mx::writeToBinaryFile(xmlDoc, snapshotPath, sourceFiles);
+    REQUIRE(mx::isBinarySnapshotCurrent(snapshotPath));
+
+    // Restore the snapshot, and verify that it matches the original document.
+    mx::DocumentPtr binaryDoc = mx::createDocument();
+    mx::readFromBinaryFile(binaryDoc, snapshotPath);
+    REQUIRE(*binaryDoc == *xmlDoc);
+    REQUIRE(mx::writeToXmlString(binaryDoc) == mx::writeToXmlString(xmlDoc));
+    REQUIRE(binaryDoc->getNodeDef("ND_image_color3")->getSourceUri() ==
+            xmlDoc->getNodeDef("ND_image_color3")->getSourceUri());
+    REQUIRE(binaryDoc->validate());
+
+    // Existing elements are not replaced.
+    mx::DocumentPtr mergedDoc = mx::createDocument();
+    mx::NodeDefPtr customNodeDef = mergedDoc->addNodeDef("ND_image_color3", "color3", "custom");
+    mx::readFromBinaryFile(mergedDoc, snapshotPath);
+    REQUIRE(mergedDoc->getNodeDef("ND_image_color3") == customNodeDef);
+    REQUIRE(mergedDoc->getNodeDef("ND_image_color3")->getNodeString() == "custom");
+    REQUIRE(mergedDoc->getNodeDefs().size() == xmlDoc->getNodeDefs().size());
+
+    // Snapshots become stale when a source file is modified.
+    mx::FilePath sourcePath = "snapshot_source.mtlx";
+    mx::DocumentPtr sourceDoc = mx::createDocument();
+    sourceDoc->addNodeGraph("graph1");
+    mx::writeToXmlFile(sourceDoc, sourcePath);
+    mx::FilePath stalePath = "snapshot_source." + mx::MTLX_BINARY_EXTENSION;
+    mx::writeToBinaryFile(sourceDoc, stalePath, { sourcePath.asString() });
+    REQUIRE(mx::isBinarySnapshotCurrent(stalePath));
+    sourceDoc->addNodeGraph("graph2");
+    mx::writeToXmlFile(sourceDoc, sourcePath);
+    REQUIRE(!mx::isBinarySnapshotCurrent(stalePath));
+
+    // Invalid snapshots are rejected.
+    {
+        std::ofstream ofs(stalePath.asString(), std::ios::binary);
+        ofs << "MTLXBIN";
+    }
+    REQUIRE(!mx::isBinarySnapshotCurrent(stalePath));
+    REQUIRE_THROWS_AS(mx::readFromBinaryFile(mx::createDocument(), stalePath), mx::ExceptionParseError&);
+    REQUIRE_THROWS_AS(mx::readFromBinaryFile(mx::createDocument(), "missing." + mx::MTLX_BINARY_EXTENSION), mx::ExceptionFileMissing&);
+
+    // Failed writes are reported, and leave any existing snapshot intact.
+    REQUIRE_THROWS_AS(mx::writeToBinaryFile(xmlDoc, mx::FilePath("missing") / snapshotPath), mx::ExceptionFileMissing&);
+    REQUIRE(mx::isBinarySnapshotCurrent(snapshotPath));
+
+    std::remove(snapshotPath.asString().c_str());
+    std::remove(stalePath.asString().c_str());
+    std::remove(sourcePath.asString().c_str());
+}
+
+TEST_CASE("Binary snapshot performance", "[.][benchmark]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::FilePathVec libraryFolders = { "targets", "stdlib", "pbrlib", "bxdf" };
+
+    // Compare library loading times from XML and from a binary snapshot.
+    auto xmlStart = std::chrono::steady_clock::now();
+    mx::DocumentPtr xmlDoc = mx::createDocument();
+    mx::StringSet sourceFiles = mx::loadLibraries(libraryFolders, searchPath, xmlDoc);
+    std::chrono::duration<double> xmlTime = std::chrono::steady_clock::now() - xmlStart;
+    REQUIRE(!sourceFiles.empty());
+
+    mx::FilePath snapshotPath = "libraries_benchmark." + mx::MTLX_BINARY_EXTENSION;
+    mx::writeToBinaryFile(xmlDoc, snapshotPath, sourceFiles);
+    auto binaryStart = std::chrono::steady_clock::now();
+    mx::DocumentPtr binaryDoc = mx::createDocument();
+    mx::readFromBinaryFile(binaryDoc, snapshotPath);
+    std::chrono::duration<double> binaryTime = std::chrono::steady_clock::now() - binaryStart;
+    REQUIRE(*binaryDoc == *xmlDoc);
+
+    std::cout << "Library loading of " << sourceFiles.size() << " files: " <<
+        xmlTime.count() << " seconds from XML, " <<
+        binaryTime.count() << " seconds from binary snapshot" << std::endl;
+
+    std::remove(snapshotPath.asString().c_str());
+}
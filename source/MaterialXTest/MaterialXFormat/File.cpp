@@ -44,7 +44,14 @@ TEST_CASE("File system operations", "[file]")
         mx::FilePath path(filename);
         REQUIRE(path.exists());
         REQUIRE(mx::FileSearchPath().find(path).exists());
+
+        mx::MappedFile mappedFile;
+        REQUIRE(mappedFile.open(path));
+        std::string contents = mx::readFile(path);
+        REQUIRE(!contents.empty());
+        REQUIRE(contents.size() <= mappedFile.getSize());
     }
+    REQUIRE(!mx::MappedFile().open(mx::FilePath("missingFile.mtlx")));
 
     mx::FilePath currentPath = mx::FilePath::getCurrentPath();
     mx::FilePath modulePath = mx::FilePath::getModulePath();
@@ -7,8 +7,11 @@
 
 #include <MaterialXFormat/Environ.h>
 #include <MaterialXFormat/File.h>
+#include <MaterialXFormat/Util.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <iostream>
+
 namespace mx = MaterialX;
 
 TEST_CASE("Load content", "[xmlio]")
@@ -224,3 +227,134 @@ TEST_CASE("Load content", "[xmlio]")
     mx::DocumentPtr nonExistentDoc = mx::createDocument();
     REQUIRE_THROWS_AS(mx::readFromXmlFile(nonExistentDoc, "NonExistent.mtlx", mx::FileSearchPath(), &readOptions), mx::ExceptionFileMissing&);
 }
+
+TEST_CASE("Parallel library loading", "[xmlio]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::FilePathVec libraryFolders = { "targets", "stdlib", "pbrlib", "bxdf" };
+
+    // Load libraries serially.
+    mx::DocumentPtr serialDoc = mx::createDocument();
+    mx::StringSet serialFiles = mx::loadLibraries(libraryFolders, searchPath, serialDoc);
+
+    // Load libraries in parallel, and verify that the results are identical.
+    mx::DocumentPtr parallelDoc = mx::createDocument();
+    mx::LibraryFileTimingVec timings;
+    mx::StringSet parallelFiles = mx::loadLibraries(libraryFolders, searchPath, parallelDoc, mx::StringSet(), nullptr, 4, &timings);
+    REQUIRE(parallelFiles == serialFiles);
+    REQUIRE(timings.size() == parallelFiles.size());
+    REQUIRE(*parallelDoc == *serialDoc);
+    REQUIRE(mx::writeToXmlString(parallelDoc) == mx::writeToXmlString(serialDoc));
+}
+
+TEST_CASE("Parallel library loading performance", "[.][benchmark]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::FilePathVec libraryFolders = { "targets", "stdlib", "pbrlib", "bxdf" };
+
+    // Report the time spent parsing and merging library files.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::LibraryFileTimingVec timings;
+    mx::loadLibraries(libraryFolders, searchPath, doc, mx::StringSet(), nullptr, 4, &timings);
+    REQUIRE(!timings.empty());
+
+    double parseTime = 0.0;
+    double mergeTime = 0.0;
+    for (const mx::LibraryFileTiming& timing : timings)
+    {
+        parseTime += timing.parseTime;
+        mergeTime += timing.mergeTime;
+    }
+    std::cout << "Parallel library loading of " << timings.size() << " files: " <<
+        parseTime << " seconds parsing, " << mergeTime << " seconds merging" << std::endl;
+}
+
+TEST_CASE("Streaming read", "[xmlio]")
+{
+    mx::FilePath libraryPath("libraries/stdlib");
+    mx::FilePath examplesPath("resources/Materials/Examples/Syntax");
+    mx::FileSearchPath searchPath = libraryPath.asString() +
+        mx::PATH_LIST_SEPARATOR +
+        examplesPath.asString();
+
+    // Verify that streaming reads without filtering match DOM reads.
+    mx::XmlReadOptions domOptions;
+    domOptions.readComments = true;
+    mx::XmlReadOptions streamOptions = domOptions;
+    streamOptions.elementFilter = [](const std::string&, const std::string&)
+    {
+        return true;
+    };
+    mx::FilePathVec filenames = libraryPath.getFilesInDirectory(mx::MTLX_EXTENSION);
+    for (const mx::FilePath& filename : examplesPath.getFilesInDirectory(mx::MTLX_EXTENSION))
+    {
+        filenames.push_back(filename);
+    }
+    for (const mx::FilePath& filename : filenames)
+    {
+        mx::DocumentPtr domDoc = mx::createDocument();
+        mx::readFromXmlFile(domDoc, filename, searchPath, &domOptions);
+        mx::DocumentPtr streamDoc = mx::createDocument();
+        mx::readFromXmlFile(streamDoc, filename, searchPath, &streamOptions);
+        REQUIRE(*streamDoc == *domDoc);
+
+        mx::XmlWriteOptions writeOptions;
+        writeOptions.writeXIncludeEnable = false;
+        std::string xmlString = mx::writeToXmlString(domDoc, &writeOptions);
+        mx::DocumentPtr stringDoc = mx::createDocument();
+        mx::readFromXmlString(stringDoc, xmlString, &streamOptions);
+        mx::DocumentPtr domStringDoc = mx::createDocument();
+        mx::readFromXmlString(domStringDoc, xmlString, &domOptions);
+        REQUIRE(*stringDoc == *domStringDoc);
+    }
+
+    // Read only look assignments from a document.
+    mx::StringSet lookCategories = { mx::Look::CATEGORY, mx::Collection::CATEGORY };
+    mx::XmlReadOptions lookOptions;
+    lookOptions.elementFilter = [&lookCategories](const std::string& category, const std::string&)
+    {
+        return lookCategories.count(category) > 0;
+    };
+    mx::DocumentPtr fullDoc = mx::createDocument();
+    mx::readFromXmlFile(fullDoc, "Looks.mtlx", searchPath);
+    mx::DocumentPtr lookDoc = mx::createDocument();
+    mx::readFromXmlFile(lookDoc, "Looks.mtlx", searchPath, &lookOptions);
+    REQUIRE(!lookDoc->getLooks().empty());
+    REQUIRE(lookDoc->getLooks().size() == fullDoc->getLooks().size());
+    REQUIRE(lookDoc->getCollections().size() == fullDoc->getCollections().size());
+    for (mx::ElementPtr child : lookDoc->getChildren())
+    {
+        REQUIRE(lookCategories.count(child->getCategory()));
+    }
+    for (mx::LookPtr look : lookDoc->getLooks())
+    {
+        REQUIRE(*look == *fullDoc->getLook(look->getName()));
+    }
+
+    // Filter elements by name.
+    mx::XmlReadOptions nameOptions;
+    nameOptions.elementFilter = [](const std::string&, const std::string& name)
+    {
+        return name == "ND_add_float";
+    };
+    mx::DocumentPtr nameDoc = mx::createDocument();
+    mx::readFromXmlFile(nameDoc, "stdlib_defs.mtlx", searchPath, &nameOptions);
+    REQUIRE(nameDoc->getChildren().size() == 1);
+    REQUIRE(nameDoc->getNodeDef("ND_add_float"));
+
+    // Verify character references and error handling.
+    mx::DocumentPtr entityDoc = mx::createDocument();
+    mx::readFromXmlString(entityDoc, "<?xml version=\"1.0\"?><materialx version=\"1.38\">"
+                                     "<nodegraph name=\"g1\" doc=\"a &lt;b&gt; &amp; &#65;&#x42;\"/></materialx>", &streamOptions);
+    REQUIRE(entityDoc->getNodeGraph("g1")->getDocString() == "a <b> & AB");
+    REQUIRE_THROWS_AS(mx::readFromXmlString(mx::createDocument(), "<materialx><nodegraph name=\"g1\"></materialx>", &streamOptions),
+                      mx::ExceptionParseError&);
+    REQUIRE_THROWS_AS(mx::readFromXmlString(mx::createDocument(), "<materialx><nodegraph name=\"g1></materialx>", &streamOptions),
+                      mx::ExceptionParseError&);
+    REQUIRE_THROWS_AS(mx::readFromXmlString(mx::createDocument(), "", &streamOptions),
+                      mx::ExceptionParseError&);
+    REQUIRE_THROWS_AS(mx::readFromXmlFile(mx::createDocument(), "NonExistent.mtlx", mx::FileSearchPath(), &streamOptions),
+                      mx::ExceptionFileMissing&);
+}
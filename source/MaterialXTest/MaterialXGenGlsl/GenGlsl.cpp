@@ -10,13 +10,28 @@
 #include <MaterialXCore/Document.h>
 
 #include <MaterialXFormat/File.h>
+#include <MaterialXFormat/Util.h>
 
+#include <MaterialXGenShader/BatchShaderGenerator.h>
+#include <MaterialXGenShader/ShaderCache.h>
+#include <MaterialXGenShader/ShaderPermutationCache.h>
+#include <MaterialXGenShader/Nodes/CompoundNode.h>
+#include <MaterialXGenShader/Nodes/SourceCodeNode.h>
 #include <MaterialXGenShader/TypeDesc.h>
+#include <MaterialXGenShader/Util.h>
 
 #include <MaterialXGenGlsl/GlslShaderGenerator.h>
 #include <MaterialXGenGlsl/GlslSyntax.h>
 #include <MaterialXGenGlsl/GlslResourceBindingContext.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+
 namespace mx = MaterialX;
 
 TEST_CASE("GenShader: GLSL Syntax Check", "[genglsl]")
@@ -122,6 +137,979 @@ TEST_CASE("GenShader: Bind Light Shaders", "[genglsl]")
     REQUIRE_NOTHROW(mx::HwShaderGenerator::bindLightShader(*spotLightShader, 66, context));
 }
 
+TEST_CASE("GenShader: GLSL Shader Cache", "[genglsl]")
+{
+    mx::FileSearchPath searchPath;
+    searchPath.append(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+    mx::DocumentPtr doc = mx::createDocument();
+    loadLibraries({ "targets", "stdlib", "pbrlib", "bxdf" }, searchPath, doc);
+    mx::readFromXmlFile(doc, "resources/Materials/Examples/StandardSurface/standard_surface_brass_tiled.mtlx");
+
+    std::vector<mx::TypedElementPtr> elements;
+    mx::findRenderableElements(doc, elements);
+    REQUIRE(!elements.empty());
+    std::vector<mx::NodePtr> shaderNodes = mx::getShaderNodes(elements[0]->asA<mx::Node>());
+    REQUIRE(!shaderNodes.empty());
+    mx::TypedElementPtr element = shaderNodes[0];
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(mx::FilePath::getCurrentPath() / mx::FilePath("libraries"));
+
+    const mx::FilePath cacheDir = mx::FilePath::getCurrentPath() / mx::FilePath("shader_cache_test");
+    for (const mx::FilePath& file : cacheDir.getFilesInDirectory("mtlxshader"))
+    {
+        std::remove((cacheDir / file).asString().c_str());
+    }
+
+    // Generate and store the shader.
+    mx::ShaderCachePtr cache = mx::ShaderCache::create(cacheDir);
+    mx::ShaderPtr generated = cache->generate(element->getName(), element, context);
+    REQUIRE(generated);
+    REQUIRE(cache->getMissCount() == 1);
+    REQUIRE(cache->getHitCount() == 0);
+
+    // Restore the shader from a new cache instance.
+    mx::ShaderCachePtr warmCache = mx::ShaderCache::create(cacheDir);
+    mx::ShaderPtr restored = warmCache->generate(element->getName(), element, context);
+    REQUIRE(restored);
+    REQUIRE(warmCache->getHitCount() == 1);
+    REQUIRE(warmCache->getMissCount() == 0);
+
+    // Verify that the restored shader matches the generated one.
+    REQUIRE(restored->getName() == generated->getName());
+    REQUIRE(restored->numStages() == generated->numStages());
+    REQUIRE(restored->hasAttribute(mx::HW::ATTR_TRANSPARENT) == generated->hasAttribute(mx::HW::ATTR_TRANSPARENT));
+    REQUIRE(restored->hasClassification(mx::ShaderNode::Classification::SHADER) ==
+            generated->hasClassification(mx::ShaderNode::Classification::SHADER));
+    for (size_t i = 0; i < generated->numStages(); i++)
+    {
+        const mx::ShaderStage& stage = generated->getStage(i);
+        const mx::ShaderStage& restoredStage = restored->getStage(stage.getName());
+        REQUIRE(restoredStage.getSourceCode() == stage.getSourceCode());
+        REQUIRE(restoredStage.getFunctionName() == stage.getFunctionName());
+        REQUIRE(restoredStage.getUniformBlocks().size() == stage.getUniformBlocks().size());
+        for (const auto& pair : stage.getUniformBlocks())
+        {
+            const mx::VariableBlock& block = *pair.second;
+            const mx::VariableBlock& restoredBlock = restoredStage.getUniformBlock(pair.first);
+            REQUIRE(restoredBlock.getInstance() == block.getInstance());
+            REQUIRE(restoredBlock.size() == block.size());
+            for (size_t j = 0; j < block.size(); j++)
+            {
+                REQUIRE(restoredBlock[j]->getName() == block[j]->getName());
+                REQUIRE(restoredBlock[j]->getType() == block[j]->getType());
+                REQUIRE(restoredBlock[j]->getVariable() == block[j]->getVariable());
+                REQUIRE(restoredBlock[j]->getPath() == block[j]->getPath());
+                REQUIRE(restoredBlock[j]->getFlags() == block[j]->getFlags());
+                REQUIRE((restoredBlock[j]->getValue() != nullptr) == (block[j]->getValue() != nullptr));
+                if (block[j]->getValue())
+                {
+                    REQUIRE(restoredBlock[j]->getValue()->getValueString() == block[j]->getValue()->getValueString());
+                }
+            }
+        }
+        REQUIRE(restoredStage.getInputBlocks().size() == stage.getInputBlocks().size());
+        REQUIRE(restoredStage.getOutputBlocks().size() == stage.getOutputBlocks().size());
+    }
+
+    // Verify that changes to options and content produce new keys.
+    const std::string key = cache->computeKey(element->getName(), element, context);
+    context.getOptions().hwTransparency = !context.getOptions().hwTransparency;
+    REQUIRE(cache->computeKey(element->getName(), element, context) != key);
+    context.getOptions().hwTransparency = !context.getOptions().hwTransparency;
+    REQUIRE(cache->computeKey(element->getName(), element, context) == key);
+    mx::NodePtr imageNode;
+    for (mx::NodeGraphPtr nodeGraph : doc->getNodeGraphs())
+    {
+        imageNode = nodeGraph->getNode("image_color");
+        if (imageNode)
+        {
+            break;
+        }
+    }
+    REQUIRE(imageNode);
+    imageNode->setInputValue("uvtiling", mx::Vector2(2.0f, 2.0f));
+    REQUIRE(cache->computeKey(element->getName(), element, context) != key);
+
+    // Verify that created and edited source files produce new keys.
+    const mx::FilePath sourcePath = cacheDir / mx::FilePath("shader_cache_source.glsl");
+    auto writeSource = [&sourcePath](const std::string& content)
+    {
+        std::ofstream file(sourcePath.asString(), std::ios::binary);
+        file << content;
+    };
+    std::remove(sourcePath.asString().c_str());
+    mx::NodeDefPtr sourceNodeDef = doc->addNodeDef("ND_cachetest_float", "float", "cachetest");
+    mx::ImplementationPtr sourceImpl = doc->addImplementation("IM_cachetest_float_genglsl");
+    sourceImpl->setNodeDef(sourceNodeDef);
+    sourceImpl->setTarget(mx::GlslShaderGenerator::TARGET);
+    sourceImpl->setFile(sourcePath.asString());
+    sourceImpl->setFunction("mx_cachetest");
+    mx::NodePtr sourceNode = doc->addNode("cachetest", "cachetest1", "float");
+    const std::string missingKey = cache->computeKey(sourceNode->getName(), sourceNode, context);
+    writeSource("void mx_cachetest(out float result) { result = 0.0; }\n");
+    const std::string sourceKey = cache->computeKey(sourceNode->getName(), sourceNode, context);
+    REQUIRE(sourceKey != missingKey);
+    const uint64_t modificationTime = sourcePath.getModificationTime();
+    for (int i = 0; i < 200 && sourcePath.getModificationTime() == modificationTime; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        writeSource("void mx_cachetest(out float result) { result = 1.0; }\n");
+    }
+    REQUIRE(cache->computeKey(sourceNode->getName(), sourceNode, context) != sourceKey);
+    std::remove(sourcePath.asString().c_str());
+
+    for (const mx::FilePath& file : cacheDir.getFilesInDirectory("mtlxshader"))
+    {
+        std::remove((cacheDir / file).asString().c_str());
+    }
+    std::remove(cacheDir.asString().c_str());
+}
+
+TEST_CASE("GenShader: GLSL Shared Implementations", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    mx::readFromXmlFile(doc, "resources/Materials/Examples/StandardSurface/standard_surface_brass_tiled.mtlx");
+
+    std::vector<mx::TypedElementPtr> elements;
+    mx::findRenderableElements(doc, elements);
+    REQUIRE(!elements.empty());
+    std::vector<mx::NodePtr> shaderNodes = mx::getShaderNodes(elements[0]->asA<mx::Node>());
+    REQUIRE(!shaderNodes.empty());
+    mx::NodePtr shaderNode = shaderNodes[0];
+
+    // Generate a reference shader without a shared cache.
+    mx::GenContext referenceContext(mx::GlslShaderGenerator::create());
+    referenceContext.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    mx::ShaderPtr reference = referenceContext.getShaderGenerator().generate(shaderNode->getName(), shaderNode, referenceContext);
+    REQUIRE(reference);
+    const std::string referenceCode = reference->getSourceCode(mx::Stage::PIXEL);
+    mx::StringSet referenceNames;
+    referenceContext.getNodeImplementationNames(referenceNames);
+
+    // Generate concurrently with per-thread contexts sharing one cache.
+    mx::ShaderNodeImplCachePtr sharedCache = mx::ShaderNodeImplCache::create();
+    const size_t threadCount = 4;
+    std::vector<std::unique_ptr<mx::GenContext>> contexts;
+    std::vector<std::string> results(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        contexts.emplace_back(new mx::GenContext(mx::GlslShaderGenerator::create()));
+        contexts[i]->registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+        contexts[i]->setShaderNodeImplCache(sharedCache);
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            mx::GenContext& context = *contexts[i];
+            mx::ShaderPtr shader = context.getShaderGenerator().generate(shaderNode->getName(), shaderNode, context);
+            results[i] = shader->getSourceCode(mx::Stage::PIXEL);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Verify that each implementation was created once and shared.
+    // Implementations nested in compounds are only cached in the
+    // context that created them.
+    REQUIRE(sharedCache->size() == referenceNames.size());
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        REQUIRE(results[i] == referenceCode);
+        mx::StringSet names;
+        contexts[i]->getNodeImplementationNames(names);
+        for (const std::string& name : names)
+        {
+            mx::ShaderNodeImplPtr firstImpl = contexts[0]->findNodeImplementation(name);
+            REQUIRE((!firstImpl || firstImpl == contexts[i]->findNodeImplementation(name)));
+        }
+    }
+
+    // Verify that implementations added to a context take precedence.
+    mx::GenContext overrideContext(mx::GlslShaderGenerator::create());
+    overrideContext.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    overrideContext.setShaderNodeImplCache(sharedCache);
+    mx::InterfaceElementPtr impl = shaderNode->getNodeDef()->getImplementation(mx::GlslShaderGenerator::TARGET);
+    REQUIRE(impl);
+    mx::ShaderNodeImplPtr overrideImpl = mx::CompoundNode::create();
+    overrideImpl->initialize(*impl, overrideContext);
+    overrideContext.addNodeImplementation(impl->getName(), overrideImpl);
+    REQUIRE(overrideContext.getShaderGenerator().getImplementation(*impl, overrideContext) == overrideImpl);
+    REQUIRE(overrideImpl != contexts[0]->findNodeImplementation(impl->getName()));
+
+    // Verify that implementations with the same name and no source URI are
+    // shared only when their contents match.
+    auto createInMemoryImpl = [&sharedCache](const std::string& source)
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_inmemory_float", "float", "inmemory");
+        mx::ImplementationPtr impl = doc->addImplementation("IM_inmemory_float_genglsl");
+        impl->setNodeDef(nodeDef);
+        impl->setTarget(mx::GlslShaderGenerator::TARGET);
+        impl->setAttribute("sourcecode", source);
+        impl->setFunction("mx_inmemory_float");
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.setShaderNodeImplCache(sharedCache);
+        return context.getShaderGenerator().getImplementation(*impl, context);
+    };
+    mx::ShaderNodeImplPtr inMemoryImpl = createInMemoryImpl("void mx_inmemory_float(out float result) { result = 0.0; }");
+    REQUIRE(createInMemoryImpl("void mx_inmemory_float(out float result) { result = 0.0; }") == inMemoryImpl);
+    REQUIRE(createInMemoryImpl("void mx_inmemory_float(out float result) { result = 1.0; }") != inMemoryImpl);
+}
+
+TEST_CASE("GenShader: GLSL Function Deduplication", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    // Nodedefs whose implementations share a function, or reuse its name.
+    const std::string sharedSource = "void mx_dedup_float(float in, out float result) { result = in * 2.0; }";
+    const std::string otherSource = "void mx_dedup_float(float in, out float result) { result = in * 3.0; }";
+    auto addDefinition = [](mx::DocumentPtr doc, const std::string& node, const std::string& source)
+    {
+        mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_" + node + "_float", "float", node);
+        nodeDef->setInputValue("in", 0.0f);
+        mx::ImplementationPtr impl = doc->addImplementation("IM_" + node + "_float_genglsl");
+        impl->setNodeDef(nodeDef);
+        impl->setTarget(mx::GlslShaderGenerator::TARGET);
+        impl->setAttribute("sourcecode", source);
+        impl->setFunction("mx_dedup_float");
+    };
+
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->importLibrary(libraries);
+    addDefinition(doc, "dedup_a", sharedSource);
+    addDefinition(doc, "dedup_b", sharedSource);
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("dedup");
+    mx::NodePtr nodeA = nodeGraph->addNode("dedup_a", "nodeA", "float");
+    nodeA->setInputValue("in", 0.5f);
+    mx::NodePtr nodeB = nodeGraph->addNode("dedup_b", "nodeB", "float");
+    nodeB->setConnectedNode("in", nodeA);
+    mx::OutputPtr output = nodeGraph->addOutput("out", "float");
+    output->setConnectedNode(nodeB);
+    REQUIRE(doc->validate());
+
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    mx::ShaderPtr shader = context.getShaderGenerator().generate(output->getName(), output, context);
+    REQUIRE(shader);
+
+    // Identical functions from different nodedefs are emitted once.
+    const std::string code = shader->getSourceCode(mx::Stage::PIXEL);
+    const size_t first = code.find(sharedSource);
+    REQUIRE(first != std::string::npos);
+    REQUIRE(code.find(sharedSource, first + 1) == std::string::npos);
+    mx::ShaderNodeImplPtr implA = context.findNodeImplementation("IM_dedup_a_float_genglsl");
+    mx::ShaderNodeImplPtr implB = context.findNodeImplementation("IM_dedup_b_float_genglsl");
+    REQUIRE(implA);
+    REQUIRE(implB);
+    REQUIRE(implA->getHash() == implB->getHash());
+
+    // Implementations with the same function name and a different body
+    // do not share a hash.
+    mx::DocumentPtr otherDoc = mx::createDocument();
+    addDefinition(otherDoc, "dedup_a", otherSource);
+    mx::ShaderNodeImplPtr otherImpl = mx::SourceCodeNode::create();
+    otherImpl->initialize(*otherDoc->getImplementation("IM_dedup_a_float_genglsl"), context);
+    REQUIRE(otherImpl->getHash() != implA->getHash());
+
+    // Compound implementations of the same name hash their contents.
+    auto createCompound = [&libraries, &context](float scale)
+    {
+        mx::DocumentPtr compoundDoc = mx::createDocument();
+        compoundDoc->importLibrary(libraries);
+        mx::NodeDefPtr nodeDef = compoundDoc->addNodeDef("ND_dedupgraph_float", "float", "dedupgraph");
+        nodeDef->setInputValue("in", 0.0f);
+        mx::NodeGraphPtr graph = compoundDoc->addNodeGraph("NG_dedupgraph_float");
+        graph->setNodeDef(nodeDef);
+        mx::NodePtr multiply = graph->addNode("multiply", "multiply", "float");
+        multiply->addInput("in1", "float")->setInterfaceName("in");
+        multiply->setInputValue("in2", scale);
+        graph->addOutput("out", "float")->setConnectedNode(multiply);
+        mx::ShaderNodeImplPtr impl = mx::CompoundNode::create();
+        impl->initialize(*graph, context);
+        return impl->getHash();
+    };
+    REQUIRE(createCompound(2.0f) == createCompound(2.0f));
+    REQUIRE(createCompound(2.0f) != createCompound(3.0f));
+}
+
+TEST_CASE("GenShader: GLSL Deterministic Generation", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    // Generate code for all renderable elements in the given document,
+    // keyed by element path.
+    auto generateAll = [&currentPath](mx::DocumentPtr doc)
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+
+        std::vector<mx::TypedElementPtr> elements;
+        mx::findRenderableElements(doc, elements);
+        std::map<std::string, std::string> results;
+        for (mx::TypedElementPtr element : elements)
+        {
+            mx::NodePtr node = element->asA<mx::Node>();
+            if (node && node->getType() == mx::MATERIAL_TYPE_STRING)
+            {
+                std::vector<mx::NodePtr> shaderNodes = mx::getShaderNodes(node);
+                if (shaderNodes.empty())
+                {
+                    continue;
+                }
+                element = shaderNodes[0];
+            }
+            std::string result;
+            try
+            {
+                mx::ShaderPtr shader = context.getShaderGenerator().generate(element->getName(), element, context);
+                for (size_t i = 0; i < shader->numStages(); i++)
+                {
+                    result += shader->getStage(i).getSourceCode();
+                }
+            }
+            catch (mx::Exception& e)
+            {
+                result += e.what();
+            }
+            results[element->getNamePath()] = result;
+        }
+        return results;
+    };
+
+    // Shuffle the nodes of the document and all of its node graphs,
+    // changing the order in which they are stored and traversed.
+    std::mt19937 randomEngine(42);
+    auto shuffleNodes = [&randomEngine](mx::ElementPtr parent)
+    {
+        std::vector<mx::NodePtr> nodes = parent->getChildrenOfType<mx::Node>();
+        std::shuffle(nodes.begin(), nodes.end(), randomEngine);
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            parent->setChildIndex(nodes[i]->getName(), (int) i);
+        }
+    };
+
+    const mx::FilePath testRootPath = currentPath / mx::FilePath("resources/Materials/TestSuite");
+    size_t shaderCount = 0;
+    for (const mx::FilePath& dir : testRootPath.getSubDirectories())
+    {
+        for (const mx::FilePath& file : dir.getFilesInDirectory(mx::MTLX_EXTENSION))
+        {
+            mx::DocumentPtr doc = mx::createDocument();
+            doc->importLibrary(libraries);
+            try
+            {
+                mx::readFromXmlFile(doc, dir / file, searchPath);
+            }
+            catch (mx::Exception&)
+            {
+                continue;
+            }
+
+            std::map<std::string, std::string> original = generateAll(doc);
+            shuffleNodes(doc);
+            for (mx::NodeGraphPtr nodeGraph : doc->getNodeGraphs())
+            {
+                shuffleNodes(nodeGraph);
+            }
+            std::map<std::string, std::string> shuffled = generateAll(doc);
+
+            INFO("File: " + (dir / file).asString());
+            REQUIRE(original.size() == shuffled.size());
+            for (const auto& pair : original)
+            {
+                INFO("Element: " + pair.first);
+                REQUIRE(pair.second == shuffled[pair.first]);
+            }
+            shaderCount += original.size();
+        }
+    }
+    REQUIRE(shaderCount > 0);
+}
+
+TEST_CASE("GenShader: GLSL Graph Optimization", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    auto generate = [&currentPath](mx::TypedElementPtr element, int optimizationLevel)
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+        context.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_REDUCED;
+        context.getOptions().optimizationLevel = optimizationLevel;
+        return context.getShaderGenerator().generate(element->getName(), element, context);
+    };
+
+    // A graph with a constant math chain and duplicated texture lookups.
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->importLibrary(libraries);
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("optimize");
+    mx::NodePtr scale = nodeGraph->addNode("multiply", "scale", "color3");
+    scale->setInputValue("in1", mx::Color3(0.25f, 0.5f, 0.75f));
+    scale->setInputValue("in2", 2.0f);
+    mx::NodePtr offset = nodeGraph->addNode("add", "offset", "color3");
+    offset->setConnectedNode("in1", scale);
+    offset->setInputValue("in2", mx::Color3(0.125f, 0.25f, 0.5f));
+    mx::NodePtr channel = nodeGraph->addNode("swizzle", "channel", "float");
+    channel->setConnectedNode("in", offset);
+    channel->setInputValue("channels", std::string("g"));
+    mx::NodePtr sum = nodeGraph->addNode("add", "sum", "color3");
+    for (const char* suffix : { "1", "2" })
+    {
+        mx::NodePtr texcoord = nodeGraph->addNode("texcoord", std::string("texcoord") + suffix, "vector2");
+        mx::NodePtr image = nodeGraph->addNode("image", std::string("image") + suffix, "color3");
+        image->setInputValue("file", std::string("resources/Images/grid.png"), mx::FILENAME_TYPE_STRING);
+        image->setConnectedNode("texcoord", texcoord);
+        sum->setConnectedNode(std::string("in") + suffix, image);
+    }
+    mx::NodePtr product = nodeGraph->addNode("multiply", "product", "color3");
+    product->setConnectedNode("in1", sum);
+    product->setConnectedNode("in2", offset);
+    mx::NodePtr weight = nodeGraph->addNode("multiply", "weight", "color3");
+    weight->setConnectedNode("in1", product);
+    weight->setConnectedNode("in2", channel);
+    mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+    output->setConnectedNode(weight);
+    REQUIRE(doc->validate());
+
+    mx::ShaderPtr basic = generate(output, mx::SHADER_OPTIMIZATION_BASIC);
+    mx::ShaderPtr full = generate(output, mx::SHADER_OPTIMIZATION_FULL);
+    REQUIRE(basic);
+    REQUIRE(full);
+
+    const mx::ShaderGraph& basicGraph = basic->getGraph();
+    REQUIRE(basicGraph.getNode("scale"));
+    REQUIRE(basicGraph.getNode("image1"));
+    REQUIRE(basicGraph.getNode("image2"));
+
+    // Constant nodes are folded into downstream values, including swizzles.
+    const mx::ShaderGraph& fullGraph = full->getGraph();
+    REQUIRE(!fullGraph.getNode("scale"));
+    REQUIRE(!fullGraph.getNode("offset"));
+    REQUIRE(!fullGraph.getNode("channel"));
+    const mx::ShaderNode* productNode = fullGraph.getNode("product");
+    REQUIRE(productNode);
+    REQUIRE(!productNode->getInput("in2")->getConnection());
+    REQUIRE(productNode->getInput("in2")->getValue()->asA<mx::Color3>() == mx::Color3(0.625f, 1.25f, 2.0f));
+    const mx::ShaderNode* weightNode = fullGraph.getNode("weight");
+    REQUIRE(weightNode);
+    REQUIRE(weightNode->getInput("in2")->getValue()->asA<float>() == 1.25f);
+
+    // Identical texture lookups are merged.
+    REQUIRE((fullGraph.getNode("image1") != nullptr) != (fullGraph.getNode("image2") != nullptr));
+    REQUIRE((fullGraph.getNode("texcoord1") != nullptr) != (fullGraph.getNode("texcoord2") != nullptr));
+    const mx::ShaderNode* sumNode = fullGraph.getNode("sum");
+    REQUIRE(sumNode);
+    REQUIRE(sumNode->getInput("in1")->getConnection() == sumNode->getInput("in2")->getConnection());
+
+    const std::string& basicCode = basic->getSourceCode(mx::Stage::PIXEL);
+    const std::string& fullCode = full->getSourceCode(mx::Stage::PIXEL);
+    REQUIRE(fullCode.size() < basicCode.size());
+
+    // Nodes with custom nodedefs are not folded, even when their node string
+    // matches that of a standard library node.
+    mx::NodeDefPtr customDef = doc->addNodeDef("ND_custom_add_float", "float", "add");
+    customDef->addInput("in1", "float");
+    customDef->addInput("in2", "float");
+    mx::ImplementationPtr customImpl = doc->addImplementation("IM_custom_add_float_genglsl");
+    customImpl->setNodeDef(customDef);
+    customImpl->setTarget(mx::GlslShaderGenerator::TARGET);
+    customImpl->setAttribute("sourcecode", "void mx_custom_add_float(float in1, float in2, out float result) { result = in1 - in2; }");
+    customImpl->setFunction("mx_custom_add_float");
+    mx::NodeGraphPtr customGraph = doc->addNodeGraph("custom_user");
+    mx::NodePtr customAdd = customGraph->addNode("add", "custom_add", "float");
+    customAdd->setNodeDefString(customDef->getName());
+    customAdd->setInputValue("in1", 0.75f);
+    customAdd->setInputValue("in2", 0.25f);
+    mx::NodePtr customScale = customGraph->addNode("multiply", "custom_scale", "float");
+    customScale->setConnectedNode("in1", customAdd);
+    customScale->setInputValue("in2", 2.0f);
+    mx::OutputPtr customOutput = customGraph->addOutput("out", "float");
+    customOutput->setConnectedNode(customScale);
+    mx::ShaderPtr custom = generate(customOutput, mx::SHADER_OPTIMIZATION_FULL);
+    REQUIRE(custom);
+    REQUIRE(custom->getGraph().getNode("custom_add"));
+    REQUIRE(custom->getGraph().getNode("custom_scale"));
+
+    // Full optimization must succeed wherever basic optimization does.
+    const mx::FilePath testRootPath = currentPath / mx::FilePath("resources/Materials/TestSuite/stdlib");
+    size_t shaderCount = 0;
+    for (const char* dirName : { "math", "channel", "compositing", "adjustment", "texture" })
+    {
+        const mx::FilePath dir = testRootPath / mx::FilePath(dirName);
+        for (const mx::FilePath& file : dir.getFilesInDirectory(mx::MTLX_EXTENSION))
+        {
+            mx::DocumentPtr testDoc = mx::createDocument();
+            testDoc->importLibrary(libraries);
+            mx::readFromXmlFile(testDoc, dir / file, searchPath);
+
+            std::vector<mx::TypedElementPtr> elements;
+            mx::findRenderableElements(testDoc, elements);
+            for (mx::TypedElementPtr element : elements)
+            {
+                try
+                {
+                    generate(element, mx::SHADER_OPTIMIZATION_BASIC);
+                }
+                catch (mx::Exception&)
+                {
+                    continue;
+                }
+                INFO("Element: " + element->getNamePath());
+                REQUIRE_NOTHROW(generate(element, mx::SHADER_OPTIMIZATION_FULL));
+                shaderCount++;
+            }
+        }
+    }
+    REQUIRE(shaderCount > 0);
+
+    // Compound implementations optimize their subgraphs when initialized, so
+    // each optimization level is cached separately in a shared cache.
+    mx::NodeDefPtr nodeDef = doc->addNodeDef("ND_scaled_offset", "color3", "scaled_offset");
+    nodeDef->addInput("in", "color3");
+    mx::NodeGraphPtr compound = doc->addNodeGraph("NG_scaled_offset");
+    compound->setNodeDef(nodeDef);
+    mx::NodePtr compoundScale = compound->addNode("multiply", "scale", "color3");
+    compoundScale->setInputValue("in1", mx::Color3(0.25f, 0.5f, 0.75f));
+    compoundScale->setInputValue("in2", 2.0f);
+    mx::NodePtr compoundOffset = compound->addNode("add", "offset", "color3");
+    compoundOffset->addInput("in1", "color3")->setInterfaceName("in");
+    compoundOffset->setConnectedNode("in2", compoundScale);
+    compound->addOutput("out", "color3")->setConnectedNode(compoundOffset);
+    mx::NodeGraphPtr compoundUser = doc->addNodeGraph("compound_user");
+    mx::NodePtr compoundImage = compoundUser->addNode("image", "image", "color3");
+    compoundImage->setInputValue("file", std::string("resources/Images/grid.png"), mx::FILENAME_TYPE_STRING);
+    mx::NodePtr compoundNode = compoundUser->addNode("scaled_offset", "scaled_offset", "color3");
+    compoundNode->setConnectedNode("in", compoundImage);
+    mx::OutputPtr compoundOutput = compoundUser->addOutput("out", "color3");
+    compoundOutput->setConnectedNode(compoundNode);
+    REQUIRE(doc->validate());
+
+    const std::string compoundBasic = generate(compoundOutput, mx::SHADER_OPTIMIZATION_BASIC)->getSourceCode(mx::Stage::PIXEL);
+    const std::string compoundFull = generate(compoundOutput, mx::SHADER_OPTIMIZATION_FULL)->getSourceCode(mx::Stage::PIXEL);
+    REQUIRE(compoundBasic != compoundFull);
+
+    mx::ShaderNodeImplCachePtr sharedCache = mx::ShaderNodeImplCache::create();
+    for (int optimizationLevel : { mx::SHADER_OPTIMIZATION_BASIC, mx::SHADER_OPTIMIZATION_FULL })
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+        context.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_REDUCED;
+        context.getOptions().optimizationLevel = optimizationLevel;
+        context.setShaderNodeImplCache(sharedCache);
+        mx::ShaderPtr shader = context.getShaderGenerator().generate(compoundOutput->getName(), compoundOutput, context);
+        REQUIRE(shader);
+        const std::string& expected = optimizationLevel == mx::SHADER_OPTIMIZATION_FULL ? compoundFull : compoundBasic;
+        REQUIRE(shader->getSourceCode(mx::Stage::PIXEL) == expected);
+    }
+}
+
+TEST_CASE("GenShader: GLSL Shader Permutations", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    // Materials with a textured base color, differing in values, filenames
+    // and the names of their graphs.
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->importLibrary(libraries);
+    auto addShader = [&doc](const std::string& suffix, const std::string& file, const mx::Color3& tint, float roughness)
+    {
+        mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("NG_" + suffix);
+        mx::NodePtr image = nodeGraph->addNode("image", "image", "color3");
+        image->setInputValue("file", file, mx::FILENAME_TYPE_STRING);
+        mx::NodePtr multiply = nodeGraph->addNode("multiply", "tint", "color3");
+        multiply->setConnectedNode("in1", image);
+        multiply->setInputValue("in2", tint);
+        mx::OutputPtr output = nodeGraph->addOutput("out", "color3");
+        output->setConnectedNode(multiply);
+        mx::NodePtr shader = doc->addNode("standard_surface", "SR_" + suffix, mx::SURFACE_SHADER_TYPE_STRING);
+        shader->setConnectedOutput("base_color", output);
+        shader->setInputValue("specular_roughness", roughness);
+        return shader;
+    };
+    std::vector<mx::NodePtr> shaders;
+    shaders.push_back(addShader("a", "resources/Images/grid.png", mx::Color3(1.0f, 0.5f, 0.25f), 0.2f));
+    shaders.push_back(addShader("b", "resources/Images/cloth.png", mx::Color3(0.5f, 1.0f, 0.5f), 0.6f));
+    shaders.push_back(addShader("c", "resources/Images/grid.png", mx::Color3(1.0f, 0.5f, 0.25f), 0.8f));
+    shaders.push_back(addShader("d", "resources/Images/grid.png", mx::Color3(1.0f, 0.5f, 0.25f), 0.2f));
+    shaders.back()->setConnectedOutput("coat_color", doc->getNodeGraph("NG_d")->getOutput("out"));
+    REQUIRE(doc->validate());
+
+    auto setupContext = [&currentPath](mx::GenContext& context, int shaderInterfaceType)
+    {
+        context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+        context.getOptions().shaderInterfaceType = shaderInterfaceType;
+    };
+
+    // Return the values of the public uniforms of a shader, with the given overrides.
+    auto getUniformValues = [](mx::ShaderPtr shader, const mx::UniformValueMap& overrides)
+    {
+        std::map<std::string, std::string> values;
+        const mx::VariableBlock& uniforms = shader->getStage(mx::Stage::PIXEL).getUniformBlock(mx::HW::PUBLIC_UNIFORMS);
+        for (size_t i = 0; i < uniforms.size(); i++)
+        {
+            const mx::ShaderPort* port = uniforms[i];
+            auto it = overrides.find(port->getVariable());
+            mx::ValuePtr value = it != overrides.end() ? it->second : port->getValue();
+            values[port->getVariable()] = value ? value->getValueString() : std::string();
+        }
+        return values;
+    };
+
+    // With a complete interface all values are published, so materials of the
+    // same topology share a shader.
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    setupContext(context, mx::SHADER_INTERFACE_COMPLETE);
+    mx::ShaderPermutationCache cache;
+    std::vector<mx::ShaderPermutation> permutations;
+    for (mx::NodePtr shader : shaders)
+    {
+        permutations.push_back(cache.generate("permutation", shader, context));
+        REQUIRE(permutations.back().shader);
+        REQUIRE(permutations.back().signature == cache.computeSignature(shader, context));
+    }
+    REQUIRE(permutations[0].signature == permutations[1].signature);
+    REQUIRE(permutations[0].signature != permutations[3].signature);
+    REQUIRE(permutations[0].shader == permutations[1].shader);
+    REQUIRE(permutations[0].shader == permutations[2].shader);
+    REQUIRE(permutations[0].shader != permutations[3].shader);
+    REQUIRE(cache.getShaderCount() == 2);
+    REQUIRE(cache.getHitCount() == 2);
+
+    // Shared shaders with per-material values match shaders generated directly.
+    // Shared code is generated for the first material of each topology, so it
+    // differs from direct code only in the default values of uniforms.
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        mx::GenContext directContext(mx::GlslShaderGenerator::create());
+        setupContext(directContext, mx::SHADER_INTERFACE_COMPLETE);
+        mx::ShaderPtr direct = directContext.getShaderGenerator().generate("permutation", shaders[i], directContext);
+        if (i == 0 || i == 3)
+        {
+            REQUIRE(direct->getSourceCode(mx::Stage::PIXEL) == permutations[i].shader->getSourceCode(mx::Stage::PIXEL));
+        }
+        REQUIRE(getUniformValues(direct, {}) == getUniformValues(permutations[i].shader, permutations[i].uniformValues));
+    }
+    REQUIRE(permutations[1].uniformValues["tint_in2"]->asA<mx::Color3>() == mx::Color3(0.5f, 1.0f, 0.5f));
+    REQUIRE(permutations[1].uniformValues["specular_roughness"]->asA<float>() == 0.6f);
+
+    // With a reduced interface graph values are compiled into the code, so only
+    // materials that differ in interface values share a shader.
+    mx::GenContext reducedContext(mx::GlslShaderGenerator::create());
+    setupContext(reducedContext, mx::SHADER_INTERFACE_REDUCED);
+    cache.clear();
+    permutations.clear();
+    for (mx::NodePtr shader : shaders)
+    {
+        permutations.push_back(cache.generate("permutation", shader, reducedContext));
+    }
+    REQUIRE(permutations[0].signature == permutations[1].signature);
+    REQUIRE(permutations[0].shader != permutations[1].shader);
+    REQUIRE(permutations[0].shader == permutations[2].shader);
+    REQUIRE(permutations[2].uniformValues["specular_roughness"]->asA<float>() == 0.8f);
+    REQUIRE(cache.getShaderCount() == 3);
+}
+
+TEST_CASE("GenShader: GLSL Generation Profiling", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    mx::readFromXmlFile(doc, "resources/Materials/Examples/StandardSurface/standard_surface_brass_tiled.mtlx");
+    std::vector<mx::TypedElementPtr> elements;
+    mx::findRenderableElements(doc, elements);
+    REQUIRE(!elements.empty());
+    mx::NodePtr shaderNode = mx::getShaderNodes(elements[0]->asA<mx::Node>())[0];
+
+    // Generate with and without a profiler.
+    mx::GenContext context(mx::GlslShaderGenerator::create());
+    context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    mx::ShaderPtr reference = context.getShaderGenerator().generate(shaderNode->getName(), shaderNode, context);
+    REQUIRE(reference);
+
+    mx::GenContext profiledContext(mx::GlslShaderGenerator::create());
+    profiledContext.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    mx::GenProfilerPtr profiler = mx::GenProfiler::create();
+    profiler->setTraceEnabled(true);
+    profiledContext.setProfiler(profiler);
+    mx::ShaderPtr shader = profiledContext.getShaderGenerator().generate(shaderNode->getName(), shaderNode, profiledContext);
+    REQUIRE(shader);
+    REQUIRE(shader->getSourceCode(mx::Stage::PIXEL) == reference->getSourceCode(mx::Stage::PIXEL));
+
+    // Phases and implementations are timed.
+    mx::GenTimingMap phases = profiler->getPhaseTimings();
+    for (const char* phase : { "GlslShaderGenerator::generate", "GlslShaderGenerator::emitPixelStage",
+                                      "ShaderGraph::create", "ShaderGraph::createNode", "ShaderGraph::finalize",
+                                      "ShaderGraph::optimize", "ShaderGraph::setVariableNames", "ShaderStage::addInclude" })
+    {
+        REQUIRE(phases.count(phase));
+        REQUIRE(phases[phase].count > 0);
+    }
+    REQUIRE(phases["GlslShaderGenerator::generate"].count == 1);
+    REQUIRE(phases["GlslShaderGenerator::generate"].seconds >= phases["GlslShaderGenerator::emitPixelStage"].seconds);
+    mx::GenTimingMap implementations = profiler->getImplementationTimings();
+    REQUIRE(implementations.count("IM_image_color3_genglsl"));
+    REQUIRE(implementations.count("IM_image_float_genglsl"));
+
+    // Counters describe the graph and the emitted code.
+    REQUIRE(profiler->getCounter(mx::GenProfiler::NODES_BEFORE_OPTIMIZATION) > 0);
+    REQUIRE(profiler->getCounter(mx::GenProfiler::NODES_AFTER_OPTIMIZATION) <= profiler->getCounter(mx::GenProfiler::NODES_BEFORE_OPTIMIZATION));
+    REQUIRE(profiler->getCounter(mx::GenProfiler::INCLUDE_READS) > 0);
+    REQUIRE(profiler->getCounter(mx::GenProfiler::INCLUDE_BYTES) > 0);
+    REQUIRE(profiler->getCounter(mx::GenProfiler::STAGE_BYTES_PREFIX + mx::Stage::PIXEL) == shader->getSourceCode(mx::Stage::PIXEL).size());
+    REQUIRE(profiler->getCounter(mx::GenProfiler::STAGE_BYTES_PREFIX + mx::Stage::VERTEX) == shader->getSourceCode(mx::Stage::VERTEX).size());
+
+    // Export formats.
+    const std::string json = profiler->toJson();
+    REQUIRE(json.find("\"phases\"") != std::string::npos);
+    REQUIRE(json.find("\"ShaderGraph::optimize\"") != std::string::npos);
+    const std::string trace = profiler->toChromeTrace();
+    REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(trace.find("\"ph\": \"X\"") != std::string::npos);
+    REQUIRE(trace.find("\"ph\": \"C\"") != std::string::npos);
+
+    profiler->clear();
+    REQUIRE(profiler->getPhaseTimings().empty());
+    REQUIRE(profiler->getCounters().empty());
+
+    // Timings within a scope are merged when the outermost scope ends.
+    const std::string outerPhase = "outerPhase";
+    const std::string innerPhase = "innerPhase";
+    {
+        mx::ScopedGenTimer outerTimer(profiler.get(), outerPhase);
+        {
+            mx::ScopedGenTimer innerTimer(profiler.get(), innerPhase);
+            profiler->addCounter("innerCounter");
+        }
+        REQUIRE(profiler->getPhaseTimings().empty());
+        REQUIRE(profiler->getCounter("innerCounter") == 0);
+    }
+    phases = profiler->getPhaseTimings();
+    REQUIRE(phases[outerPhase].count == 1);
+    REQUIRE(phases[innerPhase].count == 1);
+    REQUIRE(phases[outerPhase].seconds >= phases[innerPhase].seconds);
+    REQUIRE(profiler->getCounter("innerCounter") == 1);
+}
+
+TEST_CASE("GenShader: GLSL Specular Environment Methods", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    mx::readFromXmlFile(doc, "resources/Materials/Examples/StandardSurface/standard_surface_default.mtlx");
+    std::vector<mx::TypedElementPtr> elements;
+    mx::findRenderableElements(doc, elements);
+    REQUIRE(!elements.empty());
+    mx::NodePtr shaderNode = mx::getShaderNodes(elements[0]->asA<mx::Node>())[0];
+
+    // Each method includes its own environment functions.
+    const std::vector<std::pair<mx::HwSpecularEnvironmentMethod, std::string>> methods =
+    {
+        { mx::SPECULAR_ENVIRONMENT_FIS, "mx_spherical_fibonacci(i, envRadianceSamples)" },
+        { mx::SPECULAR_ENVIRONMENT_PREFILTER, "mx_latlong_compute_lod(float roughness)" },
+        { mx::SPECULAR_ENVIRONMENT_PREFILTER_GGX, "mx_prefilter_environment_lookup(vec3 dir, float roughness)" }
+    };
+    for (const auto& method : methods)
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+        context.getOptions().hwSpecularEnvironmentMethod = method.first;
+        mx::ShaderPtr shader = context.getShaderGenerator().generate(shaderNode->getName(), shaderNode, context);
+        REQUIRE(shader);
+        const std::string& code = shader->getSourceCode(mx::Stage::PIXEL);
+        for (const auto& other : methods)
+        {
+            REQUIRE((code.find(other.second) != std::string::npos) == (other.first == method.first));
+        }
+        REQUIRE(code.find(mx::HW::ENV_RADIANCE + ";") != std::string::npos);
+    }
+}
+
+// Gather the shader elements of all TestSuite documents.
+static size_t gatherBatchElements(mx::DocumentPtr libraries,
+                                  std::vector<mx::DocumentPtr>& documents,
+                                  std::vector<std::vector<mx::TypedElementPtr>>& documentElements)
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    size_t elementCount = 0;
+    const mx::FilePath testRootPath = currentPath / mx::FilePath("resources/Materials/TestSuite");
+    for (const mx::FilePath& dir : testRootPath.getSubDirectories())
+    {
+        for (const mx::FilePath& file : dir.getFilesInDirectory(mx::MTLX_EXTENSION))
+        {
+            mx::DocumentPtr doc = mx::createDocument();
+            doc->importLibrary(libraries);
+            try
+            {
+                mx::readFromXmlFile(doc, dir / file, searchPath);
+            }
+            catch (mx::Exception&)
+            {
+                continue;
+            }
+
+            std::vector<mx::TypedElementPtr> renderables;
+            mx::findRenderableElements(doc, renderables);
+            std::vector<mx::TypedElementPtr> elements;
+            for (mx::TypedElementPtr element : renderables)
+            {
+                mx::NodePtr node = element->asA<mx::Node>();
+                if (node && node->getType() == mx::MATERIAL_TYPE_STRING)
+                {
+                    std::vector<mx::NodePtr> shaderNodes = mx::getShaderNodes(node);
+                    if (shaderNodes.empty())
+                    {
+                        continue;
+                    }
+                    element = shaderNodes[0];
+                }
+                elements.push_back(element);
+            }
+            if (!elements.empty())
+            {
+                documents.push_back(doc);
+                documentElements.push_back(elements);
+                elementCount += elements.size();
+            }
+        }
+    }
+    return elementCount;
+}
+
+TEST_CASE("GenShader: GLSL Batch Generation", "[genglsl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    std::vector<mx::DocumentPtr> documents;
+    std::vector<std::vector<mx::TypedElementPtr>> documentElements;
+    REQUIRE(gatherBatchElements(libraries, documents, documentElements) > 0);
+
+    // Generate all elements with increasing thread counts, verifying that
+    // results match those of a single thread.
+    std::vector<mx::BatchShaderResultVec> reference;
+    const unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (unsigned int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+    {
+        mx::BatchShaderGenerator batchGenerator([]() { return mx::GlslShaderGenerator::create(); });
+        batchGenerator.setThreadCount(threadCount);
+        batchGenerator.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+
+        std::vector<mx::BatchShaderResultVec> results;
+        for (size_t i = 0; i < documents.size(); i++)
+        {
+            batchGenerator.clearNodeImplementations();
+            results.push_back(batchGenerator.generate(documents[i], documentElements[i]));
+        }
+
+        if (reference.empty())
+        {
+            reference = results;
+            continue;
+        }
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            REQUIRE(results[i].size() == reference[i].size());
+            for (size_t j = 0; j < results[i].size(); j++)
+            {
+                REQUIRE(results[i][j].error == reference[i][j].error);
+                REQUIRE((results[i][j].shader != nullptr) == (reference[i][j].shader != nullptr));
+                if (results[i][j].shader)
+                {
+                    REQUIRE(results[i][j].shader->getName() == documentElements[i][j]->getName());
+                    REQUIRE(results[i][j].shader->getSourceCode(mx::Stage::PIXEL) ==
+                            reference[i][j].shader->getSourceCode(mx::Stage::PIXEL));
+                }
+            }
+        }
+    }
+
+    // Verify that failures are reported per element.
+    size_t docIndex = 0;
+    while (docIndex < reference.size() && !reference[docIndex][0].shader)
+    {
+        docIndex++;
+    }
+    REQUIRE(docIndex < reference.size());
+    mx::DocumentPtr doc = documents[docIndex];
+    mx::TypedElementPtr validElement = documentElements[docIndex][0];
+    mx::NodePtr invalidNode = doc->addNode("unknown_category", "invalid_node", "color3");
+    std::vector<mx::TypedElementPtr> elements = { validElement, invalidNode, validElement };
+    mx::BatchShaderGenerator batchGenerator([]() { return mx::GlslShaderGenerator::create(); });
+    batchGenerator.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    mx::BatchShaderResultVec results = batchGenerator.generate(doc, elements, { "first", "invalid", "last" });
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0].shader);
+    REQUIRE(results[0].shader->getName() == "first");
+    REQUIRE(!results[1].shader);
+    REQUIRE(!results[1].error.empty());
+    REQUIRE(results[2].shader);
+    REQUIRE(results[2].shader->getName() == "last");
+    doc->removeNode(invalidNode->getName());
+
+    // Verify that implementations shared across batches can be cleared.
+    REQUIRE(batchGenerator.getShaderNodeImplCache()->size() > 0);
+    batchGenerator.clearNodeImplementations();
+    REQUIRE(batchGenerator.getShaderNodeImplCache()->size() == 0);
+}
+
+TEST_CASE("GenShader: GLSL Batch Generation Throughput", "[.][benchmark]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::FileSearchPath searchPath(currentPath);
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    std::vector<mx::DocumentPtr> documents;
+    std::vector<std::vector<mx::TypedElementPtr>> documentElements;
+    const size_t elementCount = gatherBatchElements(libraries, documents, documentElements);
+    REQUIRE(elementCount > 0);
+
+    // Report throughput with increasing thread counts.
+    const unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    for (unsigned int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+    {
+        mx::BatchShaderGenerator batchGenerator([]() { return mx::GlslShaderGenerator::create(); });
+        batchGenerator.setThreadCount(threadCount);
+        batchGenerator.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < documents.size(); i++)
+        {
+            batchGenerator.clearNodeImplementations();
+            batchGenerator.generate(documents[i], documentElements[i]);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Batch generation with " << threadCount << " thread(s): " <<
+            elementCount / elapsed.count() << " materials per second" << std::endl;
+    }
+}
+
 static void generateGlslCode(bool generateLayout = false)
 {
     const mx::FilePath testRootPath = mx::FilePath::getCurrentPath() / mx::FilePath("resources/Materials/TestSuite");
@@ -145,7 +1133,7 @@ static void generateGlslCode(bool generateLayout = false)
     if (generateLayout)
     {
         // Set binding context to handle resource binding layouts
-        tester.addUserData(mx::HW::USER_DATA_BINDING_CONTEXT, mx::GlslResourceBindingContext::create());
+        tester.addUserData(mx::HW::USER_DATA_BINDING_CONTEXT, []() { return mx::GlslResourceBindingContext::create(); });
     }
 
     tester.validate(genOptions, optionsFilePath);
@@ -11,6 +11,8 @@
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/Util.h>
 
+#include <MaterialXGenGlsl/GlslShaderGenerator.h>
+
 namespace mx = MaterialX;
 
 class GlslShaderGeneratorTester : public GenShaderUtil::ShaderGeneratorTester
@@ -30,6 +32,11 @@ class GlslShaderGeneratorTester : public GenShaderUtil::ShaderGeneratorTester
         _testStages.push_back(mx::Stage::PIXEL);
     }
 
+    mx::ShaderGeneratorPtr createShaderGenerator() const override
+    {
+        return mx::GlslShaderGenerator::create();
+    }
+
     // Ignore trying to create shader code for displacementshaders
     void addSkipNodeDefs() override
     {
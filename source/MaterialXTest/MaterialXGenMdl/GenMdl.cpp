@@ -9,6 +9,7 @@
 #include <MaterialXCore/Document.h>
 
 #include <MaterialXFormat/File.h>
+#include <MaterialXFormat/Util.h>
 
 #include <MaterialXGenMdl/MdlShaderGenerator.h>
 #include <MaterialXGenMdl/MdlSyntax.h>
@@ -95,6 +96,27 @@ TEST_CASE("GenShader: MDL Implementation Check", "[genmdl]")
     GenShaderUtil::checkImplementations(context, generatorSkipNodeTypes, generatorSkipNodeDefs, 63);
 }
 
+TEST_CASE("GenShader: MDL Shared Implementation Cache", "[genmdl]")
+{
+    const mx::FilePath currentPath = mx::FilePath::getCurrentPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, mx::FileSearchPath(currentPath), doc);
+    mx::NodePtr node = doc->addNode("image", "image1", "color3");
+    REQUIRE(node);
+
+    // MDL generation bypasses a shared implementation cache, leaving it in place
+    // for other generators that use the context.
+    mx::GenContext context(mx::MdlShaderGenerator::create());
+    context.registerSourceCodeSearchPath(currentPath / mx::FilePath("libraries"));
+    mx::ShaderNodeImplCachePtr sharedCache = mx::ShaderNodeImplCache::create();
+    context.setShaderNodeImplCache(sharedCache);
+    REQUIRE(!context.getShaderGenerator().sharesNodeImplementations());
+    mx::ShaderPtr shader = context.getShaderGenerator().generate(node->getName(), node, context);
+    REQUIRE(shader);
+    REQUIRE(context.getShaderNodeImplCache() == sharedCache);
+    REQUIRE(sharedCache->size() == 0);
+}
+
 /*
 TEST_CASE("GenShader: MDL Unique Names", "[genmdl]")
 {
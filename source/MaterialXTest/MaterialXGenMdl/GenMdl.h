@@ -10,6 +10,8 @@
 
 #include <MaterialXTest/MaterialXGenShader/GenShaderUtil.h>
 
+#include <MaterialXGenMdl/MdlShaderGenerator.h>
+
 namespace mx = MaterialX;
 
 class MdlShaderGeneratorTester : public GenShaderUtil::ShaderGeneratorTester
@@ -28,6 +30,11 @@ class MdlShaderGeneratorTester : public GenShaderUtil::ShaderGeneratorTester
         _testStages.push_back(mx::Stage::PIXEL);
     }
 
+    mx::ShaderGeneratorPtr createShaderGenerator() const override
+    {
+        return mx::MdlShaderGenerator::create();
+    }
+
     // Ignore trying to create shader code for the following nodedefs
     void addSkipNodeDefs() override
     {
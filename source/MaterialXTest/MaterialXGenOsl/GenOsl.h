@@ -29,6 +29,11 @@ class OslShaderGeneratorTester : public GenShaderUtil::ShaderGeneratorTester
         _testStages.push_back(mx::Stage::PIXEL);
     }
 
+    mx::ShaderGeneratorPtr createShaderGenerator() const override
+    {
+        return mx::OslShaderGenerator::create();
+    }
+
     // Ignore trying to create shader code for lightshaders
     void addSkipNodeDefs() override
     {
@@ -12,13 +12,19 @@
 #include <MaterialXFormat/Util.h>
 
 #include <MaterialXGenShader/HwShaderGenerator.h>
+#include <MaterialXGenShader/ShaderStage.h>
 #include <MaterialXGenShader/ShaderTranslator.h>
+#include <MaterialXGenShader/SourceFileCache.h>
 #include <MaterialXGenShader/Util.h>
 
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <vector>
 #include <set>
+#include <thread>
 
 namespace mx = MaterialX;
 
@@ -41,6 +47,27 @@ TEST_CASE("GenShader: Utilities", "[genshader]")
     mx::StringMap subst2 = { {mx::HW::T_ENV_RADIANCE, mx::HW::ENV_RADIANCE} };
     mx::tokenSubstitution(subst2, test2);
     REQUIRE(test2 == result2);
+
+    // Test precompiled substitution, which must match tokenSubstitution
+    mx::TokenSubstitutor substitutor(subst1);
+    std::string test3 = "$monkey$threeheaded $monkeys $ $monkey_ $";
+    std::string result3 = test3;
+    mx::tokenSubstitution(subst1, result3);
+    REQUIRE(substitutor.substitute(test3));
+    REQUIRE(test3 == result3);
+    REQUIRE(test3 == "piratemighty $monkeys $ pirate_ $");
+    std::string test4 = "No tokens here";
+    REQUIRE(!substitutor.substitute(test4));
+    REQUIRE(test4 == "No tokens here");
+
+    // Test substitution from an offset, and recompilation on changes
+    std::string test5 = "$monkey and $monkey";
+    REQUIRE(substitutor.substitute(test5, 1));
+    REQUIRE(test5 == "$monkey and pirate");
+    subst1["$monkey"] = "parrot";
+    substitutor.setSubstitutions(subst1);
+    REQUIRE(substitutor.substitute(test5));
+    REQUIRE(test5 == "parrot and pirate");
 }
 
 TEST_CASE("GenShader: Valid Libraries", "[genshader]")
@@ -217,3 +244,90 @@ TEST_CASE("GenShader: Transparency Regression Check", "[genshader]")
     CHECK(failedTests.empty());
 }
 
+
+TEST_CASE("GenShader: Source File Cache", "[genshader]")
+{
+    auto writeTextFile = [](const mx::FilePath& path, const std::string& content)
+    {
+        std::ofstream file(path.asString(), std::ios::binary);
+        file << content;
+    };
+
+    mx::SourceFileCache& cache = mx::SourceFileCache::get();
+    const mx::FilePath path1 = mx::FilePath::getCurrentPath() / mx::FilePath("source_file_cache_1.glsl");
+    const mx::FilePath path2 = mx::FilePath::getCurrentPath() / mx::FilePath("source_file_cache_2.glsl");
+    writeTextFile(path1, "float a;\n\nfloat b;\n");
+    writeTextFile(path2, "float a;\n\nfloat b;\n");
+
+    // Lines are split as std::getline would split them.
+    mx::SourceFilePtr file1 = cache.getFile(path1);
+    REQUIRE(file1);
+    REQUIRE(file1->getLines().size() == 3);
+    REQUIRE(file1->getLines()[0] == "float a;");
+    REQUIRE(file1->getLines()[1].empty());
+    REQUIRE(file1->getLines()[2] == "float b;");
+
+    // Files are read once, and files with identical contents are shared.
+    REQUIRE(cache.getFile(path1) == file1);
+    REQUIRE(cache.getFile(path2) == file1);
+
+    // Explicit invalidation reads the file again.
+    cache.invalidate(path1);
+    mx::SourceFilePtr reread = cache.getFile(path1);
+    REQUIRE(reread);
+    REQUIRE(reread->getContent() == file1->getContent());
+
+    // Modified files are read again.
+    const uint64_t modificationTime = path1.getModificationTime();
+    for (int i = 0; i < 200 && path1.getModificationTime() == modificationTime; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        writeTextFile(path1, "float c;");
+    }
+    mx::SourceFilePtr modified = cache.getFile(path1);
+    REQUIRE(modified);
+    REQUIRE(modified->getLines() == mx::StringVec{ "float c;" });
+    REQUIRE(cache.getFile(path2) == file1);
+
+    // Missing files are reported and removed from the cache.
+    std::remove(path1.asString().c_str());
+    REQUIRE(!cache.getFile(path1));
+    std::remove(path2.asString().c_str());
+    cache.invalidate(path2);
+}
+
+TEST_CASE("GenShader: Source Code Buffer", "[genshader]")
+{
+    const std::string content = std::string(300, 'a') + "\n" + std::string(100, 'b') + "\n";
+    mx::SourceFilePtr file = std::make_shared<mx::SourceFile>(content);
+    REQUIRE(file->getLines().size() == 2);
+    REQUIRE(file->getLineOffset(1) == 301);
+
+    // Appended text and referenced fragments are joined in order.
+    mx::SourceCodeBuffer buffer;
+    std::string expected;
+    for (int i = 0; i < 2000; i++)
+    {
+        const std::string line = "float v" + std::to_string(i) + " = 0.0;\n";
+        buffer.append(line);
+        expected += line;
+        if (i % 100 == 0)
+        {
+            buffer.append(content.data(), content.size(), file);
+            expected += content;
+            buffer.append(content.data() + 301, 101, file);
+            expected += content.substr(301);
+        }
+    }
+    REQUIRE(buffer.size() == expected.size());
+    REQUIRE(buffer.str() == expected);
+
+    // Appending after the code has been joined continues the same string.
+    buffer.append(content.data(), content.size(), file);
+    expected += content;
+    REQUIRE(buffer.str() == expected);
+
+    buffer.assign("replaced");
+    REQUIRE(buffer.size() == 8);
+    REQUIRE(buffer.str() == "replaced");
+}
@@ -16,6 +16,7 @@
 #include <MaterialXGenShader/Util.h>
 #include <MaterialXGenShader/TypeDesc.h>
 
+#include <algorithm>
 #include <iostream>
 
 namespace mx = MaterialX;
@@ -329,9 +330,43 @@ void testUniqueNames(mx::GenContext& context, const std::string& stage)
     REQUIRE(sgNode1->getOutput()->getVariable() == "unique_names_out");
 }
 
+void printGenProfile(const mx::GenProfiler& profiler, std::ostream& output, size_t maxImplementations)
+{
+    using TimingPair = std::pair<std::string, mx::GenTiming>;
+    auto sortTimings = [](const mx::GenTimingMap& timings)
+    {
+        std::vector<TimingPair> sorted(timings.begin(), timings.end());
+        std::sort(sorted.begin(), sorted.end(), [](const TimingPair& a, const TimingPair& b)
+        {
+            return a.second.seconds > b.second.seconds;
+        });
+        return sorted;
+    };
+
+    output << "Generation phases:" << std::endl;
+    for (const TimingPair& pair : sortTimings(profiler.getPhaseTimings()))
+    {
+        output << "\t" << pair.first << ": " << pair.second.seconds << " seconds (" << pair.second.count << " calls)" << std::endl;
+    }
+    std::vector<TimingPair> implementations = sortTimings(profiler.getImplementationTimings());
+    if (implementations.size() > maxImplementations)
+    {
+        implementations.resize(maxImplementations);
+    }
+    output << "Slowest implementations:" << std::endl;
+    for (const TimingPair& pair : implementations)
+    {
+        output << "\t" << pair.first << ": " << pair.second.seconds << " seconds (" << pair.second.count << " calls)" << std::endl;
+    }
+    output << "Generation counters:" << std::endl;
+    for (const auto& pair : profiler.getCounters())
+    {
+        output << "\t" << pair.first << ": " << pair.second << std::endl;
+    }
+}
+
 
 void ShaderGeneratorTester::checkImplementationUsage(const mx::StringSet& usedImpls,
-                                                     const mx::GenContext& context,
                                                      std::ostream& stream)
 {
     // Get list of implementations for a given target.
@@ -378,12 +413,6 @@ void ShaderGeneratorTester::checkImplementationUsage(const mx::StringSet& usedIm
             implementationUseCount++;
             continue;
         }
-
-        if (context.findNodeImplementation(implName))
-        {
-            implementationUseCount++;
-            continue;
-        }
         missedImplementations.push_back(implName);
     }
 
@@ -408,21 +437,15 @@ void ShaderGeneratorTester::checkImplementationUsage(const mx::StringSet& usedIm
     }
 }
 
-bool ShaderGeneratorTester::generateCode(mx::GenContext& context, const std::string& shaderName, mx::TypedElementPtr element,
-                                         std::ostream& log, mx::StringVec testStages, mx::StringVec& sourceCode)
+bool ShaderGeneratorTester::checkGeneratedCode(const mx::BatchShaderResult& result, mx::TypedElementPtr element,
+                                               std::ostream& log, const mx::StringVec& testStages, mx::StringVec& sourceCode)
 {
-    mx::ShaderPtr shader = nullptr;
-    try
+    if (!result.error.empty())
     {
-        shader = context.getShaderGenerator().generate(shaderName, element, context);
+        log << ">> Code generation failure: " << result.error << "\n";
     }
-    catch (mx::Exception& e)
-    {
-        log << ">> Code generation failure: " << e.what() << "\n";
-        shader = nullptr;
-    }
-    CHECK(shader);
-    if (!shader)
+    CHECK(result.shader);
+    if (!result.shader)
     {
         log << ">> Failed to generate shader for element: " << element->getNamePath() << std::endl;
         return false;
@@ -431,7 +454,7 @@ bool ShaderGeneratorTester::generateCode(mx::GenContext& context, const std::str
     bool stageFailed = false;
     for (const auto& stage : testStages)
     {
-        const std::string& code = shader->getSourceCode(stage);
+        const std::string& code = result.shader->getSourceCode(stage);
         sourceCode.push_back(code);
         bool noSource = code.empty();
         CHECK(!noSource);
@@ -633,18 +656,33 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
     // Add nodedefs to skip when testing
     addSkipNodeDefs();
 
-    // Create our context
-    mx::GenContext context(_shaderGenerator);
-    context.getOptions() = generateOptions;
-    context.registerSourceCodeSearchPath(_srcSearchPath);
+    // Profile generation across all worker contexts.
+    mx::GenProfilerPtr profiler = mx::GenProfiler::create();
 
-    // Register shader metadata defined in the libraries.
-    _shaderGenerator->registerShaderMetadata(_dependLib, context);
+    // Create the batch generator, with per-thread generators matching the
+    // generator under test.
+    mx::BatchShaderGenerator batchGenerator([this]()
+    {
+        mx::ShaderGeneratorPtr generator = createShaderGenerator();
+        if (!generator)
+        {
+            return _shaderGenerator;
+        }
+        generator->setColorManagementSystem(_colorManagementSystem);
+        generator->setUnitSystem(_unitSystem);
+        return generator;
+    });
+    if (!createShaderGenerator())
+    {
+        batchGenerator.setThreadCount(1);
+    }
+    batchGenerator.getOptions() = generateOptions;
+    batchGenerator.registerSourceCodeSearchPath(_srcSearchPath);
 
     // Define working unit if required
-    if (context.getOptions().targetDistanceUnit.empty())
+    if (batchGenerator.getOptions().targetDistanceUnit.empty())
     {
-        context.getOptions().targetDistanceUnit = _defaultDistanceUnit;
+        batchGenerator.getOptions().targetDistanceUnit = _defaultDistanceUnit;
     }
 
     // Check if a binding context has been set.
@@ -660,14 +698,7 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
         // For each new file clear the implementation cache.
         // Since the new file might contain implementations with names
         // colliding with implementations in previous test cases.
-        context.clearNodeImplementations();
-
-        // Set user data
-        context.clearUserData();
-        for (auto it : _userData)
-        {
-            context.pushUserData(it.first, it.second);
-        }
+        batchGenerator.clearNodeImplementations();
 
         // Add in dependent libraries
         bool importedLibrary = false;
@@ -685,9 +716,18 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
             continue;
         }
 
-        // Find and register lights
+        // Find lights, and register them along with user data
+        // in each generation context.
         findLights(doc, _lights);
-        registerLights(doc, _lights, context);
+        batchGenerator.setContextSetup([this, &doc, profiler](mx::GenContext& context)
+        {
+            context.setProfiler(profiler);
+            for (auto it : _userData)
+            {
+                context.pushUserData(it.first, it.second());
+            }
+            registerLights(doc, _lights, context);
+        });
 
         // Find elements to render in the document
         std::vector<mx::TypedElementPtr> elements;
@@ -718,10 +758,14 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
         }
         CHECK(docValid);
 
-        // Traverse the renderable elements and run the validation step
+        // Traverse the renderable elements and find those to validate
         int missingNodeDefs = 0;
         int missingImplementations = 0;
         int codeGenerationFailures = 0;
+        std::vector<mx::TypedElementPtr> sourceElements;
+        std::vector<mx::TypedElementPtr> targetElements;
+        std::vector<mx::InterfaceElementPtr> targetImpls;
+        mx::StringVec targetNames;
         for (const auto& element : elements)
         {
             mx::TypedElementPtr targetElement = element;
@@ -767,78 +811,10 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
                 mx::InterfaceElementPtr impl = nodeDef->getImplementation(_shaderGenerator->getTarget());
                 if (impl)
                 {
-                    _logFile << "------------ Run validation with element: " << namePath << "------------" << std::endl;
-
-                    mx::StringVec sourceCode;
-                    bool generatedCode = generateCode(context, elementName, targetElement, _logFile, _testStages, sourceCode);
-
-                    // Record implementations tested
-                    if (options.checkImplCount)
-                    {
-                        context.getNodeImplementationNames(_usedImplementations);
-                        mx::NodeGraphPtr nodeGraph = impl->asA<mx::NodeGraph>();
-                        mx::InterfaceElementPtr nodeGraphImpl = nodeGraph ? nodeGraph->getImplementation() : nullptr;
-                        _usedImplementations.insert(nodeGraphImpl ? nodeGraphImpl->getName() : impl->getName());
-                    }
-
-                    if (!generatedCode)
-                    {
-                        _logFile << ">> Failed to generate code for nodedef: " << nodeDefName << std::endl;
-                        codeGenerationFailures++;
-                    }
-                    else if (_writeShadersToDisk && sourceCode.size())
-                    {
-                        const std::string elementNameSuffix(bindingContextUsed ? LAYOUT_SUFFIX : mx::EMPTY_STRING);
-
-                        mx::FilePath path = element->getActiveSourceUri();
-                        if (!path.isEmpty())
-                        {
-                            std::string testFileName = path[path.size() - 1];
-                            size_t pos = testFileName.rfind('.');
-                            if (pos != std::string::npos)
-                                testFileName = testFileName.substr(0, pos);
-
-                            path = path.getParentPath() / testFileName;
-                            if (!path.exists())
-                            {
-                                path.createDirectory();
-                            }
-                        }
-                        else
-                        {
-                            path = mx::FilePath::getCurrentPath();
-                        }
-
-                        std::vector<mx::FilePath> sourceCodePaths;
-                        if (sourceCode.size() > 1)
-                        {
-                            for (size_t i=0; i<sourceCode.size(); ++i)
-                            {
-                                const mx::FilePath filename = path / (elementName + elementNameSuffix + "." + _testStages[i] + "." + getFileExtensionForTarget(_shaderGenerator->getTarget()));
-                                sourceCodePaths.push_back(filename);
-                                std::ofstream file(filename.asString());
-                                _logFile << "Write source code: " << filename.asString() << std::endl;
-                                file << sourceCode[i];
-                                file.close();
-                            }
-                        }
-                        else
-                        {
-                            path = path / (elementName + "."  
-                                + _shaderGenerator->getTarget() 
-                                + "." + getFileExtensionForTarget(_shaderGenerator->getTarget())
-                                );
-                            sourceCodePaths.push_back(path);
-                            std::ofstream file(path.asString());
-                            _logFile << "Write source code: " << path.asString() << std::endl;
-                            std::cout << "Write source code: " << path.asString() << std::endl;
-                            file << sourceCode[0];
-                            file.close();
-                        }
-
-                        // Run compile test
-                        compileSource(sourceCodePaths);
-                    }
+                    sourceElements.push_back(element);
+                    targetElements.push_back(targetElement);
+                    targetImpls.push_back(impl);
+                    targetNames.push_back(elementName);
                 }
                 else
                 {
@@ -853,6 +829,94 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
             }
         }
 
+        // Generate code for all elements in parallel.
+        mx::BatchShaderResultVec results = batchGenerator.generate(doc, targetElements, targetNames);
+
+        // Record implementations tested
+        if (options.checkImplCount)
+        {
+            batchGenerator.getNodeImplementationNames(_usedImplementations);
+            for (const auto& impl : targetImpls)
+            {
+                mx::NodeGraphPtr nodeGraph = impl->asA<mx::NodeGraph>();
+                mx::InterfaceElementPtr nodeGraphImpl = nodeGraph ? nodeGraph->getImplementation() : nullptr;
+                _usedImplementations.insert(nodeGraphImpl ? nodeGraphImpl->getName() : impl->getName());
+            }
+        }
+
+        // Check the results and run the validation step
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const mx::TypedElementPtr& element = sourceElements[i];
+            const mx::TypedElementPtr& targetElement = targetElements[i];
+            const std::string& elementName = targetNames[i];
+
+            _logFile << "------------ Run validation with element: " << targetElement->getNamePath() << "------------" << std::endl;
+
+            mx::StringVec sourceCode;
+            bool generatedCode = checkGeneratedCode(results[i], targetElement, _logFile, _testStages, sourceCode);
+            if (!generatedCode)
+            {
+                mx::NodePtr targetNode = targetElement->asA<mx::Node>();
+                mx::NodeDefPtr nodeDef = targetNode ? targetNode->getNodeDef() : nullptr;
+                _logFile << ">> Failed to generate code for nodedef: " << (nodeDef ? nodeDef->getName() : targetElement->getNamePath()) << std::endl;
+                codeGenerationFailures++;
+            }
+            else if (_writeShadersToDisk && sourceCode.size())
+            {
+                const std::string elementNameSuffix(bindingContextUsed ? LAYOUT_SUFFIX : mx::EMPTY_STRING);
+
+                mx::FilePath path = element->getActiveSourceUri();
+                if (!path.isEmpty())
+                {
+                    std::string testFileName = path[path.size() - 1];
+                    size_t pos = testFileName.rfind('.');
+                    if (pos != std::string::npos)
+                        testFileName = testFileName.substr(0, pos);
+
+                    path = path.getParentPath() / testFileName;
+                    if (!path.exists())
+                    {
+                        path.createDirectory();
+                    }
+                }
+                else
+                {
+                    path = mx::FilePath::getCurrentPath();
+                }
+
+                std::vector<mx::FilePath> sourceCodePaths;
+                if (sourceCode.size() > 1)
+                {
+                    for (size_t j=0; j<sourceCode.size(); ++j)
+                    {
+                        const mx::FilePath filename = path / (elementName + elementNameSuffix + "." + _testStages[j] + "." + getFileExtensionForTarget(_shaderGenerator->getTarget()));
+                        sourceCodePaths.push_back(filename);
+                        std::ofstream file(filename.asString());
+                        _logFile << "Write source code: " << filename.asString() << std::endl;
+                        file << sourceCode[j];
+                        file.close();
+                    }
+                }
+                else
+                {
+                    path = path / (elementName + "."  
+                        + _shaderGenerator->getTarget() 
+                        + "." + getFileExtensionForTarget(_shaderGenerator->getTarget())
+                        );
+                    sourceCodePaths.push_back(path);
+                    std::ofstream file(path.asString());
+                    _logFile << "Write source code: " << path.asString() << std::endl;
+                    std::cout << "Write source code: " << path.asString() << std::endl;
+                    file << sourceCode[0];
+                    file.close();
+                }
+
+                // Run compile test
+                compileSource(sourceCodePaths);
+            }
+        }
+
         CHECK(missingNodeDefs == 0);
         CHECK(missingImplementations == 0);
         CHECK(codeGenerationFailures == 0);
@@ -861,9 +925,17 @@ void ShaderGeneratorTester::validate(const mx::GenOptions& generateOptions, cons
     if (options.checkImplCount)
     {
         _logFile << "---------------------------------------------------" << std::endl;
-        checkImplementationUsage(_usedImplementations, context, _logFile);
+        checkImplementationUsage(_usedImplementations, _logFile);
     }
 
+    // Report the generation profile, and write it out for inspection.
+    _logFile << "---------------------------------------------------" << std::endl;
+    printGenProfile(*profiler, _logFile);
+    const std::string logPath = _logFilePath.asString();
+    std::ofstream profileFile(logPath.substr(0, logPath.rfind('.')) + "_profile.json");
+    profileFile << profiler->toJson();
+    CHECK(profiler->getCounter(mx::GenProfiler::NODES_AFTER_OPTIMIZATION) <= profiler->getCounter(mx::GenProfiler::NODES_BEFORE_OPTIMIZATION));
+
     // End logging
     if (_logFile.is_open())
     {
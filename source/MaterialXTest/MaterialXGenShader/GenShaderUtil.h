@@ -11,6 +11,7 @@
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <MaterialXGenShader/BatchShaderGenerator.h>
 #include <MaterialXGenShader/DefaultColorManagementSystem.h>
 #include <MaterialXGenShader/HwShaderGenerator.h>
 #include <MaterialXGenShader/TypeDesc.h>
@@ -19,6 +20,7 @@
 
 #include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
 
 namespace mx = MaterialX;
@@ -52,6 +54,9 @@ void checkImplementations(mx::GenContext& context,
 // Utility test to  check unique name generation on a shader generator
 void testUniqueNames(mx::GenContext& context, const std::string& stage);
 
+// Print the phase timings, the slowest implementations and the counters of a profiler
+void printGenProfile(const mx::GenProfiler& profiler, std::ostream& output, size_t maxImplementations = 10);
+
 //
 // Render validation options. Reflects the _options.mtlx
 // file in the test suite area.
@@ -199,10 +204,10 @@ class ShaderGeneratorTester
     // Add unit system
     virtual void addUnitSystem();
 
-    // Add user data 
-    void addUserData(const std::string& name, mx::GenUserDataPtr data)
+    // Add user data, created for each generation context by the given function
+    void addUserData(const std::string& name, std::function<mx::GenUserDataPtr()> factory)
     {
-        _userData[name] = data;
+        _userData[name] = factory;
     }
 
     // Load in dependent libraries
@@ -219,9 +224,9 @@ class ShaderGeneratorTester
     // Register light node definitions and light count with a given generation context
     virtual void registerLights(mx::DocumentPtr doc, const std::vector<mx::NodePtr>& lights, mx::GenContext& context);
 
-    // Generate source code for a given element and check that code was produced.
-    virtual bool generateCode(mx::GenContext& context, const std::string& shaderName, mx::TypedElementPtr element,
-                              std::ostream& log, mx::StringVec testStages, mx::StringVec& sourceCode);
+    // Check that a shader was generated for a given element with source code for each test stage.
+    virtual bool checkGeneratedCode(const mx::BatchShaderResult& result, mx::TypedElementPtr element,
+                                    std::ostream& log, const mx::StringVec& testStages, mx::StringVec& sourceCode);
 
     // Run test for source code generation
     void validate(const mx::GenOptions& generateOptions, const std::string& optionsFilePath);
@@ -230,10 +235,17 @@ class ShaderGeneratorTester
     virtual void compileSource(const std::vector<mx::FilePath>& /*sourceCodePaths*/) {};
 
   protected:
+    // Create a shader generator for a worker thread, matching the generator
+    // under test.  The default implementation returns nullptr, in which case
+    // the generator under test is used on a single thread.
+    virtual mx::ShaderGeneratorPtr createShaderGenerator() const
+    {
+        return nullptr;
+    }
+
     // Check to see that all implementations have been tested for a given
     // language.
     void checkImplementationUsage(const mx::StringSet& usedImpls,
-                                  const mx::GenContext& context,
                                   std::ostream& stream);
 
     // Get implementation "whitelist" for those implementations that have
@@ -267,7 +279,7 @@ class ShaderGeneratorTester
     std::vector<mx::NodePtr> _lights;
     std::unordered_map<std::string, unsigned int> _lightIdentifierMap;
 
-    std::unordered_map<std::string, mx::GenUserDataPtr> _userData;
+    std::unordered_map<std::string, std::function<mx::GenUserDataPtr()>> _userData;
     mx::StringSet _usedImplementations;
 };
 
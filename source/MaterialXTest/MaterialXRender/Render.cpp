@@ -6,11 +6,15 @@
 #include <MaterialXTest/Catch/catch.hpp>
 #include <MaterialXTest/MaterialXRender/RenderUtil.h>
 
+#include <MaterialXRender/EnvironmentPrefilter.h>
+#include <MaterialXRender/Harmonics.h>
 #include <MaterialXRender/ShaderRenderer.h>
 #include <MaterialXRender/StbImageLoader.h>
 #include <MaterialXRender/TinyObjLoader.h>
 #include <MaterialXRender/Types.h>
 
+#include <MaterialXGenShader/Nodes/ConvolutionNode.h>
+
 #ifdef MATERIALX_BUILD_OIIO
 #include <MaterialXRender/OiioImageLoader.h>
 #endif
@@ -18,7 +22,12 @@
 #include <MaterialXContrib/Handlers/TinyEXRImageLoader.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <unordered_set>
@@ -223,3 +232,450 @@ TEST_CASE("Render: Image Handler Load", "[rendercore]")
     CHECK(imagesLoaded);
     imageHandlerLog.close();
 }
+
+TEST_CASE("Render: Image Cache", "[rendercore]")
+{
+    mx::ImageHandlerPtr imageHandler = mx::ImageHandler::create(mx::StbImageLoader::create());
+    imageHandler->setSearchPath(mx::FileSearchPath(mx::FilePath::getCurrentPath() / "resources/Images"));
+    REQUIRE(imageHandler->getImageCacheBudget() == 0);
+
+    // Acquire images without a budget.
+    mx::ImagePtr cloth = imageHandler->acquireImage("cloth.png");
+    mx::ImagePtr grid = imageHandler->acquireImage("grid.png");
+    REQUIRE(cloth);
+    REQUIRE(grid);
+    const size_t clothSize = (size_t) cloth->getRowStride() * cloth->getHeight();
+    const size_t gridSize = (size_t) grid->getRowStride() * grid->getHeight();
+    REQUIRE(imageHandler->acquireImage("cloth.png") == cloth);
+    REQUIRE(imageHandler->getImageCacheCount() == 2);
+    REQUIRE(imageHandler->getImageCacheSize() == clothSize + gridSize);
+    REQUIRE(imageHandler->getImageCacheHitCount() == 1);
+    REQUIRE(imageHandler->getImageCacheMissCount() == 2);
+
+    // Images are cached by the file found on the search path, so relative
+    // and absolute paths to a file share an entry.
+    const mx::FilePath imagePath = mx::FilePath::getCurrentPath() / "resources/Images";
+    REQUIRE(imageHandler->acquireImage(imagePath / "cloth.png") == cloth);
+    REQUIRE(imageHandler->getImageCacheCount() == 2);
+    REQUIRE(imageHandler->getImageCacheHitCount() == 2);
+    REQUIRE(imageHandler->getImageCacheMissCount() == 2);
+
+    // Missing images are cached as the invalid image, without counting
+    // towards the size of the cache.
+    REQUIRE(imageHandler->acquireImage("missing.png") == imageHandler->getInvalidImage());
+    REQUIRE(imageHandler->acquireImage("missing.png") == imageHandler->getInvalidImage());
+    REQUIRE(imageHandler->getImageCacheSize() == clothSize + gridSize);
+
+    // Acquiring an image beyond the budget evicts the least recently used image.
+    imageHandler->setImageCacheBudget(clothSize + gridSize);
+    REQUIRE(imageHandler->getImageCacheEvictionCount() == 0);
+    mx::ImagePtr heightmap = imageHandler->acquireImage("plain_heightmap.png");
+    REQUIRE(heightmap);
+    const size_t heightmapSize = (size_t) heightmap->getRowStride() * heightmap->getHeight();
+    REQUIRE(imageHandler->getImageCacheEvictionCount() == 1);
+    REQUIRE(imageHandler->getImageCacheSize() == clothSize + heightmapSize);
+    REQUIRE(imageHandler->getImageCacheSize() <= imageHandler->getImageCacheBudget());
+    REQUIRE(imageHandler->acquireImage("cloth.png") == cloth);
+    REQUIRE(imageHandler->acquireImage("grid.png") != grid);
+    REQUIRE(imageHandler->getImageCacheEvictionCount() == 2);
+
+    // Pinned images are retained beyond the budget.
+    imageHandler->pinImage(cloth);
+    imageHandler->pinImage(cloth);
+    REQUIRE(imageHandler->getPinCount(cloth) == 2);
+    imageHandler->acquireImage("plain_heightmap.png");
+    REQUIRE(imageHandler->getImageCacheEvictionCount() == 3);
+    REQUIRE(imageHandler->acquireImage("cloth.png") == cloth);
+    imageHandler->unpinImage(cloth);
+    imageHandler->unpinImage(cloth);
+    REQUIRE(imageHandler->getPinCount(cloth) == 0);
+    imageHandler->setImageCacheBudget(clothSize);
+    REQUIRE(imageHandler->getImageCacheSize() == clothSize);
+    REQUIRE(imageHandler->getImageCacheEvictionCount() == 4);
+    imageHandler->acquireImage("plain_heightmap.png");
+    REQUIRE(imageHandler->getImageCacheSize() == heightmapSize);
+    REQUIRE(imageHandler->acquireImage("cloth.png") != cloth);
+
+    // Clearing the cache resets its statistics.
+    imageHandler->clearImageCache();
+    REQUIRE(imageHandler->getImageCacheCount() == 0);
+    REQUIRE(imageHandler->getImageCacheSize() == 0);
+    REQUIRE(imageHandler->getImageCacheHitCount() == 0);
+    REQUIRE(imageHandler->getImageCacheMissCount() == 0);
+    REQUIRE(imageHandler->getImageCacheEvictionCount() == 0);
+
+    // Relative paths are found again after the search path changes.
+    imageHandler->setImageCacheBudget(0);
+    mx::ImagePtr normal = imageHandler->acquireImage("mesh_wire_norm.png");
+    REQUIRE(normal);
+    imageHandler->setSearchPath(mx::FileSearchPath(mx::FilePath::getCurrentPath() /
+                                "resources/Materials/TestSuite/libraries/metal/textures"));
+    mx::ImagePtr otherNormal = imageHandler->acquireImage("mesh_wire_norm.png");
+    REQUIRE(otherNormal);
+    REQUIRE(otherNormal != normal);
+    REQUIRE(imageHandler->getImageCacheCount() == 2);
+}
+
+namespace
+{
+
+// Reference implementation of a separable filter, using texel accessors.
+mx::Color4 filterTexel(mx::ImagePtr image, unsigned int x, unsigned int y, const std::vector<float>& weights)
+{
+    const int radius = (int) weights.size() / 2;
+    mx::Color4 result(0.0f);
+    for (int j = -radius; j <= radius; j++)
+    {
+        for (int i = -radius; i <= radius; i++)
+        {
+            int sx = std::min(std::max((int) x + i, 0), (int) image->getWidth() - 1);
+            int sy = std::min(std::max((int) y + j, 0), (int) image->getHeight() - 1);
+            result += image->getTexelColor(sx, sy) * weights[i + radius] * weights[j + radius];
+        }
+    }
+    return result;
+}
+
+bool compareColors(const mx::Color4& color1, const mx::Color4& color2, float tolerance)
+{
+    for (size_t c = 0; c < 4; c++)
+    {
+        if (std::abs(color1[c] - color2[c]) > tolerance)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void benchmarkKernel(const std::string& name, const std::function<void()>& kernel)
+{
+    auto start = std::chrono::steady_clock::now();
+    kernel();
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    std::cout << "    " << name << ": " << duration.count() << " seconds" << std::endl;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Render: Image Kernels", "[rendercore]")
+{
+    const std::vector<mx::Image::BaseType> baseTypes =
+    {
+        mx::Image::BaseType::UINT8,
+        mx::Image::BaseType::UINT16,
+        mx::Image::BaseType::HALF,
+        mx::Image::BaseType::FLOAT
+    };
+    const std::vector<float> tolerances = { 1.0f / 255.0f, 1.0e-4f, 2.0e-3f, 1.0e-5f };
+    const std::vector<float> filterWeights = { 0.1f, 0.15f, 0.2f, 0.1f, 0.2f, 0.15f, 0.1f, 0.0f, 0.0f };
+    const unsigned int width = 37;
+    const unsigned int height = 23;
+
+    for (size_t typeIndex = 0; typeIndex < baseTypes.size(); typeIndex++)
+    {
+        const float tolerance = tolerances[typeIndex];
+        for (unsigned int channelCount = 1; channelCount <= 4; channelCount++)
+        {
+            mx::ImagePtr image = mx::Image::create(width, height, channelCount, baseTypes[typeIndex]);
+            image->createResourceBuffer();
+
+            // Uniform colors
+            mx::Color4 uniformColor;
+            image->setUniformColor(mx::Color4(0.25f, 0.5f, 0.75f, 1.0f));
+            REQUIRE(image->isUniformColor(&uniformColor));
+            REQUIRE(compareColors(uniformColor, image->getTexelColor(width - 1, height - 1), 0.0f));
+            image->setTexelColor(width - 1, height - 1, mx::Color4(0.0f));
+            REQUIRE(!image->isUniformColor());
+
+            // Fill the image with a deterministic pattern.
+            for (unsigned int y = 0; y < height; y++)
+            {
+                for (unsigned int x = 0; x < width; x++)
+                {
+                    mx::Color4 color;
+                    for (size_t c = 0; c < 4; c++)
+                    {
+                        color[c] = (float) ((x * 7 + y * 13 + c * 29) % 61) / 60.0f;
+                    }
+                    image->setTexelColor(x, y, color);
+                }
+            }
+            REQUIRE(!image->isUniformColor());
+
+            // Average color
+            mx::Color4 averageColor(0.0f);
+            for (unsigned int y = 0; y < height; y++)
+            {
+                for (unsigned int x = 0; x < width; x++)
+                {
+                    averageColor += image->getTexelColor(x, y);
+                }
+            }
+            averageColor /= (float) (width * height);
+            REQUIRE(compareColors(image->getAverageColor(), averageColor, 1.0e-5f));
+
+            // Filters
+            std::vector<std::pair<mx::ImagePtr, std::vector<float>>> filters =
+            {
+                { image->applyBoxBlur(), { 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f } },
+                { image->applyGaussianBlur(), std::vector<float>(mx::GAUSSIAN_KERNEL_7.begin(), mx::GAUSSIAN_KERNEL_7.end()) },
+                { image->applySeparableFilter(filterWeights), filterWeights }
+            };
+            for (const auto& filter : filters)
+            {
+                for (unsigned int y = 0; y < height; y++)
+                {
+                    for (unsigned int x = 0; x < width; x++)
+                    {
+                        mx::Color4 expected = filterTexel(image, x, y, filter.second);
+                        if (channelCount < 4)
+                        {
+                            expected[3] = 1.0f;
+                        }
+                        REQUIRE(compareColors(filter.first->getTexelColor(x, y), expected, tolerance));
+                    }
+                }
+            }
+            REQUIRE_THROWS_AS(image->applySeparableFilter({ 0.5f, 0.5f }), mx::Exception&);
+
+            // Luminance split
+            const float luminance = 0.4f;
+            mx::ImagePair split = image->splitByLuminance(luminance);
+            for (unsigned int y = 0; y < height; y++)
+            {
+                for (unsigned int x = 0; x < width; x++)
+                {
+                    mx::Color4 color = image->getTexelColor(x, y);
+                    mx::Color4 underflow = split.first->getTexelColor(x, y);
+                    mx::Color4 overflow = split.second->getTexelColor(x, y);
+                    for (size_t c = 0; c < 3; c++)
+                    {
+                        REQUIRE(std::abs(underflow[c] - std::min(color[c], luminance)) <= tolerance);
+                        REQUIRE(std::abs(overflow[c] - std::max(color[c] - luminance, 0.0f)) <= tolerance);
+                    }
+                    REQUIRE(underflow[3] == 1.0f);
+                    REQUIRE(overflow[3] == 1.0f);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Render: Image Kernel Performance", "[.][benchmark]")
+{
+    std::cout << "Image kernel timings:" << std::endl;
+    for (unsigned int width = 1024; width <= 8192; width *= 2)
+    {
+        mx::ImagePtr image = mx::Image::create(width, width / 2, 3, mx::Image::BaseType::HALF);
+        image->createResourceBuffer();
+        image->setUniformColor(mx::Color4(0.5f, 1.5f, 2.5f, 1.0f));
+        image->setTexelColor(width - 1, width / 2 - 1, mx::Color4(0.0f));
+
+        std::cout << "  " << width << "x" << width / 2 << ":" << std::endl;
+        mx::Color4 averageColor;
+        benchmarkKernel("getAverageColor", [&]() { averageColor = image->getAverageColor(); });
+        bool uniform = true;
+        benchmarkKernel("isUniformColor", [&]() { uniform = image->isUniformColor(); });
+        benchmarkKernel("applyBoxBlur", [&]() { image->applyBoxBlur(); });
+        benchmarkKernel("applyGaussianBlur", [&]() { image->applyGaussianBlur(); });
+        benchmarkKernel("splitByLuminance", [&]() { image->splitByLuminance(1.0f); });
+
+        REQUIRE(!uniform);
+        REQUIRE(averageColor[1] == Approx(1.5f).epsilon(0.001));
+    }
+}
+
+TEST_CASE("Render: Spherical Harmonics", "[rendercore]")
+{
+    // Render a band-limited signal, and verify its projection.
+    mx::Sh3ColorCoeffs shSignal;
+    shSignal[0] = mx::Color3d(2.0, 1.5, 1.0);
+    shSignal[1] = mx::Color3d(0.4, 0.2, 0.1);
+    shSignal[3] = mx::Color3d(-0.3, 0.1, 0.2);
+    shSignal[5] = mx::Color3d(0.1, -0.1, 0.05);
+    shSignal[8] = mx::Color3d(0.05, 0.1, -0.1);
+    mx::ImagePtr env = mx::renderEnvironment(shSignal, 512, 256);
+    mx::Sh3ColorCoeffs shEnv = mx::projectEnvironment(env);
+    for (size_t i = 0; i < shEnv.NUM_COEFFS; i++)
+    {
+        for (size_t c = 0; c < 3; c++)
+        {
+            REQUIRE(std::abs(shEnv[i][c] - shSignal[i][c]) < 1.0e-3);
+        }
+    }
+
+    // Row blocks are visited once each for any thread count.
+    for (unsigned int threadCount = 1; threadCount <= 4; threadCount++)
+    {
+        std::vector<size_t> rowBlocks(env->getHeight(), 0);
+        mx::forEachImageRowBlock(env->getWidth(), env->getHeight(), 7, [&](size_t block, unsigned int begin, unsigned int end)
+        {
+            for (unsigned int y = begin; y < end; y++)
+            {
+                rowBlocks[y] += block + 1;
+            }
+        }, threadCount);
+        for (unsigned int y = 0; y < env->getHeight(); y++)
+        {
+            REQUIRE(rowBlocks[y] == y / 7 + 1);
+        }
+    }
+
+    // Cached projections
+    mx::ShProjectionCachePtr cache = mx::ShProjectionCache::create();
+    REQUIRE(cache->projectEnvironment(env) == shEnv);
+    REQUIRE(cache->projectEnvironment(env, true) == mx::projectEnvironment(env, true));
+    REQUIRE(cache->getMissCount() == 1);
+    REQUIRE(cache->getHitCount() == 1);
+
+    mx::Vector3 lightDir, cachedLightDir;
+    mx::Color3 lightColor, cachedLightColor;
+    mx::computeDominantLight(env, lightDir, lightColor);
+    cache->computeDominantLight(env, cachedLightDir, cachedLightColor);
+    REQUIRE(lightDir == cachedLightDir);
+    REQUIRE(lightColor == cachedLightColor);
+    REQUIRE(cache->getHitCount() == 2);
+
+    mx::ImagePtr envCopy = mx::Image::create(env->getWidth(), env->getHeight(), env->getChannelCount(), env->getBaseType());
+    envCopy->createResourceBuffer();
+    std::memcpy(envCopy->getResourceBuffer(), env->getResourceBuffer(), env->getRowStride() * env->getHeight());
+    REQUIRE(cache->projectEnvironment(envCopy) == shEnv);
+    REQUIRE(cache->getHitCount() == 3);
+    envCopy->setTexelColor(17, 33, mx::Color4(4.0f, 0.0f, 0.0f, 1.0f));
+    REQUIRE(cache->projectEnvironment(envCopy) != shEnv);
+    REQUIRE(cache->getMissCount() == 2);
+    cache->clear();
+    REQUIRE(cache->getMissCount() == 0);
+
+    // Normalization is stable under repetition.
+    const float envRadiance = 2.0f;
+    mx::ImagePtr normEnv = mx::normalizeEnvironment(env, envRadiance, 3.0f);
+    mx::ImagePtr renormEnv = mx::normalizeEnvironment(normEnv, envRadiance, 3.0f);
+    for (unsigned int y = 0; y < env->getHeight(); y += 15)
+    {
+        for (unsigned int x = 0; x < env->getWidth(); x += 15)
+        {
+            mx::Color4 color = normEnv->getTexelColor(x, y);
+            mx::Color4 renormColor = renormEnv->getTexelColor(x, y);
+            for (size_t c = 0; c < 3; c++)
+            {
+                REQUIRE(renormColor[c] == Approx(color[c]).epsilon(1.0e-4));
+            }
+        }
+    }
+}
+
+namespace
+{
+
+// Return the direction of a texel in the lat-long projection of hardware shaders.
+mx::Vector3d latLongDirection(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    const double PI = std::acos(-1.0);
+    double theta = PI * (y + 0.5) / height;
+    double phi = 2.0 * PI * ((x + 0.5) / width - 0.5);
+    return mx::Vector3d(std::sin(theta) * std::sin(phi), std::cos(theta), -std::sin(theta) * std::cos(phi));
+}
+
+// Compute the GGX-weighted radiance around a direction by brute-force
+// integration over all texels of an environment, giving the integral that is
+// estimated by filtered importance sampling with the view along the normal.
+mx::Color3d integrateGgxLobe(mx::ImagePtr env, const mx::Vector3d& n, double alpha)
+{
+    const double PI = std::acos(-1.0);
+    const double alpha2 = alpha * alpha;
+    mx::Color3d sum;
+    double weightSum = 0.0;
+    for (unsigned int y = 0; y < env->getHeight(); y++)
+    {
+        double solidAngle = std::cos(y * PI / env->getHeight()) - std::cos((y + 1) * PI / env->getHeight());
+        for (unsigned int x = 0; x < env->getWidth(); x++)
+        {
+            mx::Vector3d l = latLongDirection(x, y, env->getWidth(), env->getHeight());
+            double ndotl = n.dot(l);
+            if (ndotl <= 0.0)
+            {
+                continue;
+            }
+            double ndoth = (n + l).getNormalized().dot(n);
+            double ndf = alpha2 / (PI * std::pow(ndoth * ndoth * (alpha2 - 1.0) + 1.0, 2.0));
+            double weight = ndf * ndotl * solidAngle;
+            mx::Color4 color = env->getTexelColor(x, y);
+            sum += mx::Color3d(color[0], color[1], color[2]) * weight;
+            weightSum += weight;
+        }
+    }
+    return sum / weightSum;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Render: Environment Prefilter", "[rendercore]")
+{
+    // Create a smooth environment with a bright region.
+    const mx::Vector3d sun = mx::Vector3d(0.3, 0.8, -0.5).getNormalized();
+    mx::ImagePtr env = mx::Image::create(128, 64, 3, mx::Image::BaseType::FLOAT);
+    env->createResourceBuffer();
+    for (unsigned int y = 0; y < env->getHeight(); y++)
+    {
+        for (unsigned int x = 0; x < env->getWidth(); x++)
+        {
+            mx::Vector3d dir = latLongDirection(x, y, env->getWidth(), env->getHeight());
+            double sunWeight = 4.0 * std::pow(std::max(dir.dot(sun), 0.0), 8.0);
+            env->setTexelColor(x, y, mx::Color4((float) (1.0 + 0.5 * dir[1] + sunWeight),
+                                                (float) (0.8 + 0.3 * dir[0] * dir[2] + sunWeight),
+                                                (float) (0.6 - 0.4 * dir[1] + 0.5 * sunWeight), 1.0f));
+        }
+    }
+
+    const unsigned int width = 64;
+    mx::ImageVec levels = mx::prefilterEnvironment(env, width, 512);
+    REQUIRE(levels.size() == mx::getPrefilterLevelCount(width));
+    REQUIRE(levels.size() == 4);
+    REQUIRE(mx::getPrefilterRoughness(0, 4) == 0.0f);
+    REQUIRE(mx::getPrefilterRoughness(3, 4) == 1.0f);
+    REQUIRE_THROWS_AS(mx::prefilterEnvironment(env, 48), mx::Exception&);
+
+    // Compare rough levels to the GGX integral of the environment.
+    for (unsigned int i = 1; i < levels.size(); i++)
+    {
+        mx::ImagePtr level = levels[i];
+        REQUIRE(level->getWidth() == width >> i);
+        REQUIRE(level->getHeight() == width >> (i + 1));
+        double alpha = mx::getPrefilterRoughness(i, (unsigned int) levels.size());
+        double maxError = 0.0;
+        for (unsigned int y = 0; y < level->getHeight(); y++)
+        {
+            for (unsigned int x = 0; x < level->getWidth(); x += 2)
+            {
+                mx::Vector3d n = latLongDirection(x, y, level->getWidth(), level->getHeight());
+                mx::Color3d expected = integrateGgxLobe(env, n, alpha);
+                mx::Color4 color = level->getTexelColor(x, y);
+                for (size_t c = 0; c < 3; c++)
+                {
+                    maxError = std::max(maxError, std::abs(color[c] - expected[c]) / expected[c]);
+                }
+            }
+        }
+        INFO("Level " << i << " with roughness " << alpha);
+        REQUIRE(maxError < 0.05);
+    }
+
+    // Pack and save the chain.
+    mx::ImagePtr atlas = mx::createPrefilterAtlas(levels);
+    REQUIRE(atlas->getWidth() == width);
+    REQUIRE(atlas->getHeight() == 32 + 16 + 8 + 4);
+    REQUIRE(atlas->getTexelColor(3, 32 + 16 + 2) == levels[2]->getTexelColor(3, 2));
+    REQUIRE(atlas->getTexelColor(width - 1, 32 + 16 + 8 + 3) == mx::Color4(0.0f, 0.0f, 0.0f, 1.0f));
+
+    mx::ImageHandlerPtr imageHandler = mx::ImageHandler::create(mx::StbImageLoader::create());
+    const mx::FilePath filePath = mx::FilePath::getCurrentPath() / "prefiltered_environment.hdr";
+    REQUIRE(mx::savePrefilteredEnvironment(imageHandler, filePath, levels));
+    mx::ImagePtr savedAtlas = imageHandler->acquireImage(filePath);
+    REQUIRE(savedAtlas);
+    REQUIRE(savedAtlas->getWidth() == atlas->getWidth());
+    REQUIRE(savedAtlas->getHeight() == atlas->getHeight());
+
+    std::remove(filePath.asString().c_str());
+}
@@ -180,6 +180,7 @@ bool ShaderRenderTester::validate(const mx::FilePathVec& testRootPaths, const mx
 
     mx::GenContext context(_shaderGenerator);
     context.registerSourceCodeSearchPath(searchPath);
+    context.setProfiler(profileTimes.genProfiler);
     registerSourceCodeSearchPaths(context);
 
     // Set target unit space
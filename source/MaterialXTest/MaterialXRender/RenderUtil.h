@@ -135,6 +135,11 @@ class RenderProfileTimes
         languageTimes.print("Profile Times:", output);
 
         output << "Elements tested: " << elementsTested << std::endl;
+
+        if (genProfiler)
+        {
+            GenShaderUtil::printGenProfile(*genProfiler, output);
+        }
     }
 
     LanguageProfileTimes languageTimes;
@@ -143,6 +148,9 @@ class RenderProfileTimes
     double validateTime = 0.0;
     double renderableSearchTime = 0.0;
     unsigned int elementsTested = 0;
+
+    // Breakdown of the generation time, recorded by the generation context
+    mx::GenProfilerPtr genProfiler = mx::GenProfiler::create();
 };
 
 // Base class used for performing compilation and render tests for a given
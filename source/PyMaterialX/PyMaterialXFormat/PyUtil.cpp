@@ -21,8 +21,13 @@ void bindPyUtil(py::module& mod)
         py::arg("readOptions") = (mx::XmlReadOptions*) nullptr, py::arg("errors") = (mx::StringVec*) nullptr);
     mod.def("loadLibrary", &mx::loadLibrary,
         py::arg("file"), py::arg("doc"), py::arg("searchPath") = mx::FileSearchPath(), py::arg("readOptions") = (mx::XmlReadOptions*) nullptr);
-    mod.def("loadLibraries", &mx::loadLibraries,
-        py::arg("libraryFolders"), py::arg("searchPath"), py::arg("doc"), py::arg("excludeFiles") = mx::StringSet(), py::arg("readOptions") = (mx::XmlReadOptions*) nullptr);
+    mod.def("loadLibraries", [](const mx::FilePathVec& libraryFolders, const mx::FileSearchPath& searchPath, mx::DocumentPtr doc,
+                                const mx::StringSet& excludeFiles, const mx::XmlReadOptions* readOptions, unsigned int threadCount)
+        {
+            return mx::loadLibraries(libraryFolders, searchPath, doc, excludeFiles, readOptions, threadCount);
+        },
+        py::arg("libraryFolders"), py::arg("searchPath"), py::arg("doc"), py::arg("excludeFiles") = mx::StringSet(), py::arg("readOptions") = (mx::XmlReadOptions*) nullptr,
+        py::arg("threadCount") = 1);
     mod.def("flattenFilenames", &mx::flattenFilenames,
         py::arg("doc"), py::arg("searchPath") = mx::FileSearchPath(), py::arg("customResolver") = (mx::StringResolverPtr) nullptr);
 }
@@ -17,14 +17,21 @@ void bindPyGenOptions(py::module& mod)
         .value("SHADER_INTERFACE_REDUCED", mx::ShaderInterfaceType::SHADER_INTERFACE_REDUCED)
         .export_values();
 
+    py::enum_<mx::ShaderOptimizationLevel>(mod, "ShaderOptimizationLevel")
+        .value("SHADER_OPTIMIZATION_BASIC", mx::ShaderOptimizationLevel::SHADER_OPTIMIZATION_BASIC)
+        .value("SHADER_OPTIMIZATION_FULL", mx::ShaderOptimizationLevel::SHADER_OPTIMIZATION_FULL)
+        .export_values();
+
     py::enum_<mx::HwSpecularEnvironmentMethod>(mod, "HwSpecularEnvironmentMethod")
         .value("SPECULAR_ENVIRONMENT_PREFILTER", mx::HwSpecularEnvironmentMethod::SPECULAR_ENVIRONMENT_PREFILTER)
         .value("SPECULAR_ENVIRONMENT_FIS", mx::HwSpecularEnvironmentMethod::SPECULAR_ENVIRONMENT_FIS)
+        .value("SPECULAR_ENVIRONMENT_PREFILTER_GGX", mx::HwSpecularEnvironmentMethod::SPECULAR_ENVIRONMENT_PREFILTER_GGX)
         .value("SPECULAR_ENVIRONMENT_NONE", mx::HwSpecularEnvironmentMethod::SPECULAR_ENVIRONMENT_NONE)
         .export_values();
 
     py::class_<mx::GenOptions>(mod, "GenOptions")
         .def_readwrite("shaderInterfaceType", &mx::GenOptions::shaderInterfaceType)
+        .def_readwrite("optimizationLevel", &mx::GenOptions::optimizationLevel)
         .def_readwrite("fileTextureVerticalFlip", &mx::GenOptions::fileTextureVerticalFlip)
         .def_readwrite("targetColorSpaceOverride", &mx::GenOptions::targetColorSpaceOverride)
         .def_readwrite("targetDistanceUnit", &mx::GenOptions::targetDistanceUnit)
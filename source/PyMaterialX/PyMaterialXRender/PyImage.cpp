@@ -33,6 +33,7 @@ void bindPyImage(py::module& mod)
         .def("getTexelColor", &mx::Image::getTexelColor)
         .def("isUniformColor", &mx::Image::isUniformColor)
         .def("setUniformColor", &mx::Image::setUniformColor)
+        .def("applySeparableFilter", &mx::Image::applySeparableFilter)
         .def("applyBoxBlur", &mx::Image::applyBoxBlur)
         .def("applyGaussianBlur", &mx::Image::applyGaussianBlur)
         .def("splitByLuminance", &mx::Image::splitByLuminance)
@@ -53,6 +53,16 @@ void bindPyImageHandler(py::module& mod)
         .def("releaseRenderResources", &mx::ImageHandler::releaseRenderResources,
             py::arg("image") = nullptr)
         .def("clearImageCache", &mx::ImageHandler::clearImageCache)
+        .def("setImageCacheBudget", &mx::ImageHandler::setImageCacheBudget)
+        .def("getImageCacheBudget", &mx::ImageHandler::getImageCacheBudget)
+        .def("getImageCacheSize", &mx::ImageHandler::getImageCacheSize)
+        .def("getImageCacheCount", &mx::ImageHandler::getImageCacheCount)
+        .def("getImageCacheHitCount", &mx::ImageHandler::getImageCacheHitCount)
+        .def("getImageCacheMissCount", &mx::ImageHandler::getImageCacheMissCount)
+        .def("getImageCacheEvictionCount", &mx::ImageHandler::getImageCacheEvictionCount)
+        .def("pinImage", &mx::ImageHandler::pinImage)
+        .def("unpinImage", &mx::ImageHandler::unpinImage)
+        .def("getPinCount", &mx::ImageHandler::getPinCount)
         .def("getZeroImage", &mx::ImageHandler::getZeroImage)
         .def("getInvalidImage", &mx::ImageHandler::getInvalidImage)
         .def("getReferencedImages", &mx::ImageHandler::getReferencedImages);